@@ -2,15 +2,30 @@
 #include "board.h"
 #include "display.h"
 #include "system_info.h"
+#include "metrics.h"
+#include "trace.h"
+#include "cpu_sampler.h"
+#include "heap_tracker.h"
+#include "sound_bundle.h"
+#include "flight_recorder.h"
+#include "power_state_manager.h"
+#include "frame_rate_governor.h"
+#include "tls_session_cache.h"
 #include "ml307_ssl_transport.h"
 #include "audio_codec.h"
+#include "audio_negotiator.h"
+#include "mic_array.h"
+#include "audio_level_meter.h"
 #include "mqtt_protocol.h"
 #include "websocket_protocol.h"
 #include "font_awesome_symbols.h"
 #include "iot/thing_manager.h"
+#include "iot/command_executor.h"
 #include "assets/lang_config.h"
+#include "assets/keywords.h"
 #include "stdio.h"
 #include <cstring>
+#include <algorithm>
 #include <esp_log.h>
 #include <cJSON.h>
 #include <driver/gpio.h>
@@ -23,6 +38,9 @@
 
 #define TAG "Application"
 
+// 迁移关闭通道后等待断开回调的最长时间
+static constexpr int64_t kMigrationCloseTimeoutUs = 5000000;
+
 
 static const char* const STATE_STRINGS[] = {
     "unknown",
@@ -38,7 +56,16 @@ static const char* const STATE_STRINGS[] = {
     "invalid_state"
 };
 
+const char* Application::GetDeviceStateName(DeviceState state) {
+    if (state < kDeviceStateUnknown || state > kDeviceStateFatalError) {
+        return STATE_STRINGS[kDeviceStateFatalError + 1];
+    }
+    return STATE_STRINGS[state];
+}
+
 Application::Application() {
+    // 尽早恢复上一次运行的飞行记录
+    FlightRecorder::GetInstance();
     event_group_ = xEventGroupCreate();
     background_task_ = new BackgroundTask(4096 * 8);
 
@@ -95,6 +122,8 @@ void Application::CheckNewVersion() {
         }
         retry_count = 0;
         retry_delay = 10; // 重置重试延迟时间
+        // 上一次运行的飞行记录已经随版本检查一起上报
+        FlightRecorder::GetInstance().MarkPreviousBootUploaded();
 
         if (ota_.HasNewVersion()) {
             //
@@ -103,6 +132,7 @@ void Application::CheckNewVersion() {
             vTaskDelay(pdMS_TO_TICKS(3000));
 
             SetDeviceState(kDeviceStateUpgrading);
+            FlightRecorder::GetInstance().Record(kFlightEventUpgrade);
             
             //display->SetIcon(FONT_AWESOME_DOWNLOAD);
             std::string message = std::string(Lang::Strings::NEW_VERSION) + ota_.GetFirmwareVersion();
@@ -246,21 +276,24 @@ void Application::PlaySound(const std::string_view& sound) {
 
     // The assets are encoded at 16000Hz, 60ms frame duration
     SetDecodeSampleRate(16000, 60);
-    const char* data = sound.data();
-    size_t size = sound.size();
-    for (const char* p = data; p < data + size; ) {
-        auto p3 = (BinaryProtocol3*)p;
-        p += sizeof(BinaryProtocol3);
-
-        auto payload_size = ntohs(p3->payload_size);
-        std::vector<uint8_t> opus;
-        opus.resize(payload_size);
-        memcpy(opus.data(), p3->payload, payload_size);
-        p += payload_size;
-
+#if CONFIG_USE_SOUND_BUNDLE
+    SoundInfo info;
+    if (SoundBundle::GetInstance().GetInfo(sound, info)) {
+        ESP_LOGD(TAG, "Play sound %08x: %u ms, %u packets", (unsigned)info.name_hash,
+            (unsigned)info.duration_ms, info.packets);
+    }
+#endif
+    P3Reader reader(sound.data(), sound.size());
+    const uint8_t* payload;
+    uint16_t payload_size;
+    while (reader.Next(payload, payload_size)) {
+        std::vector<uint8_t> opus(payload, payload + payload_size);
         std::lock_guard<std::mutex> lock(mutex_);
         audio_decode_queue_.emplace_back(std::move(opus));
     }
+    if (reader.error()) {
+        ESP_LOGW(TAG, "Truncated sound asset (%u bytes)", (unsigned)sound.size());
+    }
 }
 
 
@@ -292,11 +325,45 @@ void Application::ToggleChatState() {
         });
     } else if (device_state_ == kDeviceStateListening) {
         Schedule([this]() {
-            protocol_->CloseAudioChannel();
+            EndConversation();
         });
     }
 }
 
+// 设备主动结束对话：停止收音并保留通道，保活窗口内再次唤醒可以直接复用
+void Application::EndConversation() {
+    if (protocol_->IsAudioChannelOpened()) {
+        protocol_->SendStopListening();
+    }
+    protocol_->ReleaseAudioChannel();
+    SetDeviceState(kDeviceStateIdle);
+}
+
+void Application::PreconnectAudioChannel() {
+    if (device_state_ != kDeviceStateIdle || !protocol_ || protocol_->IsAudioChannelOpened()) {
+        return;
+    }
+    // 环境噪声可能反复触发 VAD，限制尝试频率
+    int64_t now = esp_timer_get_time();
+    if (last_preconnect_time_ != 0 && now - last_preconnect_time_ < 10 * 1000000LL) {
+        return;
+    }
+    if (preconnecting_.exchange(true)) {
+        return;
+    }
+    last_preconnect_time_ = now;
+
+    // 建立连接最长要等 10 秒，放到单独的任务里，主循环继续处理唤醒等事件
+    ESP_LOGI(TAG, "Speech detected, pre-connecting audio channel");
+    xTaskCreate([](void* arg) {
+        auto app = static_cast<Application*>(arg);
+        HeapTracker::SetTaskTag(kHeapTagProtocol);
+        app->protocol_->PreconnectAudioChannel();
+        app->preconnecting_ = false;
+        vTaskDelete(NULL);
+    }, "preconnect", 4096 * 2, this, 3, nullptr);
+}
+
 
 void Application::ChangeChatState() {
     if (device_state_ == kDeviceStateActivating) {
@@ -341,7 +408,8 @@ void Application::StartListening() {
     
     if (device_state_ == kDeviceStateIdle) {
         Schedule([this]() {
-            if (!protocol_->IsAudioChannelOpened()) {
+            // 保留中的通道也要经过 OpenAudioChannel 恢复，否则保活定时器会在对话中途关掉它
+            if (!protocol_->IsAudioChannelOpened() || protocol_->IsAudioChannelParked()) {
                 SetDeviceState(kDeviceStateConnecting);
                 if (!protocol_->OpenAudioChannel()) {
                     return;
@@ -380,8 +448,15 @@ void Application::StopListening() {
 void Application::Start() {
     auto& board = Board::GetInstance();
     SetDeviceState(kDeviceStateStarting);
+#if CONFIG_USE_TRACE
+    // 提前分配追踪缓冲区，避免在热路径上第一次分配
+    Trace::GetInstance();
+#endif
     
     EmotionManager::GetInstance().PreloadAllAnimations();
+#if CONFIG_USE_SOUND_BUNDLE
+    SoundBundle::GetInstance().LogSummary();
+#endif
     /* Setup the display */
     auto display = board.GetDisplay();
     
@@ -390,6 +465,18 @@ void Application::Start() {
 
     /* Setup the audio codec */
     auto codec = board.GetAudioCodec();
+    // 按编解码器能力协商采样率，尽量省掉重采样
+    auto caps = codec->GetCapabilities();
+    auto plan = AudioNegotiator::Negotiate(caps, 16000, 24000, CONFIG_AUDIO_MIN_OUTPUT_SAMPLE_RATE);
+    if (plan.input_sample_rate != codec->input_sample_rate() || plan.output_sample_rate != codec->output_sample_rate()) {
+        if (!codec->SetSampleRates(plan.input_sample_rate, plan.output_sample_rate)) {
+            ESP_LOGW(TAG, "Failed to set codec sample rates %d/%d, keeping %d/%d", plan.input_sample_rate,
+                plan.output_sample_rate, codec->input_sample_rate(), codec->output_sample_rate());
+            // 按编解码器实际生效的采样率重新计算，日志里的重采样开销才对得上
+            plan = AudioNegotiator::MakePlan(caps, codec->input_sample_rate(), codec->output_sample_rate(), 16000, 24000);
+        }
+    }
+    AudioNegotiator::LogPlan(plan);
     opus_decoder_ = std::make_unique<OpusDecoderWrapper>(codec->output_sample_rate(), 1, OPUS_FRAME_DURATION_MS);
     opus_encoder_ = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
     if (realtime_chat_enabled_) {
@@ -404,11 +491,19 @@ void Application::Start() {
     }
 
     if (codec->input_sample_rate() != 16000) {
-        input_resampler_.Configure(codec->input_sample_rate(), 16000);
-        reference_resampler_.Configure(codec->input_sample_rate(), 16000);
+        for (int i = 0; i < codec->input_channels(); i++) {
+            input_resamplers_.emplace_back(std::make_unique<OpusResampler>());
+            input_resamplers_.back()->Configure(codec->input_sample_rate(), 16000);
+        }
+        input_channels_.resize(codec->input_channels());
+        resampled_channels_.resize(codec->input_channels());
     }
     codec->Start();
 
+    // 后台采样各任务 CPU 占用，按设备状态分别统计
+    CpuSampler::GetInstance().Start(1000, STATE_STRINGS, kDeviceStateFatalError + 1);
+    CpuSampler::GetInstance().SetState(device_state_);
+
     // 启动串口监听任务
     xTaskCreatePinnedToCore(
         [](void* param) {
@@ -442,34 +537,76 @@ void Application::Start() {
     protocol_ = std::make_unique<MqttProtocol>();
 #endif
     protocol_->OnNetworkError([this](const std::string& message) {
-        SetDeviceState(kDeviceStateIdle);
-        Alert(Lang::Strings::ERROR, message.c_str(), "sad", Lang::Sounds::P3_EXCLAMATION);
+        FlightRecorder::GetInstance().Record(kFlightEventNetworkError);
+        if (preconnecting_) {
+            // 预连接失败不打扰用户，唤醒后会再正常连接一次
+            ESP_LOGW(TAG, "Pre-connect failed: %s", message.c_str());
+            return;
+        }
+        // 唤醒上传任务里建立连接失败时也会走到这里，状态切换统一放回主循环
+        Schedule([this, message]() {
+            SetDeviceState(kDeviceStateIdle);
+            Alert(Lang::Strings::ERROR, message.c_str(), "sad", Lang::Sounds::P3_EXCLAMATION);
+        });
     });
     protocol_->OnIncomingAudio([this](std::vector<uint8_t>&& data) {
+        HeapTagScope heap_tag(kHeapTagProtocol);
         const int max_packets_in_queue = 300 / OPUS_FRAME_DURATION_MS;
+        auto& metrics = Metrics::GetInstance();
+        metrics.Increment(kMetricAudioPacketsReceived);
         std::lock_guard<std::mutex> lock(mutex_);
         if (audio_decode_queue_.size() < max_packets_in_queue) {
             audio_decode_queue_.emplace_back(std::move(data));
+        } else {
+            metrics.Increment(kMetricAudioPacketsDropped);
         }
+        metrics.SetGauge(kMetricDecodeQueueDepth, audio_decode_queue_.size());
     });
     protocol_->OnAudioChannelOpened([this, codec, &board]() {
+        // 和关闭回调里的 Release 成对，留在回调里同步执行
         board.SetPowerSaveMode(false);
-        if (protocol_->server_sample_rate() != codec->output_sample_rate()) {
-            ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion",
-                protocol_->server_sample_rate(), codec->output_sample_rate());
-        }
-        SetDecodeSampleRate(protocol_->server_sample_rate(), protocol_->server_frame_duration());
-        auto& thing_manager = iot::ThingManager::GetInstance();
-        protocol_->SendIotDescriptors(thing_manager.GetDescriptorsJson());
-        std::string states;
-        if (thing_manager.GetStatesJson(states, false)) {
-            protocol_->SendIotStates(states);
-        }
-    
-
+        PowerStateManager::GetInstance().Acquire(kPmSubsystemRadio);
+        FlightRecorder::GetInstance().Record(kFlightEventChannelOpened);
+        // 通道可能在预连接任务或唤醒上传任务里打开，解码器替换和 IoT 描述发送都放回主循环，
+        // 和其他控制消息保持同一个发送者
+        Schedule([this, codec, sample_rate = protocol_->server_sample_rate(),
+                frame_duration = protocol_->server_frame_duration()]() {
+            auto& recorder = FlightRecorder::GetInstance();
+            if (recorder.HasPreviousBoot()) {
+                protocol_->SendCustomMessage("flight_recorder", recorder.GetPreviousBootJson());
+                recorder.MarkPreviousBootUploaded();
+            }
+            if (sample_rate != codec->output_sample_rate() && !AudioNegotiator::IsOpusRate(codec->output_sample_rate())) {
+                ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion",
+                    sample_rate, codec->output_sample_rate());
+            }
+            SetDecodeSampleRate(sample_rate, frame_duration);
+#if CONFIG_METRICS_REPORT_INTERVAL > 0
+            if (metrics_report_pending_) {
+                // 快照是累计值，补发最新的一份即可
+                protocol_->SendMetrics(Metrics::GetInstance().Snapshot());
+                metrics_report_pending_ = false;
+            }
+#endif
+            auto& thing_manager = iot::ThingManager::GetInstance();
+            protocol_->SendIotDescriptors(thing_manager.GetDescriptorsJson());
+            std::string states;
+            if (thing_manager.GetStatesJson(states, false)) {
+                protocol_->SendIotStates(states);
+            }
+        });
     });
     protocol_->OnAudioChannelClosed([this, &board]() {
         board.SetPowerSaveMode(true);
+        FlightRecorder::GetInstance().Record(kFlightEventChannelClosed);
+        PowerStateManager::GetInstance().Release(kPmSubsystemRadio);
+        // 链路迁移中主动关闭，通道马上会在新链路上重新打开。断开回调可能在迁移结束后才到，
+        // 所以由回调自己消费标记，而不是迁移结束时清掉
+        int64_t until = migration_close_until_us_.load();
+        if (until != 0 && esp_timer_get_time() < until &&
+            migration_close_until_us_.compare_exchange_strong(until, 0)) {
+            return;
+        }
 
        
 
@@ -480,57 +617,70 @@ void Application::Start() {
         });
     });
     protocol_->OnIncomingJson([this, display](const cJSON* root) {
+        HeapTagScope heap_tag(kHeapTagProtocol);
         // Parse JSON data
         auto type = cJSON_GetObjectItem(root, "type");
-        if (strcmp(type->valuestring, "tts") == 0) {
+        if (!cJSON_IsString(type)) {
+            return;
+        }
+        auto message_type = Keys::MessageType::Lookup(type->valuestring);
+        if (protocol_->IsAudioChannelParked() && message_type != Keys::MessageType::kIot &&
+            message_type != Keys::MessageType::kSystem) {
+            // 保留中的通道不属于任何对话，服务端迟到的消息（比如 tts start）不能改变设备状态；
+            // IoT 和系统命令与对话无关，照常执行
+            ESP_LOGW(TAG, "Audio channel parked, drop incoming %s message", type->valuestring);
+            return;
+        }
+        if (message_type == Keys::MessageType::kTts) {
             auto state = cJSON_GetObjectItem(root, "state");
-            if (strcmp(state->valuestring, "start") == 0) {
+            auto tts_state = cJSON_IsString(state) ? Keys::TtsState::Lookup(state->valuestring) : Keys::TtsState::kUnknown;
+            if (tts_state == Keys::TtsState::kStart) {
                 Schedule([this]() {
                     aborted_ = false;
+                    // 上一段回复还没播完就开始了新的一段，继续说话
+                    WhenOutputDrained(nullptr);
                     if (device_state_ == kDeviceStateIdle || device_state_ == kDeviceStateListening) {
                         SetDeviceState(kDeviceStateSpeaking);
                     }
                 });
-            } else if (strcmp(state->valuestring, "stop") == 0) {
+            } else if (tts_state == Keys::TtsState::kStop) {
                 Schedule([this]() {
-                    background_task_->WaitForCompletion();
                     if (device_state_ == kDeviceStateSpeaking) {
                         if (listening_mode_ == kListeningModeManualStop) {
                             SetDeviceState(kDeviceStateIdle);
                         } else {
+                            // 不清队列，等剩下的语音播完再转入聆听
                             aborted_ = false;
-                            ResetDecoder();
-                            PlaySound(Lang::Sounds::P3_SUCCESS);
-                            vTaskDelay(pdMS_TO_TICKS(300));
-                            SetDeviceState(kDeviceStateListening);
+                            tts_stop_time_ = esp_timer_get_time();
+                            WhenOutputDrained([this]() {
+                                OnSpeakingDrained();
+                            });
                         }
                     }
                 });
-            } else if (strcmp(state->valuestring, "sentence_start") == 0) {
+            } else if (tts_state == Keys::TtsState::kSentenceStart) {
                 auto text = cJSON_GetObjectItem(root, "text");
-                if (text != NULL) {
+                if (cJSON_IsString(text)) {
                     ESP_LOGI(TAG, "<< %s", text->valuestring);
-                    Schedule([this, display, message = std::string(text->valuestring)]() {
-                        display->SetChatMessage("assistant", message.c_str());
-                    });
+                    // 显示接口自带锁，直接追加，不用拷贝后排进主循环
+                    display->AppendChatText("assistant", text->valuestring);
                 }
             }
-        } else if (strcmp(type->valuestring, "stt") == 0) {
+        } else if (message_type == Keys::MessageType::kStt) {
             auto text = cJSON_GetObjectItem(root, "text");
-            if (text != NULL) {
+            if (cJSON_IsString(text)) {
                 ESP_LOGI(TAG, ">> %s", text->valuestring);
-                Schedule([this, display, message = std::string(text->valuestring)]() {
-                    display->SetChatMessage("user", message.c_str());
-                });
+                // 和 sentence_start 一样直接调用，保证两者的先后顺序
+                display->SetChatMessage("user", text->valuestring);
             }
-        } else if (strcmp(type->valuestring, "llm") == 0) {
+        } else if (message_type == Keys::MessageType::kLlm) {
             auto emotion = cJSON_GetObjectItem(root, "emotion");
             if (emotion != NULL) {
                 Schedule([this, display, emotion_str = std::string(emotion->valuestring)]() {
                     display->SetEmotion(emotion_str.c_str());
                 });
             }
-        } else if (strcmp(type->valuestring, "iot") == 0) {
+        } else if (message_type == Keys::MessageType::kIot) {
             auto commands = cJSON_GetObjectItem(root, "commands");
             if (commands != NULL) {
                  ESP_LOGI(TAG, "Received IoT commands, count: %d", cJSON_GetArraySize(commands));/////////
@@ -541,20 +691,33 @@ void Application::Start() {
                     //ESP_LOGI(TAG, "IoT command %d: %s", i, command_str);//////
                 }
             }
-        } else if (strcmp(type->valuestring, "system") == 0) {
+        } else if (message_type == Keys::MessageType::kSystem) {
             auto command = cJSON_GetObjectItem(root, "command");
-            if (command != NULL) {
+            if (cJSON_IsString(command)) {
                 ESP_LOGI(TAG, "System command: %s", command->valuestring);
-                if (strcmp(command->valuestring, "reboot") == 0) {
+                auto system_command = Keys::SystemCommand::Lookup(command->valuestring);
+                if (system_command == Keys::SystemCommand::kReboot) {
                     // Do a reboot if user requests a OTA update
                     Schedule([this]() {
                         Reboot();
                     });
+                } else if (system_command == Keys::SystemCommand::kHeap) {
+                    Schedule([this]() {
+                        protocol_->SendCustomMessage("heap", HeapTracker::GetInstance().GetJson());
+                    });
+#if CONFIG_USE_TRACE
+                } else if (system_command == Keys::SystemCommand::kTrace) {
+                    Schedule([this]() {
+                        Trace::GetInstance().Dump([this](const std::string& chunk, bool last) {
+                            protocol_->SendTrace(chunk, last);
+                        });
+                    });
+#endif
                 } else {
                     ESP_LOGW(TAG, "Unknown system command: %s", command->valuestring);
                 }
             }
-        } else if (strcmp(type->valuestring, "alert") == 0) {
+        } else if (message_type == Keys::MessageType::kAlert) {
             auto status = cJSON_GetObjectItem(root, "status");
             auto message = cJSON_GetObjectItem(root, "message");
             auto emotion = cJSON_GetObjectItem(root, "emotion");
@@ -565,18 +728,29 @@ void Application::Start() {
             }
         }
     });
+    // IoT 命令在执行器的任务里运行，结果回到主循环再发给服务端，顺带上报变化的状态
+    iot::CommandExecutor::GetInstance().OnComplete([this](const iot::CommandResult& result) {
+        Schedule([this, json = result.ToJson()]() {
+            protocol_->SendIotResult(json);
+            UpdateIotStates();
+        });
+    });
     protocol_->Start();
 
 #if CONFIG_USE_AUDIO_PROCESSOR
     audio_processor_.Initialize(codec, realtime_chat_enabled_);
     audio_processor_.OnOutput([this](std::vector<int16_t>&& data) {
+        AudioLevelMeter::GetInstance().Update(kAudioLevelInput, data.data(), data.size());
         background_task_->Schedule([this, data = std::move(data)]() mutable {
             if (protocol_->IsAudioChannelBusy()) {
                 return;
             }
+            TRACE_SCOPE("opus_encode");
+            HeapTagScope heap_tag(kHeapTagAudio);
+            MetricsTimer timer(kMetricOpusEncodeUs);
             opus_encoder_->Encode(std::move(data), [this](std::vector<uint8_t>&& opus) {
                 Schedule([this, opus = std::move(opus)]() {
-                    protocol_->SendAudio(opus);
+                    SendAudio(opus);
                 });
             });
         });
@@ -603,31 +777,31 @@ void Application::Start() {
         
         
         
-        Schedule([this, wake_word]() {
+        int64_t wake_time = esp_timer_get_time();
+        Schedule([this, wake_word, wake_time]() {
             if (device_state_ == kDeviceStateIdle) {
+                wake_time_ = wake_time;
                 SetDeviceState(kDeviceStateConnecting);
-                wake_word_detect_.EncodeWakeWordData();
-
-                if (!protocol_->OpenAudioChannel()) {
-                    wake_word_detect_.StartDetection();
-                    return;
-                }
-                
-                std::vector<uint8_t> opus;
-                // Encode and send the wake word data to the server
-                while (wake_word_detect_.GetWakeWordOpus(opus)) {
-                    protocol_->SendAudio(opus);
-                }
-                // Set the chat state to wake word detected
-                protocol_->SendWakeWordDetected(wake_word);
-                SetListeningMode(realtime_chat_enabled_ ? kListeningModeRealtime : kListeningModeAutoStop);
-            } else if (device_state_ == kDeviceStateSpeaking) {
+                StartWakeWordUplink(wake_word);
+                return;
+            }
+            // 检测任务唤醒后还在采集桥接音频，不上传时停掉，已经采到的也不再需要
+            wake_word_detect_.StopDetection();
+            wake_word_detect_.DiscardStream();
+            if (device_state_ == kDeviceStateSpeaking) {
                 AbortSpeaking(kAbortReasonWakeWordDetected);
             } else if (device_state_ == kDeviceStateActivating) {
                 SetDeviceState(kDeviceStateIdle);
             }
         });
     });
+#if CONFIG_PRECONNECT_ON_SPEECH
+    wake_word_detect_.OnSpeechStart([this]() {
+        Schedule([this]() {
+            PreconnectAudioChannel();
+        });
+    });
+#endif
     wake_word_detect_.StartDetection();
 #endif
 
@@ -647,15 +821,37 @@ void Application::Start() {
 
 void Application::OnClockTimer() {
     clock_ticks_++;
+    HeapTracker::GetInstance().Tick();
 
     // Print the debug info every 10 seconds
     if (clock_ticks_ % 10 == 0) {
-        // SystemInfo::PrintRealTimeStats(pdMS_TO_TICKS(1000));
+        // SystemInfo::PrintRealTimeStats();
+
+        auto& metrics = Metrics::GetInstance();
+        metrics.SampleHeap();
+        metrics.FoldSums();
+        metrics.SetGauge(kMetricBackgroundTasks, background_task_ ? background_task_->active_tasks() : 0);
 
         int free_sram = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
         int min_free_sram = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
         ESP_LOGI(TAG, "Free internal: %u minimal internal: %u", free_sram, min_free_sram);
 
+        auto& recorder = FlightRecorder::GetInstance();
+        size_t decode_queue_size;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            decode_queue_size = audio_decode_queue_.size();
+        }
+        recorder.Record(kFlightEventQueues, 0, decode_queue_size, background_task_ ? background_task_->active_tasks() : 0);
+        recorder.Record(kFlightEventHeap, 0, heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) / 1024, free_sram);
+
+        // 电池供电时限制显示帧率
+        int battery_level;
+        bool charging, discharging;
+        if (Board::GetInstance().GetBatteryLevel(battery_level, charging, discharging)) {
+            FrameRateGovernor::GetInstance().SetDischarging(discharging);
+        }
+
         // If we have synchronized server time, set the status to clock "HH:MM" if the device is idle
         if (ota_.HasServerTime()) {
             if (device_state_ == kDeviceStateIdle) {
@@ -669,6 +865,162 @@ void Application::OnClockTimer() {
             }
         }
     }
+
+#if CONFIG_METRICS_REPORT_INTERVAL > 0
+    // clock_ticks_ 在状态切换时清零，这里单独计数
+    if (++metrics_report_ticks_ >= CONFIG_METRICS_REPORT_INTERVAL) {
+        metrics_report_ticks_ = 0;
+        Schedule([this]() {
+            if (!protocol_) {
+                return;
+            }
+            // MQTT 的控制连接空闲时也在；WebSocket 空闲时没有连接，留到下次打开通道时上报
+            if (protocol_->IsControlChannelConnected()) {
+                protocol_->SendMetrics(Metrics::GetInstance().Snapshot());
+                metrics_report_pending_ = false;
+            } else {
+                metrics_report_pending_ = true;
+            }
+        });
+    }
+#endif
+}
+
+void Application::RequestNetworkMigration(std::function<void()> switch_link) {
+    Schedule([this, switch_link = std::move(switch_link)]() mutable {
+        pending_migration_ = std::move(switch_link);
+        if (device_state_ == kDeviceStateIdle) {
+            RunPendingMigration();
+        }
+    });
+}
+
+void Application::RunPendingMigration() {
+    if (!pending_migration_ || !protocol_) {
+        return;
+    }
+    if (device_state_ != kDeviceStateIdle && device_state_ != kDeviceStateListening) {
+        return;
+    }
+    auto switch_link = std::move(pending_migration_);
+    pending_migration_ = nullptr;
+
+    // 迁移后重新发送 hello，服务器会分配新的 session_id，服务端的对话上下文不会保留：
+    // hello 里没有恢复会话的字段，这里只保证设备端的聆听状态接得上
+    bool resume_listening = device_state_ == kDeviceStateListening && protocol_->IsAudioChannelOpened();
+    ESP_LOGI(TAG, "Migrating network link, resume listening: %d", resume_listening);
+    if (protocol_->IsAudioChannelOpened()) {
+        migration_close_until_us_ = esp_timer_get_time() + kMigrationCloseTimeoutUs;
+        protocol_->CloseAudioChannel();
+    }
+    switch_link();
+    // MQTT 的控制连接在新链路上重连，WebSocket 在下次打开通道时建立
+    protocol_->Start();
+    if (resume_listening) {
+        if (protocol_->OpenAudioChannel()) {
+            protocol_->SendStartListening(listening_mode_);
+        } else {
+            SetDeviceState(kDeviceStateIdle);
+        }
+    }
+}
+
+#if CONFIG_USE_WAKE_WORD_DETECT
+// 唤醒后的上传流水线：编码任务编码唤醒词缓存和唤醒后的桥接音频，这个任务负责建立连接并
+// 把编好的包按顺序交给主循环发送，主循环在连接期间不阻塞
+void Application::StartWakeWordUplink(const std::string& wake_word) {
+    wake_word_detect_.EncodeWakeWordData();
+    uplink_wake_word_ = wake_word;
+    holding_live_audio_ = true;
+    held_audio_.clear();
+    xTaskCreate([](void* arg) {
+        static_cast<Application*>(arg)->WakeWordUplinkTask();
+        vTaskDelete(NULL);
+    }, "wake_uplink", 4096 * 2, this, 3, nullptr);
+}
+
+void Application::WakeWordUplinkTask() {
+    HeapTracker::SetTaskTag(kHeapTagProtocol);
+    int64_t wake_time = wake_time_;
+    // 协议内部串行化打开过程，连接建立完成前主循环看到的是通道未打开
+    bool opened = protocol_->OpenAudioChannel();
+    if (opened) {
+        Metrics::GetInstance().Observe(kMetricWakeConnectUs, (uint32_t)(esp_timer_get_time() - wake_time));
+    }
+
+    // 唤醒词数据；连接失败时照样取完，让编码任务正常结束
+    size_t packets = 0;
+    while (true) {
+        std::vector<uint8_t> opus;
+        if (!wake_word_detect_.GetWakeWordOpus(opus)) {
+            break;
+        }
+        if (opened) {
+            Schedule([this, opus = std::move(opus)]() {
+                SendAudioPacket(opus);
+            });
+            packets++;
+        }
+    }
+    if (opened) {
+        // 进入聆听：开始实时采集，同时结束桥接（StopDetection）
+        Schedule([this]() {
+            if (device_state_ != kDeviceStateConnecting) {
+                return;
+            }
+            protocol_->SendWakeWordDetected(uplink_wake_word_);
+            SetListeningMode(realtime_chat_enabled_ ? kListeningModeRealtime : kListeningModeAutoStop);
+        });
+    } else {
+        Schedule([this]() {
+            wake_word_detect_.StartDetection();
+        });
+    }
+
+    // 桥接音频，发完之后再放行排队的实时音频
+    size_t bridge_packets = 0;
+    while (true) {
+        std::vector<uint8_t> opus;
+        if (!wake_word_detect_.GetWakeWordOpus(opus)) {
+            break;
+        }
+        if (opened) {
+            Schedule([this, opus = std::move(opus)]() {
+                SendAudioPacket(opus);
+            });
+            bridge_packets++;
+        }
+    }
+    Schedule([this, wake_time, packets, bridge_packets]() {
+        auto held = std::move(held_audio_);
+        held_audio_.clear();
+        holding_live_audio_ = false;
+        for (auto& opus : held) {
+            SendAudioPacket(opus);
+        }
+        auto& metrics = Metrics::GetInstance();
+        uint32_t gap_us = (uint64_t)wake_word_detect_.handoff_gap_samples() * 1000000 / 16000;
+        metrics.Observe(kMetricWakeUploadUs, (uint32_t)(esp_timer_get_time() - wake_time));
+        metrics.Observe(kMetricWakeHandoffGapUs, gap_us);
+        ESP_LOGI(TAG, "Wake uplink: %u wake word + %u bridge + %u held packets, handoff gap %lu us",
+            (unsigned)packets, (unsigned)bridge_packets, (unsigned)held.size(), (unsigned long)gap_us);
+    });
+}
+#endif
+
+void Application::SendAudio(const std::vector<uint8_t>& opus) {
+    if (holding_live_audio_) {
+        // 唤醒后的桥接音频还没发完，实时音频排在它后面
+        held_audio_.push_back(opus);
+        return;
+    }
+    SendAudioPacket(opus);
+}
+
+void Application::SendAudioPacket(const std::vector<uint8_t>& opus) {
+    MetricsTimer timer(kMetricSendAudioUs);
+    protocol_->SendAudio(opus);
+    Metrics::GetInstance().Increment(kMetricAudioPacketsSent);
 }
 
 // Add a async task to MainLoop
@@ -692,6 +1044,7 @@ void Application::MainEventLoop() {
             std::list<std::function<void()>> tasks = std::move(main_tasks_);
             lock.unlock();
             for (auto& task : tasks) {
+                TRACE_SCOPE("main_task");
                 task();
             }
         }
@@ -700,10 +1053,15 @@ void Application::MainEventLoop() {
 
 // The Audio Loop is used to input and output audio data
 void Application::AudioLoop() {
+    HeapTracker::SetTaskTag(kHeapTagAudio);
     auto codec = Board::GetInstance().GetAudioCodec();
     while (true) {
-        OnAudioInput();
+        {
+            TRACE_SCOPE("audio_input");
+            OnAudioInput();
+        }
         if (codec->output_enabled()) {
+            TRACE_SCOPE("audio_output");
             OnAudioOutput();
         }
     }
@@ -720,6 +1078,31 @@ void Application::OnAudioOutput() {
 
     std::unique_lock<std::mutex> lock(mutex_);
     if (audio_decode_queue_.empty()) {
+        if (earcon_playing_) {
+            // 没有语音时单独输出提示音
+            lock.unlock();
+            busy_decoding_audio_ = true;
+            background_task_->Schedule([this, codec]() {
+                HeapTagScope heap_tag(kHeapTagAudio);
+                busy_decoding_audio_ = false;
+                std::vector<int16_t> pcm;
+                MixEarcon(pcm);
+                if (!pcm.empty()) {
+                    codec->OutputData(pcm);
+                    last_output_time_ = std::chrono::steady_clock::now();
+                }
+            });
+            return;
+        }
+        // 最后一帧可能还在后台任务里解码，写进 DMA 后才算数
+        if (on_output_drained_ && background_task_->active_tasks() == 0 &&
+            esp_timer_get_time() >= codec->output_drain_time_us()) {
+            auto callback = std::move(on_output_drained_);
+            on_output_drained_ = nullptr;
+            lock.unlock();
+            Schedule(std::move(callback));
+            return;
+        }
         // Disable the output if there is no audio data for a long time
         if (device_state_ == kDeviceStateIdle) {
             auto duration = std::chrono::duration_cast<std::chrono::seconds>(now - last_output_time_).count();
@@ -738,19 +1121,26 @@ void Application::OnAudioOutput() {
 
     auto opus = std::move(audio_decode_queue_.front());
     audio_decode_queue_.pop_front();
+    Metrics::GetInstance().SetGauge(kMetricDecodeQueueDepth, audio_decode_queue_.size());
     lock.unlock();
     audio_decode_cv_.notify_all();
 
     busy_decoding_audio_ = true;
     background_task_->Schedule([this, codec, opus = std::move(opus)]() mutable {
+        HeapTagScope heap_tag(kHeapTagAudio);
         busy_decoding_audio_ = false;
         if (aborted_) {
             return;
         }
 
         std::vector<int16_t> pcm;
-        if (!opus_decoder_->Decode(std::move(opus), pcm)) {
-            return;
+        {
+            TRACE_SCOPE("opus_decode");
+            MetricsTimer timer(kMetricOpusDecodeUs);
+            if (!opus_decoder_->Decode(std::move(opus), pcm)) {
+                Metrics::GetInstance().Increment(kMetricOpusDecodeErrors);
+                return;
+            }
         }
         // Resample if the sample rate is different
         if (opus_decoder_->sample_rate() != codec->output_sample_rate()) {
@@ -759,6 +1149,10 @@ void Application::OnAudioOutput() {
             output_resampler_.Process(pcm.data(), pcm.size(), resampled.data());
             pcm = std::move(resampled);
         }
+        if (earcon_playing_) {
+            MixEarcon(pcm);
+        }
+        AudioLevelMeter::GetInstance().Update(kAudioLevelOutput, pcm.data(), pcm.size());
         codec->OutputData(pcm);
         last_output_time_ = std::chrono::steady_clock::now();
     });
@@ -790,13 +1184,17 @@ void Application::OnAudioInput() {
     if (device_state_ == kDeviceStateListening) {
         std::vector<int16_t> data;
         ReadAudio(data, 16000, 30 * 16000 / 1000);
+        AudioLevelMeter::GetInstance().Update(kAudioLevelInput, data.data(), data.size());
         background_task_->Schedule([this, data = std::move(data)]() mutable {
             if (protocol_->IsAudioChannelBusy()) {
                 return;
             }
+            TRACE_SCOPE("opus_encode");
+            HeapTagScope heap_tag(kHeapTagAudio);
+            MetricsTimer timer(kMetricOpusEncodeUs);
             opus_encoder_->Encode(std::move(data), [this](std::vector<uint8_t>&& opus) {
                 Schedule([this, opus = std::move(opus)]() {
-                    protocol_->SendAudio(opus);
+                    SendAudio(opus);
                 });
             });
         });
@@ -809,30 +1207,28 @@ void Application::OnAudioInput() {
 void Application::ReadAudio(std::vector<int16_t>& data, int sample_rate, int samples) {
     auto codec = Board::GetInstance().GetAudioCodec();
     if (codec->input_sample_rate() != sample_rate) {
-        data.resize(samples * codec->input_sample_rate() / sample_rate);
-        if (!codec->InputData(data)) {
+        // 需要重采样时直接从编解码器的缓冲区读取，不再先拷贝到 data
+        AudioFrame frame;
+        if (!codec->AcquireInputFrame(samples * codec->input_sample_rate() / sample_rate, frame)) {
             return;
         }
-        if (codec->input_channels() == 2) {
-            auto mic_channel = std::vector<int16_t>(data.size() / 2);
-            auto reference_channel = std::vector<int16_t>(data.size() / 2);
-            for (size_t i = 0, j = 0; i < mic_channel.size(); ++i, j += 2) {
-                mic_channel[i] = data[j];
-                reference_channel[i] = data[j + 1];
-            }
-            auto resampled_mic = std::vector<int16_t>(input_resampler_.GetOutputSamples(mic_channel.size()));
-            auto resampled_reference = std::vector<int16_t>(reference_resampler_.GetOutputSamples(reference_channel.size()));
-            input_resampler_.Process(mic_channel.data(), mic_channel.size(), resampled_mic.data());
-            reference_resampler_.Process(reference_channel.data(), reference_channel.size(), resampled_reference.data());
-            data.resize(resampled_mic.size() + resampled_reference.size());
-            for (size_t i = 0, j = 0; i < resampled_mic.size(); ++i, j += 2) {
-                data[j] = resampled_mic[i];
-                data[j + 1] = resampled_reference[i];
+        int channels = codec->input_channels();
+        if (channels > 1) {
+            // 多声道按声道拆开分别重采样，再交错回 AFE 需要的布局
+            size_t frames = frame.samples / channels;
+            MicArray::Deinterleave(frame.data, frames, input_channels_);
+            codec->ReleaseInputFrame(frame);
+            for (int c = 0; c < channels; c++) {
+                auto& resampler = *input_resamplers_[c];
+                resampled_channels_[c].resize(resampler.GetOutputSamples(frames));
+                resampler.Process(input_channels_[c].data(), frames, resampled_channels_[c].data());
             }
+            MicArray::Interleave(resampled_channels_, data);
         } else {
-            auto resampled = std::vector<int16_t>(input_resampler_.GetOutputSamples(data.size()));
-            input_resampler_.Process(data.data(), data.size(), resampled.data());
-            data = std::move(resampled);
+            auto& resampler = *input_resamplers_[0];
+            data.resize(resampler.GetOutputSamples(frame.samples));
+            resampler.Process(frame.data, frame.samples, data.data());
+            codec->ReleaseInputFrame(frame);
         }
     } else {
         data.resize(samples);
@@ -840,6 +1236,8 @@ void Application::ReadAudio(std::vector<int16_t>& data, int sample_rate, int sam
             return;
         }
     }
+    // 采集到交给 AFE/编码的延迟，用于检查回声消除参考信号的对齐
+    Metrics::GetInstance().Observe(kMetricCaptureToFeedUs, esp_timer_get_time() - codec->last_input_timestamp_us());
 }
 
 void Application::AbortSpeaking(AbortReason reason) {
@@ -862,6 +1260,18 @@ void Application::SetDeviceState(DeviceState state) {
     auto previous_state = device_state_;
     device_state_ = state;
     ESP_LOGI(TAG, "STATE: %s", STATE_STRINGS[device_state_]);
+    WhenOutputDrained(nullptr);
+    CpuSampler::GetInstance().SetState(state);
+    FlightRecorder::GetInstance().Record(kFlightEventState, previous_state, state);
+    PowerStateManager::GetInstance().OnDeviceStateChanged(state);
+    FrameRateGovernor::GetInstance().OnDeviceStateChanged(state);
+    if (pending_migration_ && (state == kDeviceStateIdle ||
+        (state == kDeviceStateListening && previous_state == kDeviceStateSpeaking))) {
+        // 空闲或一句话播放完毕，是切换网络链路的时机
+        Schedule([this]() {
+            RunPendingMigration();
+        });
+    }
     // The state is changed, wait for all background tasks to finish
     background_task_->WaitForCompletion();
 
@@ -872,6 +1282,8 @@ void Application::SetDeviceState(DeviceState state) {
     switch (state) {
         case kDeviceStateUnknown:
         case kDeviceStateIdle://
+            wake_time_ = 0;
+            TlsSessionCache::GetInstance().EndConversation();
             //display->SetStatus(Lang::Strings::STANDBY);
             display->SetEmotion("orbiting");
             // 空闲状态设置闭眼
@@ -892,6 +1304,12 @@ void Application::SetDeviceState(DeviceState state) {
             //SetEyeState(false);
             break;
         case kDeviceStateListening:
+            if (wake_time_ != 0) {
+                int64_t latency = esp_timer_get_time() - wake_time_;
+                Metrics::GetInstance().Observe(kMetricWakeToListenUs, (uint32_t)latency);
+                ESP_LOGI(TAG, "Wake to listening: %lld ms", latency / 1000);
+                wake_time_ = 0;
+            }
             //display->SetStatus(Lang::Strings::LISTENING);
             display->SetEmotion("listening");
             // 倾听状态设置睁眼
@@ -908,9 +1326,12 @@ void Application::SetDeviceState(DeviceState state) {
 #endif
                 // Send the start listening command
                 protocol_->SendStartListening(listening_mode_);
-                if (listening_mode_ == kListeningModeAutoStop && previous_state == kDeviceStateSpeaking) {
-                    // FIXME: Wait for the speaker to empty the buffer
-                    vTaskDelay(pdMS_TO_TICKS(120));
+                if (previous_state == kDeviceStateSpeaking && !HasEchoReference()) {
+                    // 没有回声参考时等扬声器里剩下的数据播完，最多一圈 DMA
+                    int64_t remaining_us = board.GetAudioCodec()->output_drain_time_us() - esp_timer_get_time();
+                    if (remaining_us > 0) {
+                        vTaskDelay(pdMS_TO_TICKS(remaining_us / 1000 + 1));
+                    }
                 }
                 opus_encoder_->ResetState();
 #if CONFIG_USE_WAKE_WORD_DETECT
@@ -919,7 +1340,13 @@ void Application::SetDeviceState(DeviceState state) {
 #if CONFIG_USE_AUDIO_PROCESSOR
                 audio_processor_.Start();
 #endif
+                if (tts_drained_time_ != 0) {
+                    int64_t turnaround = esp_timer_get_time() - tts_drained_time_;
+                    Metrics::GetInstance().Observe(kMetricTurnaroundUs, (uint32_t)turnaround);
+                    ESP_LOGI(TAG, "Speaker drained to listening: %lld ms", turnaround / 1000);
+                }
             }
+            tts_drained_time_ = 0;
             break;
         case kDeviceStateSpeaking:
             //display->SetStatus(Lang::Strings::SPEAKING);
@@ -957,7 +1384,113 @@ void Application::ResetDecoder() {
     codec->EnableOutput(true);
 }
 
+void Application::WhenOutputDrained(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_output_drained_ = callback;
+}
+
+bool Application::HasEchoReference() {
+#if CONFIG_USE_AUDIO_PROCESSOR
+    return Board::GetInstance().GetAudioCodec()->input_reference();
+#else
+    return false;
+#endif
+}
+
+// 回复的语音播完：提示音和聆听同时开始。有回声消除时麦克风马上打开，提示音由 AEC 消掉；
+// 没有回声参考时等提示音也播完再打开
+void Application::OnSpeakingDrained() {
+    if (device_state_ != kDeviceStateSpeaking) {
+        return;
+    }
+    // 排空检查按音频循环的节奏进行，用扬声器实际播完的时间
+    tts_drained_time_ = std::max(Board::GetInstance().GetAudioCodec()->output_drain_time_us(), tts_stop_time_);
+    int64_t tail = tts_drained_time_ - tts_stop_time_;
+    Metrics::GetInstance().Observe(kMetricTtsTailUs, (uint32_t)tail);
+    ESP_LOGI(TAG, "TTS stop to speaker drained: %lld ms", tail / 1000);
+
+    PlayEarcon(Lang::Sounds::P3_SUCCESS);
+    if (HasEchoReference()) {
+        SetDeviceState(kDeviceStateListening);
+        return;
+    }
+    WhenOutputDrained([this]() {
+        if (device_state_ == kDeviceStateSpeaking) {
+            SetDeviceState(kDeviceStateListening);
+        }
+    });
+}
+
+void Application::PlayEarcon(const std::string_view& sound) {
+    background_task_->Schedule([this, sound]() {
+        // 提示音素材是 16000Hz、60ms 一帧
+        auto codec = Board::GetInstance().GetAudioCodec();
+        if (!earcon_decoder_) {
+            int sample_rate = AudioNegotiator::IsOpusRate(codec->output_sample_rate()) ? codec->output_sample_rate() : 16000;
+            earcon_decoder_ = std::make_unique<OpusDecoderWrapper>(sample_rate, 1, 60);
+            if (sample_rate != codec->output_sample_rate()) {
+                earcon_resampler_.Configure(sample_rate, codec->output_sample_rate());
+            }
+        }
+        earcon_decoder_->ResetState();
+        earcon_reader_ = P3Reader(sound.data(), sound.size());
+        earcon_pcm_.clear();
+        earcon_pos_ = 0;
+        earcon_playing_ = true;
+    });
+    Board::GetInstance().GetAudioCodec()->EnableOutput(true);
+}
+
+bool Application::DecodeEarconFrame() {
+    const uint8_t* payload;
+    uint16_t payload_size;
+    if (!earcon_reader_.Next(payload, payload_size)) {
+        return false;
+    }
+    std::vector<uint8_t> opus(payload, payload + payload_size);
+    if (!earcon_decoder_->Decode(std::move(opus), earcon_pcm_)) {
+        return false;
+    }
+    auto codec = Board::GetInstance().GetAudioCodec();
+    if (earcon_decoder_->sample_rate() != codec->output_sample_rate()) {
+        std::vector<int16_t> resampled(earcon_resampler_.GetOutputSamples(earcon_pcm_.size()));
+        earcon_resampler_.Process(earcon_pcm_.data(), earcon_pcm_.size(), resampled.data());
+        earcon_pcm_ = std::move(resampled);
+    }
+    earcon_pos_ = 0;
+    return true;
+}
+
+// 把提示音叠加到 pcm 上；pcm 为空时输出下一帧提示音本身。只在后台任务中调用
+void Application::MixEarcon(std::vector<int16_t>& pcm) {
+    bool alone = pcm.empty();
+    size_t offset = 0;
+    while (earcon_playing_ && (alone || offset < pcm.size())) {
+        if (earcon_pos_ == earcon_pcm_.size() && !DecodeEarconFrame()) {
+            earcon_playing_ = false;
+            break;
+        }
+        if (alone) {
+            pcm.assign(earcon_pcm_.begin() + earcon_pos_, earcon_pcm_.end());
+            earcon_pos_ = earcon_pcm_.size();
+            break;
+        }
+        size_t count = std::min(pcm.size() - offset, earcon_pcm_.size() - earcon_pos_);
+        for (size_t i = 0; i < count; i++) {
+            int sample = pcm[offset + i] + earcon_pcm_[earcon_pos_ + i];
+            pcm[offset + i] = (int16_t)std::clamp(sample, -32768, 32767);
+        }
+        offset += count;
+        earcon_pos_ += count;
+    }
+}
+
 void Application::SetDecodeSampleRate(int sample_rate, int frame_duration) {
+    // Opus 可以直接解码到任意支持的采样率，编解码器采样率是其中之一时不需要重采样
+    auto codec = Board::GetInstance().GetAudioCodec();
+    if (AudioNegotiator::IsOpusRate(codec->output_sample_rate())) {
+        sample_rate = codec->output_sample_rate();
+    }
     if (opus_decoder_->sample_rate() == sample_rate && opus_decoder_->duration_ms() == frame_duration) {
         return;
     }
@@ -965,7 +1498,6 @@ void Application::SetDecodeSampleRate(int sample_rate, int frame_duration) {
     opus_decoder_.reset();
     opus_decoder_ = std::make_unique<OpusDecoderWrapper>(sample_rate, 1, frame_duration);
 
-    auto codec = Board::GetInstance().GetAudioCodec();
     if (opus_decoder_->sample_rate() != codec->output_sample_rate()) {
         ESP_LOGI(TAG, "Resampling audio from %d to %d", opus_decoder_->sample_rate(), codec->output_sample_rate());
         output_resampler_.Configure(opus_decoder_->sample_rate(), codec->output_sample_rate());
@@ -1000,7 +1532,7 @@ void Application::WakeWordInvoke(const std::string& wake_word) {
     } else if (device_state_ == kDeviceStateListening) {   
         Schedule([this]() {
             if (protocol_) {
-                protocol_->CloseAudioChannel();
+                EndConversation();
             }
         });
     }
@@ -1100,12 +1632,11 @@ void Application::UartListenTask() {
                                 case 0x02: status_cn = "蓝牙已断开"; break;
                             }
 
-                            char json_buffer[256];
-                            snprintf(json_buffer, sizeof(json_buffer), "{\"type\":\"text2speech\", \"text\":\"%s%s\"}", device_name_cn, status_cn);
+                            std::string speech = std::string(device_name_cn) + status_cn;
                             
-                            ESP_LOGI(TAG, "状态变化: 转发状态帧 - %s%s", device_name_cn, status_cn);
+                            ESP_LOGI(TAG, "状态变化: 转发状态帧 - %s", speech.c_str());
                             if (protocol_) {
-                                protocol_->SendCustomText(json_buffer);
+                                protocol_->SendTextToSpeech(speech);
                                 if (device_state_ == kDeviceStateListening) {
                                     Schedule([this]() {
                                         aborted_ = false;
@@ -1115,6 +1646,16 @@ void Application::UartListenTask() {
                             }
                         }
                         
+#if CONFIG_USE_TRACE
+                    } else if (frame_type == 0x03) {
+                        // 调试帧：把追踪缓冲区打印到控制台
+                        Trace::GetInstance().Dump([](const std::string& chunk, bool last) {
+                            printf("%s", chunk.c_str());
+                            if (last) {
+                                printf("--- trace end ---\n");
+                            }
+                        });
+#endif
                     } else if (frame_type == 0x02) {
                         // 数据帧处理
                         int json_start = -1, json_end = -1;
@@ -6,6 +6,7 @@
 #include <freertos/task.h>
 #include <esp_timer.h>
 
+#include <atomic>
 #include <string>
 #include <mutex>
 #include <list>
@@ -53,6 +54,7 @@ public:
         static Application instance;
         return instance;
     }
+    static const char* GetDeviceStateName(DeviceState state);
     // 删除拷贝构造函数和赋值运算符
     Application(const Application&) = delete;
     Application& operator=(const Application&) = delete;
@@ -74,6 +76,8 @@ public:
     void WakeWordInvoke(const std::string& wake_word);
     void PlaySound(const std::string_view& sound);
     bool CanEnterSleepMode();
+    // 切换网络链路：在空闲或两次说话之间执行 switch_link 并在新链路上重建通道
+    void RequestNetworkMigration(std::function<void()> switch_link);
     //新增控制眼睛状态
     //void SetEyeState(bool awake);
 
@@ -104,7 +108,19 @@ private:
     bool aborted_ = false;
     bool voice_detected_ = false;
     bool busy_decoding_audio_ = false;
+    // 链路迁移主动关闭通道时设置，断开回调消费后清零；带截止时间，回调没来也不会一直生效
+    std::atomic<int64_t> migration_close_until_us_{0};
+    std::atomic<bool> preconnecting_{false};
+    int64_t wake_time_ = 0;
+    int64_t last_preconnect_time_ = 0;
+    // 唤醒后上传唤醒词和桥接音频期间，实时音频先存在这里，保证发送顺序
+    bool holding_live_audio_ = false;
+    std::list<std::vector<uint8_t>> held_audio_;
+    std::string uplink_wake_word_;
+    std::function<void()> pending_migration_;
     int clock_ticks_ = 0;
+    int metrics_report_ticks_ = 0;
+    bool metrics_report_pending_ = false;   // 到了上报时间但没有可用的连接，只在主循环访问
     TaskHandle_t check_new_version_task_handle_ = nullptr;
 
     // Audio encode / decode
@@ -116,13 +132,29 @@ private:
     std::chrono::steady_clock::time_point last_output_time_;
     std::list<std::vector<uint8_t>> audio_decode_queue_;
     std::condition_variable audio_decode_cv_;
+    // 输出排空（解码队列空、扬声器播完）后在主循环执行一次，受 mutex_ 保护
+    std::function<void()> on_output_drained_;
+    int64_t tts_stop_time_ = 0;
+    int64_t tts_drained_time_ = 0;
+
+    // 提示音用独立的解码器叠加到输出上，不进解码队列，状态切换清队列时也不会被打断。
+    // earcon_playing_ 由后台任务写入、OnAudioOutput 读取，其余成员只在后台任务中访问
+    std::atomic<bool> earcon_playing_{false};
+    std::unique_ptr<OpusDecoderWrapper> earcon_decoder_;
+    OpusResampler earcon_resampler_;
+    P3Reader earcon_reader_{nullptr, 0};
+    std::vector<int16_t> earcon_pcm_;
+    size_t earcon_pos_ = 0;
 
     std::unique_ptr<OpusEncoderWrapper> opus_encoder_;
     std::unique_ptr<OpusDecoderWrapper> opus_decoder_;
 
-    OpusResampler input_resampler_;
-    OpusResampler reference_resampler_;
+    // 每个输入声道（麦克风与参考）各一个重采样器
+    std::vector<std::unique_ptr<OpusResampler>> input_resamplers_;
     OpusResampler output_resampler_;
+    // 多声道输入拆分与重采样的暂存区，只在音频循环任务中使用，避免每帧分配
+    std::vector<std::vector<int16_t>> input_channels_;
+    std::vector<std::vector<int16_t>> resampled_channels_;
 
     void MainEventLoop();
     //--------------------------------//
@@ -135,10 +167,25 @@ private:
     void ResetDecoder();
     void SetDecodeSampleRate(int sample_rate, int frame_duration);
     void CheckNewVersion();
+    void RunPendingMigration();
+    void PreconnectAudioChannel();
+    void EndConversation();
     void ShowActivationCode();
     void OnClockTimer();
+    void SendAudio(const std::vector<uint8_t>& opus);
+    void SendAudioPacket(const std::vector<uint8_t>& opus);
+#if CONFIG_USE_WAKE_WORD_DETECT
+    void StartWakeWordUplink(const std::string& wake_word);
+    void WakeWordUplinkTask();
+#endif
     void SetListeningMode(ListeningMode mode);
     void AudioLoop();
+    void WhenOutputDrained(std::function<void()> callback);
+    bool HasEchoReference();
+    void OnSpeakingDrained();
+    void PlayEarcon(const std::string_view& sound);
+    bool DecodeEarconFrame();
+    void MixEarcon(std::vector<int16_t>& pcm);
 };
 
 #endif // _APPLICATION_H_
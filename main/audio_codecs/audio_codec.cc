@@ -1,9 +1,13 @@
 #include "audio_codec.h"
 #include "board.h"
 #include "settings.h"
+#include "power_state_manager.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_attr.h>
 #include <cstring>
+#include <algorithm>
 #include <driver/i2s_common.h>
 
 #define TAG "AudioCodec"
@@ -16,23 +20,129 @@ AudioCodec::~AudioCodec() {
 
 void AudioCodec::OutputData(std::vector<int16_t>& data) {
     Write(data.data(), data.size());
+    // Write 返回时数据已进入 DMA 缓冲区，还没播出的最多是一整圈 DMA
+    int64_t now = esp_timer_get_time();
+    int64_t duration_us = (int64_t)data.size() * 1000000 / output_sample_rate_;
+    int64_t dma_us = (int64_t)AUDIO_CODEC_DMA_DESC_NUM * AUDIO_CODEC_DMA_FRAME_NUM * 1000000 / output_sample_rate_;
+    // 只有后台任务写入，读出再写回不会丢失更新
+    int64_t drain_time_us = output_drain_time_us_.load();
+    output_drain_time_us_ = std::min(std::max(drain_time_us, now) + duration_us, now + dma_us);
 }
 
 bool AudioCodec::InputData(std::vector<int16_t>& data) {
     int samples = Read(data.data(), data.size());
     if (samples > 0) {
+        StampInput(samples);
         return true;
     }
     return false;
 }
 
+bool AudioCodec::AcquireInputFrame(int samples, AudioFrame& frame) {
+    if (input_frame_borrowed_) {
+        ESP_LOGE(TAG, "Input frame is already acquired");
+        return false;
+    }
+    // 缓冲区只在帧长变大时扩容，之后每帧都直接读进同一块内存
+    if ((int)input_frame_.size() < samples) {
+        input_frame_.resize(samples);
+    }
+    int read = Read(input_frame_.data(), samples);
+    if (read <= 0) {
+        return false;
+    }
+    StampInput(read);
+    input_frame_borrowed_ = true;
+    frame.data = input_frame_.data();
+    frame.samples = read;
+    frame.timestamp_us = last_input_timestamp_us_;
+    return true;
+}
+
+void AudioCodec::ReleaseInputFrame(AudioFrame& frame) {
+    input_frame_borrowed_ = false;
+    frame.data = nullptr;
+    frame.samples = 0;
+}
+
+// DMA 收到但还没读走的帧排在 DMA 环里，都在最近一次 DMA 完成之前采集。由积压的帧数倒推
+// 本次读到的最后一帧的采集时间，再减去本次读取的时长得到第一帧的时间
+void AudioCodec::StampInput(int samples) {
+    int frames = samples / input_channels_;
+    portENTER_CRITICAL(&rx_dma_lock_);
+    int64_t dma_time = rx_dma_time_us_;
+    uint64_t dma_frames = rx_dma_frames_;
+    portEXIT_CRITICAL(&rx_dma_lock_);
+
+    rx_read_frames_ += frames;
+    int64_t end_time;
+    if (dma_time == 0) {
+        end_time = esp_timer_get_time();
+    } else {
+        // 读取跟不上时驱动丢弃最旧的缓冲区，积压最多一整圈；超出或倒挂说明计数失步，重新对齐
+        const uint64_t ring_frames = AUDIO_CODEC_DMA_DESC_NUM * AUDIO_CODEC_DMA_FRAME_NUM;
+        if (dma_frames > rx_read_frames_ + ring_frames) {
+            rx_read_frames_ = dma_frames - ring_frames;
+        } else if (rx_read_frames_ > dma_frames) {
+            rx_read_frames_ = dma_frames;
+        }
+        int64_t backlog = dma_frames - rx_read_frames_;
+        end_time = dma_time - backlog * 1000000 / input_sample_rate_;
+    }
+    last_input_timestamp_us_ = end_time - (int64_t)frames * 1000000 / input_sample_rate_;
+}
+
+// 所有编解码器的接收通道都配置为每个 DMA 缓冲区 AUDIO_CODEC_DMA_FRAME_NUM 帧
+bool IRAM_ATTR AudioCodec::OnRxDmaDone(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx) {
+    auto codec = static_cast<AudioCodec*>(user_ctx);
+    portENTER_CRITICAL_ISR(&codec->rx_dma_lock_);
+    codec->rx_dma_time_us_ = esp_timer_get_time();
+    codec->rx_dma_frames_ += AUDIO_CODEC_DMA_FRAME_NUM;
+    portEXIT_CRITICAL_ISR(&codec->rx_dma_lock_);
+    return false;
+}
+
+AudioCodecCaps AudioCodec::GetCapabilities() const {
+    AudioCodecCaps caps;
+    caps.sample_rates.push_back(input_sample_rate_);
+    if (output_sample_rate_ != input_sample_rate_) {
+        caps.sample_rates.push_back(output_sample_rate_);
+    }
+    caps.reference_channels = input_reference_ ? 1 : 0;
+    caps.mic_channels = input_channels_ - caps.reference_channels;
+    caps.shared_clock = duplex_;
+    caps.input_sample_rate = input_sample_rate_;
+    caps.output_sample_rate = output_sample_rate_;
+    return caps;
+}
+
+bool AudioCodec::SetSampleRates(int input_sample_rate, int output_sample_rate) {
+    return input_sample_rate == input_sample_rate_ && output_sample_rate == output_sample_rate_;
+}
+
+bool AudioCodec::ReconfigureStdClock(i2s_chan_handle_t handle, int sample_rate) {
+    i2s_std_clk_config_t clk_cfg = I2S_STD_CLK_DEFAULT_CONFIG((uint32_t)sample_rate);
+    esp_err_t err = i2s_channel_reconfig_std_clock(handle, &clk_cfg);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to set sample rate %d: %s", sample_rate, esp_err_to_name(err));
+        return false;
+    }
+    return true;
+}
+
 void AudioCodec::Start() {
     Settings settings("audio", false);
-    output_volume_ = settings.GetInt("output_volume", output_volume_);
-    if (output_volume_ <= 0) {
-        ESP_LOGW(TAG, "Output volume value (%d) is too small, setting to default (10)", output_volume_);
-        output_volume_ = 10;
+    int volume = settings.GetInt("output_volume", output_volume_);
+    if (volume <= 0) {
+        ESP_LOGW(TAG, "Output volume value (%d) is too small, setting to default (10)", volume);
+        volume = 10;
     }
+    output_volume_ = volume;
+
+    // 回调只能在通道启用前注册
+    i2s_event_callbacks_t callbacks = {};
+    callbacks.on_recv = OnRxDmaDone;
+    ESP_ERROR_CHECK_WITHOUT_ABORT(i2s_channel_register_event_callback(rx_handle_, &callbacks, this));
 
     ESP_ERROR_CHECK(i2s_channel_enable(tx_handle_));
     ESP_ERROR_CHECK(i2s_channel_enable(rx_handle_));
@@ -44,16 +154,26 @@ void AudioCodec::Start() {
 
 void AudioCodec::SetOutputVolume(int volume) {
     output_volume_ = volume;
-    ESP_LOGI(TAG, "Set output volume to %d", output_volume_);
+    ESP_LOGI(TAG, "Set output volume to %d", volume);
     
     Settings settings("audio", true);
-    settings.SetInt("output_volume", output_volume_);
+    settings.SetInt("output_volume", volume);
+}
+
+// 输入或输出任意一路启用时持有音频 PM 锁
+static void UpdateAudioPmLock(bool was_active, bool active) {
+    if (active && !was_active) {
+        PowerStateManager::GetInstance().Acquire(kPmSubsystemAudio);
+    } else if (!active && was_active) {
+        PowerStateManager::GetInstance().Release(kPmSubsystemAudio);
+    }
 }
 
 void AudioCodec::EnableInput(bool enable) {
     if (enable == input_enabled_) {
         return;
     }
+    UpdateAudioPmLock(input_enabled_ || output_enabled_, enable || output_enabled_);
     input_enabled_ = enable;
     ESP_LOGI(TAG, "Set input enable to %s", enable ? "true" : "false");
 }
@@ -62,6 +182,7 @@ void AudioCodec::EnableOutput(bool enable) {
     if (enable == output_enabled_) {
         return;
     }
+    UpdateAudioPmLock(input_enabled_ || output_enabled_, input_enabled_ || enable);
     output_enabled_ = enable;
     ESP_LOGI(TAG, "Set output enable to %s", enable ? "true" : "false");
 }
@@ -5,15 +5,24 @@
 #include <freertos/event_groups.h>
 #include <driver/i2s_std.h>
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <functional>
 
 #include "board.h"
+#include "audio_negotiator.h"
 
 #define AUDIO_CODEC_DMA_DESC_NUM 6
 #define AUDIO_CODEC_DMA_FRAME_NUM 240
 
+// 从编解码器借出的一帧输入数据，用完后必须 ReleaseInputFrame 归还
+struct AudioFrame {
+    const int16_t* data = nullptr;
+    int samples = 0;            // 所有声道的样本总数，多声道交错存放
+    int64_t timestamp_us = 0;   // 第一个样本的采集时间（esp_timer 时基）
+};
+
 class AudioCodec {
 public:
     AudioCodec();
@@ -23,9 +32,18 @@ public:
     virtual void EnableInput(bool enable);
     virtual void EnableOutput(bool enable);
 
+    // 默认只支持构造时的采样率；可以改变采样率的编解码器需要同时重写这两个函数
+    virtual AudioCodecCaps GetCapabilities() const;
+    // 只能在 Start() 之前调用
+    virtual bool SetSampleRates(int input_sample_rate, int output_sample_rate);
+
     void Start();
     void OutputData(std::vector<int16_t>& data);
     bool InputData(std::vector<int16_t>& data);
+    // 借出编解码器内部的输入缓冲区，同一时间只能借出一帧。驱动仍会把 DMA 数据拷进这块缓冲区
+    // （i2s_channel_read 没有借用 DMA 缓冲区的接口），省掉的只是再拷到调用者 vector 的一次
+    bool AcquireInputFrame(int samples, AudioFrame& frame);
+    void ReleaseInputFrame(AudioFrame& frame);
 
     inline bool duplex() const { return duplex_; }
     inline bool input_reference() const { return input_reference_; }
@@ -36,6 +54,10 @@ public:
     inline int output_volume() const { return output_volume_; }
     inline bool input_enabled() const { return input_enabled_; }
     inline bool output_enabled() const { return output_enabled_; }
+    // 最近一次读取的第一个样本的采集时间
+    inline int64_t last_input_timestamp_us() const { return last_input_timestamp_us_; }
+    // 已写入的输出数据全部从扬声器播完的预计时间（esp_timer 时基）
+    inline int64_t output_drain_time_us() const { return output_drain_time_us_; }
 
 protected:
     i2s_chan_handle_t tx_handle_ = nullptr;
@@ -49,10 +71,26 @@ protected:
     int output_sample_rate_ = 0;
     int input_channels_ = 1;
     int output_channels_ = 1;
-    int output_volume_ = 70;
+    std::atomic<int> output_volume_{70};    // IoT 命令和按键在各自任务里修改，输出任务读取
 
     virtual int Read(int16_t* dest, int samples) = 0;
     virtual int Write(const int16_t* data, int samples) = 0;
+    // 标准 I2S 模式下重新配置时钟，通道尚未启用时有效
+    bool ReconfigureStdClock(i2s_chan_handle_t handle, int sample_rate);
+
+private:
+    std::vector<int16_t> input_frame_;
+    bool input_frame_borrowed_ = false;
+    int64_t last_input_timestamp_us_ = 0;
+    std::atomic<int64_t> output_drain_time_us_{0};    // 后台任务写入，主循环和音频循环读取
+    // I2S 接收 DMA 的进度，在中断中记录，不受任务调度延迟影响；64 位值用自旋锁保护，避免读到一半
+    portMUX_TYPE rx_dma_lock_ = portMUX_INITIALIZER_UNLOCKED;
+    int64_t rx_dma_time_us_ = 0;    // 最近一个 DMA 缓冲区填满的时间
+    uint64_t rx_dma_frames_ = 0;    // DMA 累计收到的帧数（每个采样时刻一帧）
+    uint64_t rx_read_frames_ = 0;   // 累计读走的帧数，只在读取音频的任务里访问
+
+    void StampInput(int samples);
+    static bool OnRxDmaDone(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
 };
 
 #endif // _AUDIO_CODEC_H
@@ -0,0 +1,93 @@
+#include "audio_negotiator.h"
+
+#include <cstdlib>
+
+#ifdef ESP_PLATFORM
+#include <esp_log.h>
+
+#define TAG "AudioNegotiator"
+#endif
+
+bool AudioNegotiator::IsOpusRate(int sample_rate) {
+    switch (sample_rate) {
+        case 8000:
+        case 12000:
+        case 16000:
+        case 24000:
+        case 48000:
+            return true;
+        default:
+            return false;
+    }
+}
+
+float AudioNegotiator::ResampleCost(int samples_per_second) {
+    return 100.0f * samples_per_second * kEstimatedResamplerCyclesPerSample / kCpuHz;
+}
+
+AudioPlan AudioNegotiator::MakePlan(const AudioCodecCaps& caps, int input_rate, int output_rate, int processing_rate, int stream_rate) {
+    AudioPlan plan;
+    plan.input_sample_rate = input_rate;
+    plan.output_sample_rate = output_rate;
+    plan.resample_input = input_rate != processing_rate;
+    plan.resample_output = !IsOpusRate(output_rate);
+    plan.decode_sample_rate = plan.resample_output ? stream_rate : output_rate;
+    plan.estimated_cpu_percent = 0;
+    if (plan.resample_input) {
+        // 每个声道单独重采样，开销按重采样器的输入采样率计
+        plan.estimated_cpu_percent += ResampleCost(input_rate * (caps.mic_channels + caps.reference_channels));
+    }
+    if (plan.resample_output) {
+        plan.estimated_cpu_percent += ResampleCost(plan.decode_sample_rate);
+    }
+    return plan;
+}
+
+AudioPlan AudioNegotiator::Negotiate(const AudioCodecCaps& caps, int processing_rate, int stream_rate, int min_output_rate) {
+    bool found = false;
+    AudioPlan best;
+
+    auto consider = [&](int input_rate, int output_rate) {
+        if (output_rate < min_output_rate) {
+            return;
+        }
+        AudioPlan plan = MakePlan(caps, input_rate, output_rate, processing_rate, stream_rate);
+
+        if (!found || plan.estimated_cpu_percent < best.estimated_cpu_percent ||
+            (plan.estimated_cpu_percent == best.estimated_cpu_percent &&
+             std::abs(output_rate - stream_rate) < std::abs(best.output_sample_rate - stream_rate))) {
+            best = plan;
+            found = true;
+        }
+    };
+
+    for (int output_rate : caps.sample_rates) {
+        if (caps.shared_clock) {
+            consider(output_rate, output_rate);
+        } else {
+            for (int input_rate : caps.sample_rates) {
+                consider(input_rate, output_rate);
+            }
+        }
+    }
+
+    if (!found) {
+        // 没有满足最低输出采样率的候选，保持编解码器当前配置
+#ifdef ESP_PLATFORM
+        ESP_LOGW(TAG, "No sample rate satisfies min output rate %d", min_output_rate);
+#endif
+        best = MakePlan(caps, caps.input_sample_rate, caps.output_sample_rate, processing_rate, stream_rate);
+    }
+    return best;
+}
+
+void AudioNegotiator::LogPlan(const AudioPlan& plan) {
+#ifdef ESP_PLATFORM
+    ESP_LOGI(TAG, "Codec in %d Hz%s, out %d Hz, decode %d Hz%s, estimated resampling CPU %.1f%%",
+        plan.input_sample_rate, plan.resample_input ? " (resampled)" : "",
+        plan.output_sample_rate, plan.decode_sample_rate, plan.resample_output ? " (resampled)" : "",
+        plan.estimated_cpu_percent);
+#else
+    (void)plan;
+#endif
+}
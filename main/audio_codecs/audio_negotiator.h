@@ -0,0 +1,55 @@
+#ifndef _AUDIO_NEGOTIATOR_H
+#define _AUDIO_NEGOTIATOR_H
+
+#include <vector>
+
+// 不依赖 IDF，scripts/audio_negotiator 在主机上直接编译本文件
+
+// 编解码器能力描述，供启动时的采样率协商使用
+struct AudioCodecCaps {
+    std::vector<int> sample_rates;     // 支持的采样率
+    int mic_channels = 1;
+    int reference_channels = 0;
+    bool shared_clock = true;          // 输入输出共用 I2S 时钟，两边采样率必须相同
+    int input_sample_rate = 16000;     // 当前配置
+    int output_sample_rate = 24000;
+};
+
+// 协商结果：编解码器采样率与音频链路上需要的重采样
+struct AudioPlan {
+    int input_sample_rate = 16000;
+    int output_sample_rate = 24000;
+    int decode_sample_rate = 24000;     // Opus 解码输出的采样率
+    bool resample_input = false;
+    bool resample_output = false;
+    float estimated_cpu_percent = 0;    // 重采样的估算 CPU 占用（单核）
+};
+
+/**
+ * @brief 启动时根据编解码器能力选择采样率。
+ *
+ * 处理链路固定为：麦克风 -> 16 kHz（AFE/编码器），服务器下发的 Opus -> 扬声器。
+ * Opus 解码器可以直接输出 8/12/16/24/48 kHz，与编码时的采样率无关，
+ * 所以输出端只要选中这几个采样率之一就不需要重采样。
+ * 在满足 min_output_rate 的候选里选重采样开销最小的一组，开销相同时选最接近 stream_rate 的；
+ * 没有候选时保持编解码器当前配置。
+ * scripts/audio_negotiator/negotiator_check.cc 在主机上核对协商结果，修改这里时请重新运行。
+ */
+class AudioNegotiator {
+public:
+    static AudioPlan Negotiate(const AudioCodecCaps& caps, int processing_rate, int stream_rate, int min_output_rate);
+    // 按给定的编解码器采样率计算重采样需求和开销，设置采样率失败时用来描述实际生效的配置
+    static AudioPlan MakePlan(const AudioCodecCaps& caps, int input_rate, int output_rate, int processing_rate, int stream_rate);
+    static bool IsOpusRate(int sample_rate);
+    static void LogPlan(const AudioPlan& plan);
+
+private:
+    // OpusResampler 每个输入样本的开销（CPU 周期），按 240 MHz 折算占用率。
+    // 只是估算值，没有在设备上实测，仅用于比较候选之间的相对开销
+    static constexpr int kEstimatedResamplerCyclesPerSample = 60;
+    static constexpr int kCpuHz = 240000000;
+
+    static float ResampleCost(int samples_per_second);
+};
+
+#endif // _AUDIO_NEGOTIATOR_H
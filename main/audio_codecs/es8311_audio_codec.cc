@@ -130,6 +130,30 @@ void Es8311AudioCodec::CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk, gp
     ESP_LOGI(TAG, "Duplex channels created");
 }
 
+AudioCodecCaps Es8311AudioCodec::GetCapabilities() const {
+    auto caps = AudioCodec::GetCapabilities();
+    // MCLK 为采样率 256 倍时 ES8311 支持的常用采样率
+    caps.sample_rates = {8000, 16000, 24000, 32000, 44100, 48000};
+    caps.shared_clock = true;
+    return caps;
+}
+
+bool Es8311AudioCodec::SetSampleRates(int input_sample_rate, int output_sample_rate) {
+    // 双工共用时钟，esp_codec_dev_open 时按新的采样率配置芯片
+    if (input_sample_rate != output_sample_rate) {
+        return false;
+    }
+    if (output_sample_rate == output_sample_rate_ && input_sample_rate == input_sample_rate_) {
+        return true;
+    }
+    if (!ReconfigureStdClock(tx_handle_, output_sample_rate) || !ReconfigureStdClock(rx_handle_, input_sample_rate)) {
+        return false;
+    }
+    input_sample_rate_ = input_sample_rate;
+    output_sample_rate_ = output_sample_rate;
+    return true;
+}
+
 void Es8311AudioCodec::SetOutputVolume(int volume) {
     ESP_ERROR_CHECK(esp_codec_dev_set_out_vol(output_dev_, volume));
     AudioCodec::SetOutputVolume(volume);
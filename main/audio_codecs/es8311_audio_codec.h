@@ -30,6 +30,8 @@ public:
         gpio_num_t pa_pin, uint8_t es8311_addr, bool use_mclk = true);
     virtual ~Es8311AudioCodec();
 
+    virtual AudioCodecCaps GetCapabilities() const override;
+    virtual bool SetSampleRates(int input_sample_rate, int output_sample_rate) override;
     virtual void SetOutputVolume(int volume) override;
     virtual void EnableInput(bool enable) override;
     virtual void EnableOutput(bool enable) override;
@@ -1,11 +1,24 @@
 #include "no_audio_codec.h"
+#include "sample_convert.h"
 
 #include <esp_log.h>
+#include <esp_heap_caps.h>
 #include <cmath>
 #include <cstring>
 
 #define TAG "NoAudioCodec"
 
+// 按需扩容的内部 RAM 缓冲区，避免每帧分配，也避免落到 PSRAM
+static int32_t* EnsureBuffer(int32_t* buffer, int& capacity, int samples) {
+    if (samples <= capacity) {
+        return buffer;
+    }
+    heap_caps_free(buffer);
+    buffer = (int32_t*)heap_caps_malloc(samples * sizeof(int32_t), MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    capacity = buffer != nullptr ? samples : 0;
+    return buffer;
+}
+
 NoAudioCodec::~NoAudioCodec() {
     if (rx_handle_ != nullptr) {
         ESP_ERROR_CHECK(i2s_channel_disable(rx_handle_));
@@ -13,6 +26,44 @@ NoAudioCodec::~NoAudioCodec() {
     if (tx_handle_ != nullptr) {
         ESP_ERROR_CHECK(i2s_channel_disable(tx_handle_));
     }
+    heap_caps_free(tx_buffer_);
+    heap_caps_free(rx_buffer_);
+}
+
+AudioCodecCaps NoAudioCodec::GetCapabilities() const {
+    auto caps = AudioCodec::GetCapabilities();
+    caps.sample_rates = {8000, 16000, 24000, 32000, 44100, 48000};
+    // 双工模式收发共用一个 I2S 端口，RX 实际跟随 TX 的时钟
+    caps.shared_clock = duplex_;
+    return caps;
+}
+
+bool NoAudioCodec::SetSampleRates(int input_sample_rate, int output_sample_rate) {
+    if (duplex_ && input_sample_rate != output_sample_rate) {
+        return false;
+    }
+    if (output_sample_rate != output_sample_rate_) {
+        if (!ReconfigureStdClock(tx_handle_, output_sample_rate)) {
+            return false;
+        }
+        output_sample_rate_ = output_sample_rate;
+    }
+    if (input_sample_rate != input_sample_rate_) {
+        if (pdm_input_) {
+#if SOC_I2S_SUPPORTS_PDM_RX
+            i2s_pdm_rx_clk_config_t clk_cfg = I2S_PDM_RX_CLK_DEFAULT_CONFIG((uint32_t)input_sample_rate);
+            if (i2s_channel_reconfig_pdm_rx_clock(rx_handle_, &clk_cfg) != ESP_OK) {
+                return false;
+            }
+#else
+            return false;
+#endif
+        } else if (!duplex_ && !ReconfigureStdClock(rx_handle_, input_sample_rate)) {
+            return false;
+        }
+        input_sample_rate_ = input_sample_rate;
+    }
+    return true;
 }
 
 NoAudioCodecDuplex::NoAudioCodecDuplex(int input_sample_rate, int output_sample_rate, gpio_num_t bclk, gpio_num_t ws, gpio_num_t dout, gpio_num_t din) {
@@ -273,6 +324,7 @@ NoAudioCodecSimplex::NoAudioCodecSimplex(int input_sample_rate, int output_sampl
 
 NoAudioCodecSimplexPdm::NoAudioCodecSimplexPdm(int input_sample_rate, int output_sample_rate, gpio_num_t spk_bclk, gpio_num_t spk_ws, gpio_num_t spk_dout, gpio_num_t mic_sck, gpio_num_t mic_din) {
     duplex_ = false;
+    pdm_input_ = true;
     input_sample_rate_ = input_sample_rate;
     output_sample_rate_ = output_sample_rate;
 
@@ -336,59 +388,53 @@ NoAudioCodecSimplexPdm::NoAudioCodecSimplexPdm(int input_sample_rate, int output
 }
 
 int NoAudioCodec::Write(const int16_t* data, int samples) {
-    std::vector<int32_t> buffer(samples);
+    tx_buffer_ = EnsureBuffer(tx_buffer_, tx_capacity_, samples);
+    if (tx_buffer_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate output buffer");
+        return 0;
+    }
 
     // output_volume_: 0-100
     // volume_factor_: 0-65536
-    int32_t volume_factor = pow(double(output_volume_) / 100.0, 2) * 65536;
-    for (int i = 0; i < samples; i++) {
-        int64_t temp = int64_t(data[i]) * volume_factor; // 使用 int64_t 进行乘法运算
-        if (temp > INT32_MAX) {
-            buffer[i] = INT32_MAX;
-        } else if (temp < INT32_MIN) {
-            buffer[i] = INT32_MIN;
-        } else {
-            buffer[i] = static_cast<int32_t>(temp);
-        }
+    int volume = output_volume_;
+    if (cached_volume_ != volume) {
+        cached_volume_ = volume;
+        volume_factor_ = VolumeFactorQ16(volume);
     }
+    ScaleToInt32(data, tx_buffer_, samples, volume_factor_);
 
     size_t bytes_written;
-    ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, buffer.data(), samples * sizeof(int32_t), &bytes_written, portMAX_DELAY));
+    ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, tx_buffer_, samples * sizeof(int32_t), &bytes_written, portMAX_DELAY));
     return bytes_written / sizeof(int32_t);
 }
 
 int NoAudioCodec::Read(int16_t* dest, int samples) {
     size_t bytes_read;
 
-    std::vector<int32_t> bit32_buffer(samples);
-    if (i2s_channel_read(rx_handle_, bit32_buffer.data(), samples * sizeof(int32_t), &bytes_read, portMAX_DELAY) != ESP_OK) {
+    rx_buffer_ = EnsureBuffer(rx_buffer_, rx_capacity_, samples);
+    if (rx_buffer_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate input buffer");
+        return 0;
+    }
+    if (i2s_channel_read(rx_handle_, rx_buffer_, samples * sizeof(int32_t), &bytes_read, portMAX_DELAY) != ESP_OK) {
         ESP_LOGE(TAG, "Read Failed!");
         return 0;
     }
 
     samples = bytes_read / sizeof(int32_t);
-    for (int i = 0; i < samples; i++) {
-        int32_t value = bit32_buffer[i] >> 12;
-        dest[i] = (value > INT16_MAX) ? INT16_MAX : (value < -INT16_MAX) ? -INT16_MAX : (int16_t)value;
-    }
+    NarrowToInt16(rx_buffer_, dest, samples);
     return samples;
 }
 
 int NoAudioCodecSimplexPdm::Read(int16_t* dest, int samples) {
     size_t bytes_read;
 
-    // PDM 解调后的数据位宽为 16 位
-    std::vector<int16_t> bit16_buffer(samples);
-    if (i2s_channel_read(rx_handle_, bit16_buffer.data(), samples * sizeof(int16_t), &bytes_read, portMAX_DELAY) != ESP_OK) {
+    // PDM 解调后的数据位宽为 16 位，直接读入目标缓冲区
+    if (i2s_channel_read(rx_handle_, dest, samples * sizeof(int16_t), &bytes_read, portMAX_DELAY) != ESP_OK) {
         ESP_LOGE(TAG, "Read Failed!");
         return 0;
     }
 
     // 计算实际读取的样本数
-    samples = bytes_read / sizeof(int16_t);
-
-    // 将 16 位数据直接复制到目标缓冲区
-    memcpy(dest, bit16_buffer.data(), samples * sizeof(int16_t));
-
-    return samples;
+    return bytes_read / sizeof(int16_t);
 }
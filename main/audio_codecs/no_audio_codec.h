@@ -8,11 +8,26 @@
 
 class NoAudioCodec : public AudioCodec {
 private:
+    // I2S 32 位样本的转换缓冲区，按需增长，读写各一份避免两个任务互相覆盖
+    int32_t* tx_buffer_ = nullptr;
+    int32_t* rx_buffer_ = nullptr;
+    int tx_capacity_ = 0;
+    int rx_capacity_ = 0;
+    // Q16 音量系数，音量变化时才重新计算
+    int cached_volume_ = -1;
+    int32_t volume_factor_ = 0;
+
     virtual int Write(const int16_t* data, int samples) override;
     virtual int Read(int16_t* dest, int samples) override;
 
+protected:
+    bool pdm_input_ = false;
+
 public:
     virtual ~NoAudioCodec();
+
+    virtual AudioCodecCaps GetCapabilities() const override;
+    virtual bool SetSampleRates(int input_sample_rate, int output_sample_rate) override;
 };
 
 class NoAudioCodecDuplex : public NoAudioCodec {
@@ -0,0 +1,60 @@
+#ifndef SAMPLE_CONVERT_H
+#define SAMPLE_CONVERT_H
+
+#include <cmath>
+#include <cstdint>
+
+/**
+ * NoAudioCodec 的 16/32 位样本转换，不依赖 IDF。
+ * scripts/sample_convert/sample_convert_bench.cc 在主机上和原来的逐样本实现逐位比对并测吞吐，修改这里时请重新运行。
+ */
+
+// 音量 0-100 对应的 Q16 系数 0-65536，按平方曲线
+inline int32_t VolumeFactorQ16(int volume) {
+    return pow(double(volume) / 100.0, 2) * 65536;
+}
+
+// 16 位样本乘以 Q16 音量系数扩展到 32 位。系数不超过 65536（音量 <= 100）时乘积不会溢出，
+// 可以省去 64 位乘法和饱和判断，每次处理 4 个样本便于编译器流水
+inline void ScaleToInt32(const int16_t* src, int32_t* dst, int samples, int32_t factor) {
+    int i = 0;
+    if (factor <= 65536) {
+        for (; i + 4 <= samples; i += 4) {
+            dst[i] = src[i] * factor;
+            dst[i + 1] = src[i + 1] * factor;
+            dst[i + 2] = src[i + 2] * factor;
+            dst[i + 3] = src[i + 3] * factor;
+        }
+        for (; i < samples; i++) {
+            dst[i] = src[i] * factor;
+        }
+        return;
+    }
+    for (; i < samples; i++) {
+        int64_t temp = int64_t(src[i]) * factor;
+        dst[i] = temp > INT32_MAX ? INT32_MAX : temp < INT32_MIN ? INT32_MIN : (int32_t)temp;
+    }
+}
+
+// 32 位样本取高位转为 16 位，限幅到 [-INT16_MAX, INT16_MAX]
+inline int16_t NarrowSample(int32_t sample) {
+    int32_t value = sample >> 12;
+    value = value > INT16_MAX ? INT16_MAX : value;
+    value = value < -INT16_MAX ? -INT16_MAX : value;
+    return (int16_t)value;
+}
+
+inline void NarrowToInt16(const int32_t* src, int16_t* dst, int samples) {
+    int i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        dst[i] = NarrowSample(src[i]);
+        dst[i + 1] = NarrowSample(src[i + 1]);
+        dst[i + 2] = NarrowSample(src[i + 2]);
+        dst[i + 3] = NarrowSample(src[i + 3]);
+    }
+    for (; i < samples; i++) {
+        dst[i] = NarrowSample(src[i]);
+    }
+}
+
+#endif // SAMPLE_CONVERT_H
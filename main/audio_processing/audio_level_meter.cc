@@ -0,0 +1,49 @@
+#include "audio_level_meter.h"
+
+// 满量程方波的均方值为 2^30（正弦为 2^29），-60 dB 对应约 2^10；log2 用 Q3 表示
+static constexpr int kFloorLog2Q3 = 10 << 3;
+static constexpr int kRangeLog2Q3 = 20 << 3;
+
+uint8_t AudioLevelMeter::Measure(const int16_t* data, size_t samples) {
+    if (samples == 0) {
+        return 0;
+    }
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        int32_t a = data[i], b = data[i + 1], c = data[i + 2], d = data[i + 3];
+        // 两个平方和不超过 2^31，四个一起加会溢出 32 位
+        sum += (uint32_t)(a * a) + (uint32_t)(b * b);
+        sum += (uint32_t)(c * c) + (uint32_t)(d * d);
+    }
+    for (; i < samples; i++) {
+        int32_t a = data[i];
+        sum += (uint32_t)(a * a);
+    }
+    uint32_t mean_square = (uint32_t)(sum / samples);
+    if (mean_square == 0) {
+        return 0;
+    }
+
+    // 整数部分取最高位，小数部分取其后 3 位
+    int msb = 31 - __builtin_clz(mean_square);
+    int fraction = msb >= 3 ? (mean_square >> (msb - 3)) & 7 : (mean_square << (3 - msb)) & 7;
+    int log2_q3 = (msb << 3) | fraction;
+    if (log2_q3 <= kFloorLog2Q3) {
+        return 0;
+    }
+    int level = (log2_q3 - kFloorLog2Q3) * 255 / kRangeLog2Q3;
+    return level > 255 ? 255 : (uint8_t)level;
+}
+
+void AudioLevelMeter::Update(AudioLevelChannel channel, const int16_t* data, size_t samples) {
+    uint8_t level = Measure(data, samples);
+    auto& peak = peaks_[channel];
+    uint8_t current = peak.load(std::memory_order_relaxed);
+    while (level > current && !peak.compare_exchange_weak(current, level, std::memory_order_relaxed)) {
+    }
+}
+
+uint8_t AudioLevelMeter::TakePeak(AudioLevelChannel channel) {
+    return peaks_[channel].exchange(0, std::memory_order_relaxed);
+}
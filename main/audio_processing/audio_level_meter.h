@@ -0,0 +1,60 @@
+#ifndef _AUDIO_LEVEL_METER_H_
+#define _AUDIO_LEVEL_METER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum AudioLevelChannel {
+    kAudioLevelInput,       // AFE 输出（麦克风）
+    kAudioLevelOutput,      // 解码后的 TTS
+    kAudioLevelChannelCount
+};
+
+/**
+ * @brief AudioLevelMeter 无锁电平表，音频路径只做一次遍历和一次原子比较交换。
+ *
+ * 电平是 0~255，对应 -60~0 dBFS，用均方值的整数 log2 近似（每级约 0.38 dB）。
+ * 写入端保存自上次读取以来的峰值，读取端 TakePeak() 取走并清零；
+ * 灯效按固定帧率读取，用 AudioLevelFollower 做起音/释音平滑。
+ * 不依赖 ESP-IDF，scripts/led_effects/level_meter_bench.cc 在主机上测量每帧开销。
+ */
+class AudioLevelMeter {
+public:
+    static AudioLevelMeter& GetInstance() {
+        static AudioLevelMeter instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    AudioLevelMeter(const AudioLevelMeter&) = delete;
+    AudioLevelMeter& operator=(const AudioLevelMeter&) = delete;
+
+    static uint8_t Measure(const int16_t* data, size_t samples);
+
+    void Update(AudioLevelChannel channel, const int16_t* data, size_t samples);
+    uint8_t TakePeak(AudioLevelChannel channel);
+
+private:
+    AudioLevelMeter() = default;
+
+    std::atomic<uint8_t> peaks_[kAudioLevelChannelCount] = {};
+};
+
+// 读取端的平滑：上升快、下降慢，避免灯光随音节闪烁
+class AudioLevelFollower {
+public:
+    uint8_t Next(uint8_t peak) {
+        if (peak > level_) {
+            level_ += (peak - level_ + 1) / 2;
+        } else {
+            level_ -= (level_ - peak + 7) / 8;
+        }
+        return level_;
+    }
+    void Reset() { level_ = 0; }
+
+private:
+    uint8_t level_ = 0;
+};
+
+#endif // _AUDIO_LEVEL_METER_H_
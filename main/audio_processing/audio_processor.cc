@@ -1,4 +1,7 @@
 #include "audio_processor.h"
+#include "metrics.h"
+#include "trace.h"
+#include "heap_tracker.h"
 #include <esp_log.h>
 
 #define PROCESSOR_RUNNING 0x01
@@ -14,13 +17,9 @@ void AudioProcessor::Initialize(AudioCodec* codec, bool realtime_chat) {
     codec_ = codec;
     int ref_num = codec_->input_reference() ? 1 : 0;
 
-    std::string input_format;
-    for (int i = 0; i < codec_->input_channels() - ref_num; i++) {
-        input_format.push_back('M');
-    }
-    for (int i = 0; i < ref_num; i++) {
-        input_format.push_back('R');
-    }
+    mic_array_.Configure(codec_->input_channels(), ref_num, 16000, MIC_ARRAY_SPACING_MM,
+        MIC_ARRAY_STEER_DEGREES, MIC_ARRAY_BEAMFORMING);
+    std::string input_format = mic_array_.GetAfeInputFormat();
 
     srmodel_list_t *models = esp_srmodel_init("model");
     char* ns_model_name = esp_srmodel_filter(models, ESP_NSNET_PREFIX, NULL);
@@ -75,7 +74,7 @@ void AudioProcessor::Feed(const std::vector<int16_t>& data) {
     if (afe_data_ == nullptr) {
         return;
     }
-    afe_iface_->feed(afe_data_, data.data());
+    afe_iface_->feed(afe_data_, mic_array_.Process(data).data());
 }
 
 void AudioProcessor::Start() {
@@ -102,6 +101,7 @@ void AudioProcessor::OnVadStateChange(std::function<void(bool speaking)> callbac
 }
 
 void AudioProcessor::AudioProcessorTask() {
+    HeapTracker::SetTaskTag(kHeapTagAudio);
     auto fetch_size = afe_iface_->get_fetch_chunksize(afe_data_);
     auto feed_size = afe_iface_->get_feed_chunksize(afe_data_);
     ESP_LOGI(TAG, "Audio communication task started, feed size: %d fetch size: %d",
@@ -110,7 +110,11 @@ void AudioProcessor::AudioProcessorTask() {
     while (true) {
         xEventGroupWaitBits(event_group_, PROCESSOR_RUNNING, pdFALSE, pdTRUE, portMAX_DELAY);
 
+        int64_t fetch_start = esp_timer_get_time();
+        TRACE_BEGIN("afe_fetch");
         auto res = afe_iface_->fetch_with_delay(afe_data_, portMAX_DELAY);
+        TRACE_END("afe_fetch");
+        Metrics::GetInstance().Observe(kMetricAfeFetchWaitUs, (uint32_t)(esp_timer_get_time() - fetch_start));
         if ((xEventGroupGetBits(event_group_) & PROCESSOR_RUNNING) == 0) {
             continue;
         }
@@ -133,6 +137,7 @@ void AudioProcessor::AudioProcessorTask() {
         }
 
         if (output_callback_) {
+            TRACE_SCOPE("afe_output");
             output_callback_(std::vector<int16_t>(res->data, res->data + res->data_size / sizeof(int16_t)));
         }
     }
@@ -11,6 +11,7 @@
 #include <functional>
 
 #include "audio_codec.h"
+#include "mic_array.h"
 
 class AudioProcessor {
 public:
@@ -33,6 +34,7 @@ private:
     std::function<void(std::vector<int16_t>&& data)> output_callback_;
     std::function<void(bool speaking)> vad_state_change_callback_;
     AudioCodec* codec_ = nullptr;
+    MicArray mic_array_;
     bool is_speaking_ = false;
 
     void AudioProcessorTask();
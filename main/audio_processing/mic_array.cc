@@ -0,0 +1,132 @@
+#include "mic_array.h"
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef ESP_PLATFORM
+#include "metrics.h"
+#include <esp_log.h>
+
+#define TAG "MicArray"
+#endif
+
+void MicArray::Deinterleave(const int16_t* input, size_t frames, std::vector<std::vector<int16_t>>& channels) {
+    size_t count = channels.size();
+    for (auto& channel : channels) {
+        channel.resize(frames);
+    }
+    // 常见的双声道（麦克风 + 参考）单独展开，其余布局按声道跨步拷贝
+    if (count == 2) {
+        int16_t* left = channels[0].data();
+        int16_t* right = channels[1].data();
+        for (size_t i = 0; i < frames; i++) {
+            left[i] = input[2 * i];
+            right[i] = input[2 * i + 1];
+        }
+        return;
+    }
+    for (size_t c = 0; c < count; c++) {
+        int16_t* out = channels[c].data();
+        const int16_t* in = input + c;
+        for (size_t i = 0; i < frames; i++, in += count) {
+            out[i] = *in;
+        }
+    }
+}
+
+void MicArray::Interleave(const std::vector<std::vector<int16_t>>& channels, std::vector<int16_t>& output) {
+    size_t count = channels.size();
+    size_t frames = count > 0 ? channels[0].size() : 0;
+    output.resize(frames * count);
+    if (count == 2) {
+        const int16_t* left = channels[0].data();
+        const int16_t* right = channels[1].data();
+        for (size_t i = 0; i < frames; i++) {
+            output[2 * i] = left[i];
+            output[2 * i + 1] = right[i];
+        }
+        return;
+    }
+    for (size_t c = 0; c < count; c++) {
+        const int16_t* in = channels[c].data();
+        int16_t* out = output.data() + c;
+        for (size_t i = 0; i < frames; i++, out += count) {
+            *out = in[i];
+        }
+    }
+}
+
+void MicArray::Configure(int channels, int ref_channels, int sample_rate, int spacing_mm, int steer_degrees, bool beamforming) {
+    channels_ = channels;
+    ref_channels_ = ref_channels;
+    int mics = mic_channels();
+    beamforming_ = beamforming && mics > 1;
+    if (!beamforming_) {
+        return;
+    }
+
+    // 声源在 steer_degrees 方向时，第 m 路麦克风比第 0 路晚 m * d * sin(θ) / c 收到，
+    // 先收到的麦克风补上差值使各路对齐
+    double sin_theta = sin(steer_degrees * M_PI / 180.0);
+    std::vector<double> arrival(mics);
+    double latest = 0;
+    for (int m = 0; m < mics; m++) {
+        arrival[m] = m * spacing_mm * sin_theta / kSpeedOfSoundMmPerSecond;
+        latest = std::max(latest, arrival[m]);
+    }
+    delays_.resize(mics);
+    max_delay_ = 0;
+    for (int m = 0; m < mics; m++) {
+        delays_[m] = (int)lround((latest - arrival[m]) * sample_rate);
+        max_delay_ = std::max(max_delay_, delays_[m]);
+    }
+    history_.assign(mics, std::vector<int16_t>(max_delay_, 0));
+    inverse_q15_ = 32768 / mics;
+#ifdef ESP_PLATFORM
+    ESP_LOGI(TAG, "Delay-and-sum beamforming: %d mics, spacing %d mm, steer %d degrees, max delay %d samples",
+        mics, spacing_mm, steer_degrees, max_delay_);
+#endif
+}
+
+std::string MicArray::GetAfeInputFormat() const {
+    std::string format(beamforming_ ? 1 : mic_channels(), 'M');
+    format.append(ref_channels_, 'R');
+    return format;
+}
+
+const std::vector<int16_t>& MicArray::Process(const std::vector<int16_t>& input) {
+    if (!beamforming_) {
+        return input;
+    }
+#ifdef ESP_PLATFORM
+    MetricsTimer timer(kMetricBeamformUs);
+#endif
+
+    int mics = mic_channels();
+    int out_channels = output_channels();
+    int frames = input.size() / channels_;
+    output_.resize(frames * out_channels);
+
+    for (int n = 0; n < frames; n++) {
+        const int16_t* in = input.data() + n * channels_;
+        int32_t sum = 0;
+        for (int m = 0; m < mics; m++) {
+            int index = n - delays_[m];
+            sum += index >= 0 ? input[index * channels_ + m] : history_[m][max_delay_ + index];
+        }
+        int16_t* out = output_.data() + n * out_channels;
+        out[0] = (int16_t)((sum * inverse_q15_) >> 15);
+        for (int r = 0; r < ref_channels_; r++) {
+            out[1 + r] = in[mics + r];
+        }
+    }
+
+    // 保存每路麦克风末尾的样本，供下一帧开头的延迟读取
+    for (int m = 0; m < mics && max_delay_ > 0; m++) {
+        for (int i = 0; i < max_delay_; i++) {
+            int index = frames - max_delay_ + i;
+            history_[m][i] = index >= 0 ? input[index * channels_ + m] : history_[m][i + frames];
+        }
+    }
+    return output_;
+}
@@ -0,0 +1,64 @@
+#ifndef MIC_ARRAY_H
+#define MIC_ARRAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 不依赖 IDF，scripts/mic_array 在主机上直接编译本文件
+#ifdef ESP_PLATFORM
+#include <sdkconfig.h>
+#endif
+
+#ifdef CONFIG_USE_MIC_BEAMFORMING
+#define MIC_ARRAY_BEAMFORMING true
+#define MIC_ARRAY_SPACING_MM CONFIG_MIC_ARRAY_SPACING_MM
+#define MIC_ARRAY_STEER_DEGREES CONFIG_MIC_ARRAY_STEER_DEGREES
+#else
+#define MIC_ARRAY_BEAMFORMING false
+#define MIC_ARRAY_SPACING_MM 0
+#define MIC_ARRAY_STEER_DEGREES 0
+#endif
+
+/**
+ * @brief MicArray 多麦克风输入前端，位于 ReadAudio 与 AFE 之间。
+ *
+ * - Deinterleave/Interleave：任意声道数的交错数据与分声道缓冲区互转；
+ * - 可选的延迟求和波束形成：线阵各路麦克风按几何延迟对齐后求平均，合成一路麦克风送给 AFE，
+ *   参考声道原样保留。对互不相关的噪声最多有 10*log10(麦克风数) dB 的信噪比增益。
+ *
+ * 声道布局与 AFE 一致：麦克风在前，参考声道在后。
+ * scripts/mic_array/mic_array_check.cc 在主机上用已知输入核对输出，scripts/beamform_eval.py 通过它评估信噪比增益，
+ * 修改这里时请重新运行。
+ */
+class MicArray {
+public:
+    static void Deinterleave(const int16_t* input, size_t frames, std::vector<std::vector<int16_t>>& channels);
+    static void Interleave(const std::vector<std::vector<int16_t>>& channels, std::vector<int16_t>& output);
+
+    // spacing_mm: 相邻麦克风间距，steer_degrees: 0 为阵列正前方（垂直于阵列方向）
+    void Configure(int channels, int ref_channels, int sample_rate, int spacing_mm, int steer_degrees, bool beamforming);
+
+    bool beamforming() const { return beamforming_; }
+    int mic_channels() const { return channels_ - ref_channels_; }
+    // 送给 AFE 的声道数和格式，例如 "MMR"，启用波束形成后为 "MR"
+    int output_channels() const { return beamforming_ ? 1 + ref_channels_ : channels_; }
+    std::string GetAfeInputFormat() const;
+
+    // 交错输入，返回交错输出；未启用波束形成时直接返回输入
+    const std::vector<int16_t>& Process(const std::vector<int16_t>& input);
+
+private:
+    static constexpr int kSpeedOfSoundMmPerSecond = 343000;
+
+    int channels_ = 1;
+    int ref_channels_ = 0;
+    bool beamforming_ = false;
+    int32_t inverse_q15_ = 32768;           // 1 / 麦克风数
+    std::vector<int> delays_;               // 每路麦克风的对齐延迟（样本）
+    int max_delay_ = 0;
+    std::vector<std::vector<int16_t>> history_;  // 每路麦克风上一帧末尾 max_delay_ 个样本
+    std::vector<int16_t> output_;
+};
+
+#endif // MIC_ARRAY_H
@@ -1,5 +1,6 @@
 #include "wake_word_detect.h"
 #include "application.h"
+#include "heap_tracker.h"
 
 #include <esp_log.h>
 #include <model_path.h>
@@ -49,13 +50,9 @@ void WakeWordDetect::Initialize(AudioCodec* codec) {
         }
     }
 
-    std::string input_format;
-    for (int i = 0; i < codec_->input_channels() - ref_num; i++) {
-        input_format.push_back('M');
-    }
-    for (int i = 0; i < ref_num; i++) {
-        input_format.push_back('R');
-    }
+    mic_array_.Configure(codec_->input_channels(), ref_num, 16000, MIC_ARRAY_SPACING_MM,
+        MIC_ARRAY_STEER_DEGREES, MIC_ARRAY_BEAMFORMING);
+    std::string input_format = mic_array_.GetAfeInputFormat();
     afe_config_t* afe_config = afe_config_init(input_format.c_str(), models, AFE_TYPE_SR, AFE_MODE_HIGH_PERF);
     afe_config->aec_init = codec_->input_reference();
     afe_config->aec_mode = AEC_MODE_SR_HIGH_PERF;
@@ -77,7 +74,17 @@ void WakeWordDetect::OnWakeWordDetected(std::function<void(const std::string& wa
     wake_word_detected_callback_ = callback;
 }
 
+void WakeWordDetect::OnSpeechStart(std::function<void()> callback) {
+    speech_start_callback_ = callback;
+}
+
 void WakeWordDetect::StartDetection() {
+    {
+        std::lock_guard<std::mutex> lock(wake_word_mutex_);
+        streaming_ = false;
+        stream_pcm_.clear();
+        wake_word_cv_.notify_all();
+    }
     xEventGroupSetBits(event_group_, DETECTION_RUNNING_EVENT);
 }
 
@@ -86,6 +93,22 @@ void WakeWordDetect::StopDetection() {
     if (afe_data_ != nullptr) {
         afe_iface_->reset_buffer(afe_data_);
     }
+    // 已经送进 AFE 但还没取出的采样随 reset 丢弃，桥接音频在这里结束
+    uint32_t fed = fed_samples_.load();
+    uint32_t pending = fed - fetched_samples_.load();
+    fetched_samples_.store(fed);
+
+    std::lock_guard<std::mutex> lock(wake_word_mutex_);
+    if (streaming_) {
+        streaming_ = false;
+        handoff_gap_samples_ = pending;
+        wake_word_cv_.notify_all();
+    }
+}
+
+void WakeWordDetect::DiscardStream() {
+    std::lock_guard<std::mutex> lock(wake_word_mutex_);
+    stream_pcm_.clear();
 }
 
 bool WakeWordDetect::IsDetectionRunning() {
@@ -96,7 +119,8 @@ void WakeWordDetect::Feed(const std::vector<int16_t>& data) {
     if (afe_data_ == nullptr) {
         return;
     }
-    afe_iface_->feed(afe_data_, data.data());
+    afe_iface_->feed(afe_data_, mic_array_.Process(data).data());
+    fed_samples_.fetch_add(data.size() / codec_->input_channels());
 }
 
 size_t WakeWordDetect::GetFeedSize() {
@@ -107,6 +131,7 @@ size_t WakeWordDetect::GetFeedSize() {
 }
 
 void WakeWordDetect::AudioDetectionTask() {
+    HeapTracker::SetTaskTag(kHeapTagAudio);
     auto fetch_size = afe_iface_->get_fetch_chunksize(afe_data_);
     auto feed_size = afe_iface_->get_feed_chunksize(afe_data_);
     ESP_LOGI(TAG, "Audio detection task started, feed size: %d fetch size: %d",
@@ -120,11 +145,37 @@ void WakeWordDetect::AudioDetectionTask() {
             continue;;
         }
 
+        size_t samples = res->data_size / sizeof(int16_t);
+        fetched_samples_.fetch_add(samples);
+        {
+            std::lock_guard<std::mutex> lock(wake_word_mutex_);
+            if (streaming_) {
+                // 唤醒之后的音频交给编码任务，接在唤醒词数据后面
+                stream_pcm_.emplace_back((int16_t*)res->data, (int16_t*)res->data + samples);
+                wake_word_cv_.notify_all();
+                continue;
+            }
+        }
+
         // Store the wake word data for voice recognition, like who is speaking
-        StoreWakeWordData((uint16_t*)res->data, res->data_size / sizeof(uint16_t));
+        StoreWakeWordData((uint16_t*)res->data, samples);
+
+        if (res->vad_state == VAD_SPEECH && !is_speaking_) {
+            is_speaking_ = true;
+            if (speech_start_callback_) {
+                speech_start_callback_();
+            }
+        } else if (res->vad_state == VAD_SILENCE) {
+            is_speaking_ = false;
+        }
 
         if (res->wakeup_state == WAKENET_DETECTED) {
-            StopDetection();
+            // 不停止检测，继续采集桥接音频，由应用决定什么时候 StopDetection()
+            {
+                std::lock_guard<std::mutex> lock(wake_word_mutex_);
+                streaming_ = true;
+                stream_pcm_.clear();
+            }
             last_detected_wake_word_ = wake_words_[res->wake_word_index - 1];
 
             if (wake_word_detected_callback_) {
@@ -150,12 +201,16 @@ void WakeWordDetect::EncodeWakeWordData() {
     }
     wake_word_encode_task_ = xTaskCreateStatic([](void* arg) {
         auto this_ = (WakeWordDetect*)arg;
+        HeapTracker::SetTaskTag(kHeapTagAudio);
         {
             auto start_time = esp_timer_get_time();
             auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);
             encoder->SetComplexity(0); // 0 is the fastest
 
+            const size_t frame_samples = 16000 * OPUS_FRAME_DURATION_MS / 1000;
+            size_t submitted_samples = 0;
             for (auto& pcm: this_->wake_word_pcm_) {
+                submitted_samples += pcm.size();
                 encoder->Encode(std::move(pcm), [this_](std::vector<uint8_t>&& opus) {
                     std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
                     this_->wake_word_opus_.emplace_back(std::move(opus));
@@ -168,6 +223,46 @@ void WakeWordDetect::EncodeWakeWordData() {
             ESP_LOGI(TAG, "Encode wake word opus %zu packets in %lld ms",
                 this_->wake_word_opus_.size(), (end_time - start_time) / 1000);
 
+            {
+                std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                this_->wake_word_opus_.push_back(std::vector<uint8_t>());
+                this_->wake_word_cv_.notify_all();
+            }
+
+            // 桥接音频：边采集边编码，直到 StopDetection() 结束桥接
+            size_t stream_packets = 0;
+            while (true) {
+                std::unique_lock<std::mutex> lock(this_->wake_word_mutex_);
+                this_->wake_word_cv_.wait(lock, [this_]() {
+                    return !this_->stream_pcm_.empty() || !this_->streaming_;
+                });
+                if (this_->stream_pcm_.empty()) {
+                    break;
+                }
+                auto pcm = std::move(this_->stream_pcm_.front());
+                this_->stream_pcm_.pop_front();
+                lock.unlock();
+                submitted_samples += pcm.size();
+                encoder->Encode(std::move(pcm), [this_, &stream_packets](std::vector<uint8_t>&& opus) {
+                    std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                    this_->wake_word_opus_.emplace_back(std::move(opus));
+                    this_->wake_word_cv_.notify_all();
+                    stream_packets++;
+                });
+            }
+            // 编码器里不足一帧的尾巴补静音编出来，不丢掉最后几十毫秒
+            if (submitted_samples % frame_samples != 0) {
+                encoder->Encode(std::vector<int16_t>(frame_samples - submitted_samples % frame_samples, 0),
+                    [this_, &stream_packets](std::vector<uint8_t>&& opus) {
+                    std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
+                    this_->wake_word_opus_.emplace_back(std::move(opus));
+                    this_->wake_word_cv_.notify_all();
+                    stream_packets++;
+                });
+            }
+            ESP_LOGI(TAG, "Encode %zu bridge packets, handoff gap %lu samples", stream_packets,
+                (unsigned long)this_->handoff_gap_samples_);
+
             std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
             this_->wake_word_opus_.push_back(std::vector<uint8_t>());
             this_->wake_word_cv_.notify_all();
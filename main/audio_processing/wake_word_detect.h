@@ -14,8 +14,10 @@
 #include <functional>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 
 #include "audio_codec.h"
+#include "mic_array.h"
 
 class WakeWordDetect {
 public:
@@ -25,12 +27,20 @@ public:
     void Initialize(AudioCodec* codec);
     void Feed(const std::vector<int16_t>& data);
     void OnWakeWordDetected(std::function<void(const std::string& wake_word)> callback);
+    // 检测期间 VAD 从静音变为说话时触发，早于唤醒词确认，可用于提前建立连接
+    void OnSpeechStart(std::function<void()> callback);
     void StartDetection();
     void StopDetection();
+    // 唤醒后不上传时丢掉已经采集的桥接音频，配合 StopDetection() 使用
+    void DiscardStream();
     bool IsDetectionRunning();
     size_t GetFeedSize();
+    // 编码唤醒词之前的缓存，接着编码唤醒后继续采集的桥接音频，直到 StopDetection()
     void EncodeWakeWordData();
+    // 依次取出编码后的包：先是唤醒词数据，返回 false 表示一段结束；再调用一次取桥接音频
     bool GetWakeWordOpus(std::vector<uint8_t>& opus);
+    // 最近一次停止桥接时 AFE 里没来得及取出、被丢弃的采样数（16kHz）
+    uint32_t handoff_gap_samples() const { return handoff_gap_samples_; }
     const std::string& GetLastDetectedWakeWord() const { return last_detected_wake_word_; }
 
 private:
@@ -40,7 +50,10 @@ private:
     std::vector<std::string> wake_words_;
     EventGroupHandle_t event_group_;
     std::function<void(const std::string& wake_word)> wake_word_detected_callback_;
+    std::function<void()> speech_start_callback_;
+    bool is_speaking_ = false;
     AudioCodec* codec_ = nullptr;
+    MicArray mic_array_;
     std::string last_detected_wake_word_;
 
     TaskHandle_t wake_word_encode_task_ = nullptr;
@@ -50,6 +63,12 @@ private:
     std::list<std::vector<uint8_t>> wake_word_opus_;
     std::mutex wake_word_mutex_;
     std::condition_variable wake_word_cv_;
+    // 唤醒后不停止检测任务，继续取 AFE 输出作为桥接音频，避免连接期间的音频丢失
+    bool streaming_ = false;
+    std::list<std::vector<int16_t>> stream_pcm_;
+    std::atomic<uint32_t> fed_samples_{0};
+    std::atomic<uint32_t> fetched_samples_{0};
+    uint32_t handoff_gap_samples_ = 0;
 
     void StoreWakeWordData(uint16_t* data, size_t size);
     void AudioDetectionTask();
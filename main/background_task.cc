@@ -1,4 +1,5 @@
 #include "background_task.h"
+#include "trace.h"
 
 #include <esp_log.h>
 #include <esp_task_wdt.h>
@@ -57,6 +58,7 @@ void BackgroundTask::BackgroundTaskLoop() {
         lock.unlock();
 
         for (auto& task : tasks) {
+            TRACE_SCOPE("background_task");
             task();
         }
     }
@@ -15,6 +15,7 @@ public:
 
     void Schedule(std::function<void()> callback);
     void WaitForCompletion();
+    size_t active_tasks() const { return active_tasks_.load(); }
 
 private:
     std::mutex mutex_;
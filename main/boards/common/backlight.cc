@@ -1,5 +1,6 @@
 #include "backlight.h"
 #include "settings.h"
+#include "frame_rate_governor.h"
 
 #include <esp_log.h>
 #include <driver/ledc.h>
@@ -59,6 +60,10 @@ void Backlight::SetBrightness(uint8_t brightness, bool permanent) {
 
     target_brightness_ = brightness;
     step_ = (target_brightness_ > brightness_) ? 1 : -1;
+    if (brightness_ == 0 && target_brightness_ > 0) {
+        // 背光点亮前先恢复动画，避免亮屏后看到停住的画面
+        FrameRateGovernor::GetInstance().SetBacklightOn(true);
+    }
 
     if (transition_timer_ != nullptr) {
         // 启动定时器，每 5ms 更新一次
@@ -75,6 +80,9 @@ void Backlight::OnTransitionTimer() {
 
     brightness_ += step_;
     SetBrightnessImpl(brightness_);
+    if (brightness_ == 0) {
+        FrameRateGovernor::GetInstance().SetBacklightOn(false);
+    }
 
     if (brightness_ == target_brightness_) {
         esp_timer_stop(transition_timer_);
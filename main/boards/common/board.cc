@@ -1,5 +1,10 @@
 #include "board.h"
 #include "system_info.h"
+#include "cpu_sampler.h"
+#include "flight_recorder.h"
+#include "power_state_manager.h"
+#include "tls_session_cache.h"
+#include "frame_rate_governor.h"
 #include "settings.h"
 #include "display/display.h"
 #include "assets/lang_config.h"
@@ -93,6 +98,10 @@ std::string Board::GetJson() {
             "ota": {
                 "label": "ota_0"
             },
+            "cpu": {
+                "interval_ms": 1000,
+                "states": { "idle": { "samples": 10, "avg_load": 12.5, "peak_load": 30, "top_tasks": {...} } }
+            },
             "board": {
                 ...
             }
@@ -151,6 +160,17 @@ std::string Board::GetJson() {
     json += "\"label\":\"" + std::string(ota_partition->label) + "\"";
     json += "},";
 
+    json += "\"cpu\":" + CpuSampler::GetInstance().GetJson() + ",";
+    json += "\"power\":" + PowerStateManager::GetInstance().GetJson() + ",";
+    json += "\"display_fps\":" + FrameRateGovernor::GetInstance().GetJson() + ",";
+    json += "\"tls\":" + TlsSessionCache::GetInstance().GetJson() + ",";
+
+    // 上一次运行的飞行记录（热复位后保留在 RTC 内存中）
+    auto& recorder = FlightRecorder::GetInstance();
+    if (recorder.HasPreviousBoot()) {
+        json += "\"last_boot\":" + recorder.GetPreviousBootJson() + ",";
+    }
+
     json += "\"board\":" + GetBoardJson();
 
     // Close the JSON object
@@ -1,6 +1,8 @@
 #include "button.h"
+#include "input_event_bus.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
 
 static const char* TAG = "Button";
 #if CONFIG_SOC_ADC_SUPPORTED
@@ -97,6 +99,21 @@ void Button::OnClick(std::function<void()> callback) {
     }, this);
 }
 
+void Button::PostEvents(uint8_t source) {
+    if (button_handle_ == nullptr) {
+        return;
+    }
+    event_source_ = source;
+    iot_button_register_cb(button_handle_, BUTTON_PRESS_DOWN, [](void* handle, void* usr_data) {
+        Button* button = static_cast<Button*>(usr_data);
+        InputEventBus::GetInstance().Post(kInputPressDown, button->event_source_, 0, esp_timer_get_time());
+    }, this);
+    iot_button_register_cb(button_handle_, BUTTON_PRESS_UP, [](void* handle, void* usr_data) {
+        Button* button = static_cast<Button*>(usr_data);
+        InputEventBus::GetInstance().Post(kInputPressUp, button->event_source_, 0, esp_timer_get_time());
+    }, this);
+}
+
 void Button::OnDoubleClick(std::function<void()> callback) {
     if (button_handle_ == nullptr) {
         return;
@@ -26,11 +26,15 @@ public:
     void OnClick(std::function<void()> callback);
     // 设置双击回调函数
     void OnDoubleClick(std::function<void()> callback);
+    // 把按下/松开事件投递到 InputEventBus，由总线识别手势
+    void PostEvents(uint8_t source);
 private:
     // GPIO引脚号
     gpio_num_t gpio_num_;
     // 按钮句柄
     button_handle_t button_handle_ = nullptr;
+    // InputEventBus 中的按键编号
+    uint8_t event_source_ = 0;
 
 
     // 按下回调函数
@@ -4,22 +4,42 @@
 #include "assets/lang_config.h"
 #include "settings.h"
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <ssid_manager.h>
 
 static const char *TAG = "DualNetworkBoard";
 
-DualNetworkBoard::DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_pin, size_t ml307_rx_buffer_size, int32_t default_net_type) 
-    : Board(), 
-      ml307_tx_pin_(ml307_tx_pin), 
-      ml307_rx_pin_(ml307_rx_pin), 
+#define LINK_MONITOR_INTERVAL_MS 2000
+#define STANDBY_RETRY_INTERVAL_MS 60000
+
+static const char* NetworkTypeName(NetworkType type) {
+    return type == NetworkType::ML307 ? "ml307" : "wifi";
+}
+
+static NetworkType OtherNetworkType(NetworkType type) {
+    return type == NetworkType::ML307 ? NetworkType::WIFI : NetworkType::ML307;
+}
+
+DualNetworkBoard::DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_pin, size_t ml307_rx_buffer_size, int32_t default_net_type)
+    : Board(),
+      ml307_tx_pin_(ml307_tx_pin),
+      ml307_rx_pin_(ml307_rx_pin),
       ml307_rx_buffer_size_(ml307_rx_buffer_size) {
-    
-    // 从Settings加载网络类型
+
+    // 从Settings加载首选网络类型，启动时使用首选网络
     network_type_ = LoadNetworkTypeFromSettings(default_net_type);
-    
-    // 只初始化当前网络类型对应的板卡
+    preferred_type_ = network_type_;
+
+    // 只初始化当前网络类型对应的板卡，备用链路在网络启动后再创建
     InitializeCurrentBoard();
 }
 
+DualNetworkBoard::~DualNetworkBoard() {
+    if (link_monitor_task_ != nullptr) {
+        vTaskDelete(link_monitor_task_);
+    }
+}
+
 NetworkType DualNetworkBoard::LoadNetworkTypeFromSettings(int32_t default_net_type) {
     Settings settings("network", true);
     int network_type = settings.GetInt("type", default_net_type); // 默认使用ML307 (1)
@@ -33,71 +53,165 @@ void DualNetworkBoard::SaveNetworkTypeToSettings(NetworkType type) {
 }
 
 void DualNetworkBoard::InitializeCurrentBoard() {
-    if (network_type_ == NetworkType::ML307) {
-        ESP_LOGI(TAG, "Initialize ML307 board");
-        current_board_ = std::make_unique<Ml307Board>(ml307_tx_pin_, ml307_rx_pin_, ml307_rx_buffer_size_);
-    } else {
+    current_board_ = GetBoard(network_type_);
+}
+
+Board* DualNetworkBoard::GetBoard(NetworkType type) {
+    std::lock_guard<std::mutex> lock(board_mutex_);
+    if (type == NetworkType::ML307) {
+        if (!ml307_board_) {
+            ESP_LOGI(TAG, "Initialize ML307 board");
+            ml307_board_ = std::make_unique<Ml307Board>(ml307_tx_pin_, ml307_rx_pin_, ml307_rx_buffer_size_);
+        }
+        return ml307_board_.get();
+    }
+    if (!wifi_board_) {
         ESP_LOGI(TAG, "Initialize WiFi board");
-        current_board_ = std::make_unique<WifiBoard>();
+        wifi_board_ = std::make_unique<WifiBoard>();
     }
+    return wifi_board_.get();
+}
+
+int DualNetworkBoard::GetLinkQuality(NetworkType type) {
+    if (type == NetworkType::ML307) {
+        return ml307_board_ ? ml307_board_->GetLinkQuality() : 0;
+    }
+    return wifi_board_ ? wifi_board_->GetLinkQuality() : 0;
+}
+
+bool DualNetworkBoard::StartStandby(NetworkType type) {
+    GetBoard(type);
+    ESP_LOGI(TAG, "Warming up standby link %s", NetworkTypeName(type));
+    if (type == NetworkType::ML307) {
+        return ml307_board_->StartStandby();
+    }
+    return wifi_board_->StartStandby();
 }
 
 void DualNetworkBoard::SwitchNetworkType() {
     auto display = GetDisplay();
-    if (network_type_ == NetworkType::WIFI) {    
-        SaveNetworkTypeToSettings(NetworkType::ML307);
+    NetworkType target = OtherNetworkType(network_type_);
+    SaveNetworkTypeToSettings(target);
+    preferred_type_ = target;
+
+    if (target == NetworkType::WIFI && SsidManager::GetInstance().GetSsidList().empty()) {
+        // 没有配置过 WiFi，仍然重启进入配网模式
+        display->ShowNotification(Lang::Strings::SWITCH_TO_WIFI_NETWORK);
+        vTaskDelay(pdMS_TO_TICKS(1000));
+        auto& app = Application::GetInstance();
+        app.Reboot();
+        return;
+    }
+
+    if (target == NetworkType::ML307) {
         display->ShowNotification(Lang::Strings::SWITCH_TO_4G_NETWORK);
     } else {
-        SaveNetworkTypeToSettings(NetworkType::WIFI);
         display->ShowNotification(Lang::Strings::SWITCH_TO_WIFI_NETWORK);
     }
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    auto& app = Application::GetInstance();
-    app.Reboot();
+    // 备用链路就绪后由链路监控任务发起迁移
+    switch_requested_ = true;
 }
 
- 
+void DualNetworkBoard::RequestMigration(NetworkType target) {
+    migration_pending_ = true;
+    ESP_LOGI(TAG, "Request migration to %s, quality active %d standby %d", NetworkTypeName(target),
+        transport_manager_.active_quality(), transport_manager_.standby_quality());
+    Application::GetInstance().RequestNetworkMigration([this, target]() {
+        network_type_ = target;
+        current_board_ = GetBoard(target);
+        {
+            std::lock_guard<std::mutex> lock(board_mutex_);
+            transport_manager_.OnMigrated(esp_timer_get_time() / 1000);
+        }
+        migration_pending_ = false;
+        ESP_LOGI(TAG, "Migrated to %s", NetworkTypeName(target));
+    });
+}
+
+void DualNetworkBoard::LinkMonitorTask() {
+    int64_t next_standby_attempt = 0;
+    bool standby_ready = false;
+    while (true) {
+        NetworkType active = network_type_;
+        NetworkType standby = OtherNetworkType(active);
+        int64_t now = esp_timer_get_time() / 1000;
+
+        // 备用链路只需启动一次，迁移后原来的主链路自然成为已就绪的备用链路
+        if (!standby_ready && now >= next_standby_attempt) {
+            standby_ready = StartStandby(standby);
+            next_standby_attempt = now + STANDBY_RETRY_INTERVAL_MS;
+        }
+
+        int active_quality = GetLinkQuality(active);
+        int standby_quality = standby_ready ? GetLinkQuality(standby) : 0;
+        bool migrate = false;
+        {
+            std::lock_guard<std::mutex> lock(board_mutex_);
+            auto decision = transport_manager_.Sample(active_quality, standby_quality,
+                active == preferred_type_, now);
+            migrate = decision == TransportManager::kDecisionMigrate;
+        }
+        if (switch_requested_ && standby_quality > 0) {
+            switch_requested_ = false;
+            migrate = true;
+        }
+        if (migrate && !migration_pending_) {
+            RequestMigration(standby);
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(LINK_MONITOR_INTERVAL_MS));
+    }
+}
+
+
 std::string DualNetworkBoard::GetBoardType() {
-    return current_board_->GetBoardType();
+    return current_board_.load()->GetBoardType();
 }
 
 void DualNetworkBoard::StartNetwork() {
     auto display = Board::GetInstance().GetDisplay();
-    
+
     if (network_type_ == NetworkType::WIFI) {
         display->SetStatus(Lang::Strings::CONNECTING);
     } else {
         display->SetStatus(Lang::Strings::DETECTING_MODULE);
     }
-    current_board_->StartNetwork();
+    current_board_.load()->StartNetwork();
+
+    // 主链路就绪后再启动备用链路和链路质量监控
+    xTaskCreate([](void* arg) {
+        auto self = static_cast<DualNetworkBoard*>(arg);
+        self->LinkMonitorTask();
+        vTaskDelete(NULL);
+    }, "link_monitor", 4096, this, 2, &link_monitor_task_);
 }
 
 Http* DualNetworkBoard::CreateHttp() {
-    return current_board_->CreateHttp();
+    return current_board_.load()->CreateHttp();
 }
 
 WebSocket* DualNetworkBoard::CreateWebSocket() {
-    return current_board_->CreateWebSocket();
+    return current_board_.load()->CreateWebSocket();
 }
 
 Mqtt* DualNetworkBoard::CreateMqtt() {
-    return current_board_->CreateMqtt();
+    return current_board_.load()->CreateMqtt();
 }
 
 Udp* DualNetworkBoard::CreateUdp() {
-    return current_board_->CreateUdp();
+    return current_board_.load()->CreateUdp();
 }
 
 const char* DualNetworkBoard::GetNetworkStateIcon() {
-    return current_board_->GetNetworkStateIcon();
+    return current_board_.load()->GetNetworkStateIcon();
 }
 
 void DualNetworkBoard::SetPowerSaveMode(bool enabled) {
-    current_board_->SetPowerSaveMode(enabled);
+    current_board_.load()->SetPowerSaveMode(enabled);
 }
 
-std::string DualNetworkBoard::GetBoardJson() {   
-    return current_board_->GetBoardJson();
+std::string DualNetworkBoard::GetBoardJson() {
+    return current_board_.load()->GetBoardJson();
 }
 
 // std::string DualNetworkBoard::GetDeviceStatusJson() {
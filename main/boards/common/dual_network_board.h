@@ -4,7 +4,13 @@
 #include "board.h"
 #include "wifi_board.h"
 #include "ml307_board.h"
+#include "transport_manager.h"
 #include <memory>
+#include <atomic>
+#include <mutex>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
 //enum NetworkType
 enum class NetworkType {
@@ -12,40 +18,55 @@ enum class NetworkType {
     ML307
 };
 
-// 双网络板卡类，可以在WiFi和ML307之间切换
+// 双网络板卡类，WiFi 和 ML307 同时保持可用，链路质量变差时在两次对话之间无重启迁移
 class DualNetworkBoard : public Board {
 private:
-    // 使用基类指针存储当前活动的板卡
-    std::unique_ptr<Board> current_board_;
-    NetworkType network_type_ = NetworkType::ML307;  // Default to ML307
+    // 两条链路的板卡，备用链路在首次需要时创建并在后台保持连接
+    std::unique_ptr<WifiBoard> wifi_board_;
+    std::unique_ptr<Ml307Board> ml307_board_;
+    std::atomic<Board*> current_board_ = nullptr;
+    std::atomic<NetworkType> network_type_ = NetworkType::ML307;  // Default to ML307
+    NetworkType preferred_type_ = NetworkType::ML307;
+    std::mutex board_mutex_;
+    std::atomic<bool> migration_pending_ = false;
+    std::atomic<bool> switch_requested_ = false;
 
     // ML307的引脚配置
     gpio_num_t ml307_tx_pin_;
     gpio_num_t ml307_rx_pin_;
     size_t ml307_rx_buffer_size_;
-    
+
+    TransportManager transport_manager_;
+    TaskHandle_t link_monitor_task_ = nullptr;
+
     // 从Settings加载网络类型
     NetworkType LoadNetworkTypeFromSettings(int32_t default_net_type);
-    
+
     // 保存网络类型到Settings
     void SaveNetworkTypeToSettings(NetworkType type);
 
     // 初始化当前网络类型对应的板卡
     void InitializeCurrentBoard();
- 
+
+    Board* GetBoard(NetworkType type);
+    int GetLinkQuality(NetworkType type);
+    bool StartStandby(NetworkType type);
+    void LinkMonitorTask();
+    void RequestMigration(NetworkType target);
+
 public:
     DualNetworkBoard(gpio_num_t ml307_tx_pin, gpio_num_t ml307_rx_pin, size_t ml307_rx_buffer_size = 4096, int32_t default_net_type = 1);
-    virtual ~DualNetworkBoard() = default;
- 
-    // 切换网络类型
+    virtual ~DualNetworkBoard();
+
+    // 切换首选网络类型，不重启，在对话间隙迁移
     void SwitchNetworkType();
-    
+
     // 获取当前网络类型
     NetworkType GetNetworkType() const { return network_type_; }
-    
+
     // 获取当前活动的板卡引用
-    Board& GetCurrentBoard() const { return *current_board_; }
-    
+    Board& GetCurrentBoard() const { return *current_board_.load(); }
+
     // 重写Board接口
     virtual std::string GetBoardType() override;
     virtual void StartNetwork() override;
@@ -59,4 +80,4 @@ public:
     //virtual std::string GetBoardJson() override;;
 };
 
-#endif // DUAL_NETWORK_BOARD_H 
\ No newline at end of file
+#endif // DUAL_NETWORK_BOARD_H
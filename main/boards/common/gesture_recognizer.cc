@@ -0,0 +1,157 @@
+#include "gesture_recognizer.h"
+
+GestureRecognizer::ButtonState& GestureRecognizer::GetButton(uint8_t source) {
+    for (auto& button : buttons_) {
+        if (button.source == source) {
+            return button;
+        }
+    }
+    buttons_.emplace_back();
+    buttons_.back().source = source;
+    return buttons_.back();
+}
+
+void GestureRecognizer::SetMultiClick(uint8_t source, bool enable) {
+    GetButton(source).multi_click = enable;
+}
+
+void GestureRecognizer::FlushClicks(ButtonState& button, int64_t timestamp_us, const Emit& emit) {
+    if (button.clicks > 0) {
+        InputGesture gesture;
+        gesture.type = button.clicks == 1 ? kGestureClick :
+            button.clicks == 2 ? kGestureDoubleClick : kGestureMultiClick;
+        gesture.source = button.source;
+        gesture.count = button.clicks;
+        gesture.timestamp_us = timestamp_us;
+        emit(gesture);
+    }
+    button.clicks = 0;
+    button.click_deadline_us = -1;
+}
+
+void GestureRecognizer::OnPressDown(ButtonState& button, int64_t timestamp_us, const Emit& emit) {
+    // 松开后很快又按下是抖动，连同随后的松开一起忽略
+    if (button.pressed || (button.last_edge_us >= 0 && timestamp_us - button.last_edge_us < config_.debounce_us)) {
+        return;
+    }
+    button.pressed = true;
+    button.press_time_us = timestamp_us;
+    button.last_edge_us = timestamp_us;
+    button.long_fired = false;
+    button.consumed = false;
+    // 按住期间暂停多击窗口，松开后重新计时
+    button.click_deadline_us = -1;
+
+    for (auto& other : buttons_) {
+        if (&other == &button || !other.pressed || other.consumed || other.long_fired ||
+            timestamp_us - other.press_time_us > config_.chord_us) {
+            continue;
+        }
+        FlushClicks(other, other.press_time_us, emit);
+        FlushClicks(button, timestamp_us, emit);
+        InputGesture gesture;
+        gesture.type = kGestureChord;
+        gesture.source = other.source;
+        gesture.other = button.source;
+        gesture.timestamp_us = timestamp_us;
+        emit(gesture);
+        other.consumed = true;
+        button.consumed = true;
+        break;
+    }
+}
+
+void GestureRecognizer::OnPressUp(ButtonState& button, int64_t timestamp_us, const Emit& emit) {
+    if (!button.pressed) {
+        return;
+    }
+    button.pressed = false;
+    bool glitch = timestamp_us - button.last_edge_us < config_.debounce_us;
+    button.last_edge_us = timestamp_us;
+    if (glitch) {
+        // 按下时间短于去抖时间，当作干扰丢弃；之前的多击继续计时
+        if (button.clicks > 0 && button.multi_click) {
+            button.click_deadline_us = timestamp_us + config_.multi_click_us;
+        }
+        return;
+    }
+    if (button.consumed || button.long_fired) {
+        button.clicks = 0;
+        return;
+    }
+    button.clicks++;
+    if (button.multi_click) {
+        button.click_deadline_us = timestamp_us + config_.multi_click_us;
+    } else {
+        FlushClicks(button, timestamp_us, emit);
+    }
+}
+
+void GestureRecognizer::Feed(const InputEvent& event, const Emit& emit) {
+    // 先补发在这个事件之前就已经成立的手势，保证输出按时间排序
+    Poll(event.timestamp_us, emit);
+
+    if (event.type == kInputRotate) {
+        for (auto& button : buttons_) {
+            if (button.pressed) {
+                InputGesture gesture;
+                gesture.type = kGestureHoldRotate;
+                gesture.source = button.source;
+                gesture.other = event.source;
+                gesture.direction = event.direction;
+                gesture.timestamp_us = event.timestamp_us;
+                emit(gesture);
+                button.consumed = true;
+                return;
+            }
+        }
+        InputGesture gesture;
+        gesture.type = kGestureRotate;
+        gesture.source = event.source;
+        gesture.direction = event.direction;
+        gesture.timestamp_us = event.timestamp_us;
+        emit(gesture);
+        return;
+    }
+
+    auto& button = GetButton(event.source);
+    if (event.type == kInputPressDown) {
+        OnPressDown(button, event.timestamp_us, emit);
+    } else {
+        OnPressUp(button, event.timestamp_us, emit);
+    }
+}
+
+void GestureRecognizer::Poll(int64_t now_us, const Emit& emit) {
+    for (auto& button : buttons_) {
+        if (button.pressed && !button.long_fired && !button.consumed &&
+            now_us >= button.press_time_us + config_.long_press_us) {
+            // 多击之后接长按：先发出之前的点击
+            FlushClicks(button, button.press_time_us, emit);
+            InputGesture gesture;
+            gesture.type = kGestureLongPress;
+            gesture.source = button.source;
+            gesture.timestamp_us = button.press_time_us + config_.long_press_us;
+            emit(gesture);
+            button.long_fired = true;
+        } else if (!button.pressed && button.click_deadline_us >= 0 && now_us >= button.click_deadline_us) {
+            FlushClicks(button, button.click_deadline_us, emit);
+        }
+    }
+}
+
+int64_t GestureRecognizer::NextDeadline() const {
+    int64_t deadline = -1;
+    for (const auto& button : buttons_) {
+        int64_t next = -1;
+        if (button.pressed && !button.long_fired && !button.consumed) {
+            next = button.press_time_us + config_.long_press_us;
+        } else if (!button.pressed && button.click_deadline_us >= 0) {
+            next = button.click_deadline_us;
+        }
+        if (next >= 0 && (deadline < 0 || next < deadline)) {
+            deadline = next;
+        }
+    }
+    return deadline;
+}
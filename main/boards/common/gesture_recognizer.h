@@ -0,0 +1,91 @@
+#ifndef GESTURE_RECOGNIZER_H_
+#define GESTURE_RECOGNIZER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+enum InputEventType : uint8_t {
+    kInputPressDown,
+    kInputPressUp,
+    kInputRotate,
+};
+
+// 驱动上报的原始输入事件，时间戳在驱动回调里取（esp_timer 时基）
+struct InputEvent {
+    InputEventType type = kInputPressDown;
+    uint8_t source = 0;         // 按键/旋钮编号，由板卡分配
+    int8_t direction = 0;       // kInputRotate：1 顺时针，-1 逆时针
+    int64_t timestamp_us = 0;
+};
+
+enum GestureType : uint8_t {
+    kGestureClick,
+    kGestureDoubleClick,
+    kGestureMultiClick,         // 三击及以上，次数见 count
+    kGestureLongPress,
+    kGestureHoldRotate,         // 按住按键的同时转动旋钮，source 为按键，other 为旋钮
+    kGestureRotate,
+    kGestureChord,              // 两个按键同时按下，source 先按下，other 后按下
+};
+
+struct InputGesture {
+    GestureType type = kGestureClick;
+    uint8_t source = 0;
+    uint8_t other = 0;
+    int8_t direction = 0;
+    uint8_t count = 1;
+    int64_t timestamp_us = 0;   // 手势成立的时刻，例如单击为多击窗口结束时
+};
+
+struct GestureConfig {
+    int64_t debounce_us = 20 * 1000;
+    int64_t multi_click_us = 300 * 1000;
+    int64_t long_press_us = 1000 * 1000;
+    int64_t chord_us = 150 * 1000;      // 两个按键按下的间隔不超过该值才算组合键
+};
+
+/**
+ * @brief GestureRecognizer 把原始按下/松开/旋转事件识别为手势，不依赖 ESP-IDF。
+ *
+ * 只在一个线程里使用（InputEventBus 的 input_events 任务），事件必须按时间顺序输入。
+ * 需要等待的手势（多击窗口、长按）由 Poll() 在 NextDeadline() 之后补发，
+ * 手势的时间戳是逻辑上成立的时刻，与 Poll() 的调用时机无关，方便在主机上回放时逐条比较。
+ * 没有启用多击的按键松开时立即发出单击，不增加延迟。
+ * scripts/input_replay 在主机上回放输入时间线并检查识别结果。
+ */
+class GestureRecognizer {
+public:
+    using Emit = std::function<void(const InputGesture&)>;
+
+    explicit GestureRecognizer(const GestureConfig& config = GestureConfig()) : config_(config) {}
+
+    void SetMultiClick(uint8_t source, bool enable);
+    void Feed(const InputEvent& event, const Emit& emit);
+    void Poll(int64_t now_us, const Emit& emit);
+    // 下一个需要 Poll() 的时刻，没有待定手势时返回 -1
+    int64_t NextDeadline() const;
+
+private:
+    struct ButtonState {
+        uint8_t source = 0;
+        bool pressed = false;
+        bool multi_click = false;
+        bool long_fired = false;
+        bool consumed = false;      // 已经参与了组合键或按住旋转，松开时不再产生单击
+        int64_t press_time_us = 0;
+        int64_t last_edge_us = -1;
+        int64_t click_deadline_us = -1;
+        uint8_t clicks = 0;
+    };
+
+    GestureConfig config_;
+    std::vector<ButtonState> buttons_;
+
+    ButtonState& GetButton(uint8_t source);
+    void FlushClicks(ButtonState& button, int64_t timestamp_us, const Emit& emit);
+    void OnPressDown(ButtonState& button, int64_t timestamp_us, const Emit& emit);
+    void OnPressUp(ButtonState& button, int64_t timestamp_us, const Emit& emit);
+};
+
+#endif // GESTURE_RECOGNIZER_H_
@@ -0,0 +1,75 @@
+#include "input_event_bus.h"
+#include "power_state_manager.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+
+static const char* TAG = "InputEventBus";
+
+InputEventBus::InputEventBus() {
+    event_queue_ = xQueueCreate(kQueueLength, sizeof(InputEvent));
+    xTaskCreate([](void* arg) {
+        static_cast<InputEventBus*>(arg)->EventLoop();
+    }, "input_events", 4096, this, 5, &task_);
+}
+
+InputEventBus::~InputEventBus() {
+    if (task_ != nullptr) {
+        vTaskDelete(task_);
+    }
+    if (event_queue_ != nullptr) {
+        vQueueDelete(event_queue_);
+    }
+}
+
+void InputEventBus::Post(InputEventType type, uint8_t source, int8_t direction, int64_t timestamp_us) {
+    InputEvent event;
+    event.type = type;
+    event.source = source;
+    event.direction = direction;
+    event.timestamp_us = timestamp_us != 0 ? timestamp_us : esp_timer_get_time();
+    if (xQueueSend(event_queue_, &event, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Input queue full, dropping event %d from source %d", type, source);
+    }
+}
+
+void InputEventBus::OnGesture(GestureType type, uint8_t source, std::function<void(const InputGesture&)> callback) {
+    if (type == kGestureDoubleClick || type == kGestureMultiClick) {
+        recognizer_.SetMultiClick(source, true);
+    }
+    handlers_.push_back({type, source, std::move(callback)});
+}
+
+void InputEventBus::Dispatch(const InputGesture& gesture) {
+    bool handled = false;
+    for (auto& handler : handlers_) {
+        if (handler.type == gesture.type && handler.source == gesture.source) {
+            handler.callback(gesture);
+            handled = true;
+        }
+    }
+    ESP_LOGD(TAG, "Gesture %d source %d other %d direction %d count %d latency %lld us%s", gesture.type,
+        gesture.source, gesture.other, gesture.direction, gesture.count,
+        esp_timer_get_time() - gesture.timestamp_us, handled ? "" : " (unhandled)");
+}
+
+void InputEventBus::EventLoop() {
+    auto dispatch = [this](const InputGesture& gesture) {
+        Dispatch(gesture);
+    };
+    while (true) {
+        // 有待定手势（多击窗口、长按）时最多等到它的截止时间
+        TickType_t timeout = portMAX_DELAY;
+        int64_t deadline = recognizer_.NextDeadline();
+        if (deadline >= 0) {
+            int64_t delay_us = deadline - esp_timer_get_time();
+            timeout = delay_us > 0 ? pdMS_TO_TICKS((delay_us + 999) / 1000) + 1 : 0;
+        }
+        InputEvent event;
+        if (xQueueReceive(event_queue_, &event, timeout) == pdTRUE) {
+            PowerStateManager::GetInstance().WakeUp();
+            recognizer_.Feed(event, dispatch);
+        }
+        recognizer_.Poll(esp_timer_get_time(), dispatch);
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef INPUT_EVENT_BUS_H_
+#define INPUT_EVENT_BUS_H_
+
+#include "gesture_recognizer.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief InputEventBus 按键、旋钮等输入设备的统一事件总线。
+ *
+ * 驱动回调里只调用 Post()：记下时间戳后放进定长队列，由总线自己的 input_events 任务做手势识别、
+ * 串行调用所有处理函数。不经过主循环：启动阶段（联网、检查新版本、配网）主循环还没运行，
+ * 按键也要能打断激活/OTA 重试和配网等待。队列满时丢弃新事件。
+ * 注册了双击/多击处理的按键才会等待多击窗口，其余按键松开即发出单击。
+ */
+class InputEventBus {
+public:
+    static InputEventBus& GetInstance() {
+        static InputEventBus instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    InputEventBus(const InputEventBus&) = delete;
+    InputEventBus& operator=(const InputEventBus&) = delete;
+
+    // 可以在任意任务里调用；timestamp_us 为 0 时取当前时间
+    void Post(InputEventType type, uint8_t source, int8_t direction = 0, int64_t timestamp_us = 0);
+
+    // 在板卡初始化时注册，source 对 kGestureChord 为先按下的按键，对 kGestureRotate 为旋钮
+    void OnGesture(GestureType type, uint8_t source, std::function<void(const InputGesture&)> callback);
+
+private:
+    InputEventBus();
+    ~InputEventBus();
+
+    struct Handler {
+        GestureType type;
+        uint8_t source;
+        std::function<void(const InputGesture&)> callback;
+    };
+
+    static constexpr int kQueueLength = 16;
+
+    GestureRecognizer recognizer_;
+    std::vector<Handler> handlers_;
+    QueueHandle_t event_queue_ = nullptr;
+    TaskHandle_t task_ = nullptr;
+
+    void Dispatch(const InputGesture& gesture);
+    void EventLoop();
+};
+
+#endif // INPUT_EVENT_BUS_H_
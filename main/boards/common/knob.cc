@@ -1,4 +1,7 @@
 #include "knob.h"
+#include "input_event_bus.h"
+
+#include <esp_timer.h>
 
 static const char* TAG = "Knob";
 
@@ -42,10 +45,19 @@ void Knob::OnRotate(std::function<void(bool)> callback) {
     on_rotate_ = callback;
 }
 
+void Knob::PostEvents(uint8_t source) {
+    event_source_ = source;
+    post_events_ = true;
+}
+
 void Knob::knob_callback(void* arg, void* data) {
     Knob* knob = static_cast<Knob*>(data);
     knob_event_t event = iot_knob_get_event(arg);
     
+    if (knob->post_events_) {
+        InputEventBus::GetInstance().Post(kInputRotate, knob->event_source_, event == KNOB_RIGHT ? 1 : -1,
+            esp_timer_get_time());
+    }
     if (knob->on_rotate_) {
         knob->on_rotate_(event == KNOB_RIGHT);
     }
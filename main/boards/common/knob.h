@@ -12,6 +12,8 @@ public:
     ~Knob();
 
     void OnRotate(std::function<void(bool)> callback);
+    // 把旋转事件投递到 InputEventBus，可以与按键组合成按住旋转手势
+    void PostEvents(uint8_t source);
 
 private:
     static void knob_callback(void* arg, void* data);
@@ -20,6 +22,8 @@ private:
     gpio_num_t pin_a_;
     gpio_num_t pin_b_;
     std::function<void(bool)> on_rotate_;
+    bool post_events_ = false;
+    uint8_t event_source_ = 0;
 };
 
 #endif // KNOB_H_
\ No newline at end of file
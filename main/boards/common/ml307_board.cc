@@ -67,6 +67,29 @@ void Ml307Board::WaitForNetworkReady() {
     modem_.ResetConnections();
 }
 
+bool Ml307Board::StartStandby() {
+    modem_.SetDebug(false);
+    modem_.SetBaudRate(115200);
+    int result = modem_.WaitForNetworkReady();
+    if (result < 0) {
+        ESP_LOGW(TAG, "Standby modem not ready: %d", result);
+        return false;
+    }
+    modem_.ResetConnections();
+    return true;
+}
+
+int Ml307Board::GetLinkQuality() {
+    if (!modem_.network_ready()) {
+        return 0;
+    }
+    int csq = modem_.GetCsq();
+    if (csq < 0 || csq > 31) {
+        return 0;
+    }
+    return csq * 100 / 31;
+}
+
 Http* Ml307Board::CreateHttp() {
     return new Ml307Http(modem_);
 }
@@ -33,6 +33,10 @@ public:
     virtual const char* GetNetworkStateIcon() override;
     // 设置省电模式
     virtual void SetPowerSaveMode(bool enabled) override;
+    // 作为备用链路启动：等待注册网络，失败时不弹出告警
+    bool StartStandby();
+    // 链路质量 0-100，由 CSQ 换算，未注册为 0
+    int GetLinkQuality();
 
      virtual AudioCodec* GetAudioCodec() override { return nullptr; }///////
 };
@@ -0,0 +1,281 @@
+#include "power_state_manager.h"
+#include "application.h"
+#include "cpu_sampler.h"
+
+#include <esp_log.h>
+#include <algorithm>
+
+#define TAG "PowerStateManager"
+
+constexpr int PowerStateManager::kFreqSteps[];
+
+static const char* const PM_LOCK_NAMES[kPmSubsystemCount] = {
+    "pm_audio",
+    "pm_radio",
+    "pm_display",
+};
+
+static const esp_pm_lock_type_t PM_LOCK_TYPES[kPmSubsystemCount] = {
+    ESP_PM_CPU_FREQ_MAX,
+    ESP_PM_NO_LIGHT_SLEEP,
+    ESP_PM_APB_FREQ_MAX,
+};
+
+PowerStateManager::PowerStateManager() {
+    for (int i = 0; i < kPmSubsystemCount; i++) {
+        auto ret = esp_pm_lock_create(PM_LOCK_TYPES[i], 0, PM_LOCK_NAMES[i], &locks_[i]);
+        if (ret == ESP_ERR_NOT_SUPPORTED) {
+            ESP_LOGI(TAG, "Power management not supported");
+            break;
+        }
+        ESP_ERROR_CHECK(ret);
+    }
+
+    esp_timer_create_args_t sleep_timer_args = {
+        .callback = [](void* arg) {
+            auto self = static_cast<PowerStateManager*>(arg);
+            self->OnSleepTimer();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "pm_sleep_timer",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&sleep_timer_args, &sleep_timer_));
+
+    esp_timer_create_args_t shutdown_timer_args = {
+        .callback = [](void* arg) {
+            auto self = static_cast<PowerStateManager*>(arg);
+            if (self->on_shutdown_request_) {
+                self->on_shutdown_request_();
+            }
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "pm_shutdown_timer",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&shutdown_timer_args, &shutdown_timer_));
+
+    last_change_time_ = esp_timer_get_time();
+    enter_time_ = last_change_time_;
+}
+
+PowerStateManager::~PowerStateManager() {
+    esp_timer_stop(sleep_timer_);
+    esp_timer_delete(sleep_timer_);
+    esp_timer_stop(shutdown_timer_);
+    esp_timer_delete(shutdown_timer_);
+    for (auto lock : locks_) {
+        if (lock != nullptr) {
+            esp_pm_lock_delete(lock);
+        }
+    }
+}
+
+void PowerStateManager::Initialize(int cpu_max_freq, int seconds_to_sleep, int seconds_to_shutdown) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cpu_max_freq_ = cpu_max_freq;
+    seconds_to_sleep_ = seconds_to_sleep;
+    seconds_to_shutdown_ = seconds_to_shutdown;
+    // 初始全部使用最高频率，之后根据实测负载逐步下调
+    for (auto& freq : state_freq_) {
+        freq = cpu_max_freq_;
+    }
+    enabled_ = true;
+    ApplyConfig();
+    ESP_LOGI(TAG, "Power state manager enabled, max %d MHz", cpu_max_freq_);
+}
+
+int PowerStateManager::FreqIndex(int freq) const {
+    for (int i = 0; i < kFreqStepCount; i++) {
+        if (freq <= kFreqSteps[i]) {
+            return i;
+        }
+    }
+    return kFreqStepCount - 1;
+}
+
+void PowerStateManager::AccountResidency() {
+    int64_t now = esp_timer_get_time();
+    int64_t elapsed = now - last_change_time_;
+    last_change_time_ = now;
+    if (in_sleep_mode_) {
+        sleep_us_ += elapsed;
+    }
+    if (state_ >= 0 && state_ < kMaxStates) {
+        int freq = current_freq_ != 0 ? current_freq_ : CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+        residency_us_[state_][FreqIndex(freq)] += elapsed;
+    }
+}
+
+void PowerStateManager::ApplyConfig() {
+    if (!enabled_ || locks_[0] == nullptr) {
+        return;
+    }
+    int freq = (state_ >= 0 && state_ < kMaxStates) ? state_freq_[state_] : cpu_max_freq_;
+    // 退出休眠时 in_sleep_mode_ 已经清掉，要和实际生效的配置比较，否则频率不变时 light sleep 不会关闭
+    if (freq == current_freq_ && in_sleep_mode_ == applied_light_sleep_) {
+        return;
+    }
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = freq,
+        .min_freq_mhz = in_sleep_mode_ ? 40 : kFreqSteps[0],
+        .light_sleep_enable = in_sleep_mode_,
+    };
+    auto ret = esp_pm_configure(&pm_config);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "esp_pm_configure failed: %s", esp_err_to_name(ret));
+        return;
+    }
+    current_freq_ = freq;
+    applied_light_sleep_ = in_sleep_mode_;
+}
+
+void PowerStateManager::OnDeviceStateChanged(int state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AccountResidency();
+
+    // 用本次停留期间的实测负载选择该状态下次使用的频率
+    uint64_t busy = 0, total = 0;
+    CpuSampler::GetInstance().GetStateTotals(state_, &busy, &total);
+    int64_t now = esp_timer_get_time();
+    if (enabled_ && state_ >= 0 && state_ < kMaxStates && total > enter_total_ &&
+        now - enter_time_ >= kMinVisitSeconds * 1000000LL) {
+        int load = (int)((busy - enter_busy_) * 100 / (total - enter_total_));
+        int required = state_freq_[state_] * load / kTargetLoad;
+        // 对话相关状态有实时音频编解码，最低不低于 160MHz
+        int floor = (state_ == kDeviceStateListening || state_ == kDeviceStateSpeaking ||
+                     state_ == kDeviceStateConnecting) ? 160 : kFreqSteps[0];
+        int freq = kFreqSteps[FreqIndex(std::max(required, floor))];
+        freq = std::min(freq, cpu_max_freq_);
+        if (freq != state_freq_[state_]) {
+            ESP_LOGI(TAG, "State %s load %d%% at %d MHz, next time use %d MHz",
+                Application::GetDeviceStateName((DeviceState)state_), load, state_freq_[state_], freq);
+            state_freq_[state_] = freq;
+        }
+    }
+
+    state_ = state;
+    enter_time_ = now;
+    CpuSampler::GetInstance().GetStateTotals(state_, &enter_busy_, &enter_total_);
+
+    if (in_sleep_mode_ && state != kDeviceStateIdle) {
+        in_sleep_mode_ = false;
+        esp_timer_stop(shutdown_timer_);
+        ApplyConfig();
+        if (on_exit_sleep_mode_) {
+            on_exit_sleep_mode_();
+        }
+    } else {
+        ApplyConfig();
+    }
+
+    esp_timer_stop(sleep_timer_);
+    if (enabled_ && state == kDeviceStateIdle && seconds_to_sleep_ != -1 && !in_sleep_mode_) {
+        esp_timer_start_once(sleep_timer_, seconds_to_sleep_ * 1000000LL);
+    }
+}
+
+void PowerStateManager::OnSleepTimer() {
+    auto& app = Application::GetInstance();
+    if (!app.CanEnterSleepMode()) {
+        // 空闲但音频通道仍打开，稍后再检查一次
+        esp_timer_start_once(sleep_timer_, seconds_to_sleep_ * 1000000LL);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (in_sleep_mode_) {
+            return;
+        }
+        AccountResidency();
+        in_sleep_mode_ = true;
+        ApplyConfig();
+    }
+    ESP_LOGI(TAG, "Enter sleep mode");
+    if (on_enter_sleep_mode_) {
+        on_enter_sleep_mode_();
+    }
+    if (seconds_to_shutdown_ != -1 && seconds_to_shutdown_ > seconds_to_sleep_) {
+        esp_timer_start_once(shutdown_timer_, (seconds_to_shutdown_ - seconds_to_sleep_) * 1000000LL);
+    }
+}
+
+void PowerStateManager::WakeUp() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        esp_timer_stop(shutdown_timer_);
+        if (enabled_ && state_ == kDeviceStateIdle && seconds_to_sleep_ != -1) {
+            esp_timer_stop(sleep_timer_);
+            esp_timer_start_once(sleep_timer_, seconds_to_sleep_ * 1000000LL);
+        }
+        if (!in_sleep_mode_) {
+            return;
+        }
+        AccountResidency();
+        in_sleep_mode_ = false;
+        ApplyConfig();
+    }
+    ESP_LOGI(TAG, "Exit sleep mode");
+    if (on_exit_sleep_mode_) {
+        on_exit_sleep_mode_();
+    }
+}
+
+void PowerStateManager::Acquire(PmSubsystem subsystem) {
+    if (locks_[subsystem] != nullptr) {
+        esp_pm_lock_acquire(locks_[subsystem]);
+    }
+}
+
+void PowerStateManager::Release(PmSubsystem subsystem) {
+    if (locks_[subsystem] != nullptr) {
+        esp_pm_lock_release(locks_[subsystem]);
+    }
+}
+
+void PowerStateManager::OnEnterSleepMode(std::function<void()> callback) {
+    on_enter_sleep_mode_ = callback;
+}
+
+void PowerStateManager::OnExitSleepMode(std::function<void()> callback) {
+    on_exit_sleep_mode_ = callback;
+}
+
+void PowerStateManager::OnShutdownRequest(std::function<void()> callback) {
+    on_shutdown_request_ = callback;
+}
+
+std::string PowerStateManager::GetJson() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    AccountResidency();
+
+    std::string json = "{\"freq_mhz\":[";
+    for (int i = 0; i < kFreqStepCount; i++) {
+        json += std::to_string(kFreqSteps[i]) + ",";
+    }
+    json.pop_back();
+    json += "],\"sleep_ms\":" + std::to_string(sleep_us_ / 1000) + ",\"states\":{";
+    for (int s = 0; s <= kDeviceStateFatalError && s < kMaxStates; s++) {
+        int64_t sum = 0;
+        for (int i = 0; i < kFreqStepCount; i++) {
+            sum += residency_us_[s][i];
+        }
+        if (sum == 0) {
+            continue;
+        }
+        json += "\"" + std::string(Application::GetDeviceStateName((DeviceState)s)) + "\":[";
+        for (int i = 0; i < kFreqStepCount; i++) {
+            json += std::to_string(residency_us_[s][i] / 1000) + ",";
+        }
+        json.pop_back();
+        json += "],";
+    }
+    if (json.back() == ',') {
+        json.pop_back();
+    }
+    json += "}}";
+    return json;
+}
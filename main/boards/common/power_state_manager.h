@@ -0,0 +1,95 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include <esp_timer.h>
+#include <esp_pm.h>
+
+enum PmSubsystem {
+    kPmSubsystemAudio,    // 音频输入/输出启用，CPU 保持在当前状态的最高频率
+    kPmSubsystemRadio,    // 音频通道打开，禁止 light sleep
+    kPmSubsystemDisplay,  // 显示刷新或动画，APB 保持最高频率
+    kPmSubsystemCount
+};
+
+/**
+ * @brief PowerStateManager 由设备状态变化驱动的电源管理，取代按秒轮询的 PowerSaveTimer。
+ *
+ * - 每个子系统一把 PM 锁，由子系统在开始/结束工作时 Acquire/Release。
+ * - 每个设备状态有自己的 CPU 最高频率：离开一个状态时根据 CpuSampler 测得的本次负载，
+ *   选出能让负载低于目标值的最低档位，下次进入该状态时使用。
+ * - 进入空闲状态后启动一次性定时器，到期且 Application::CanEnterSleepMode() 时进入 light sleep。
+ * - 统计每个状态在各频率档位的停留时间，用于估算各状态的平均电流。
+ *
+ * 没有调用 Initialize() 时只统计停留时间，不修改 PM 配置。
+ */
+class PowerStateManager {
+public:
+    static PowerStateManager& GetInstance() {
+        static PowerStateManager instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    PowerStateManager(const PowerStateManager&) = delete;
+    PowerStateManager& operator=(const PowerStateManager&) = delete;
+
+    // seconds_to_sleep/seconds_to_shutdown 为 -1 表示不休眠/不关机
+    void Initialize(int cpu_max_freq, int seconds_to_sleep = 20, int seconds_to_shutdown = -1);
+    void OnDeviceStateChanged(int state);
+    void Acquire(PmSubsystem subsystem);
+    void Release(PmSubsystem subsystem);
+    // 有用户输入时调用：重新开始空闲计时，已经休眠时退出 light sleep
+    void WakeUp();
+
+    void OnEnterSleepMode(std::function<void()> callback);
+    void OnExitSleepMode(std::function<void()> callback);
+    void OnShutdownRequest(std::function<void()> callback);
+
+    // {"freq_mhz":[80,160,240],"sleep_ms":0,"states":{"idle":[ms,ms,ms],...}}
+    std::string GetJson();
+
+private:
+    PowerStateManager();
+    ~PowerStateManager();
+
+    static constexpr int kFreqSteps[] = {80, 160, 240};
+    static constexpr int kFreqStepCount = sizeof(kFreqSteps) / sizeof(kFreqSteps[0]);
+    static constexpr int kMaxStates = 12;
+    static constexpr int kTargetLoad = 60;        // 目标负载百分比
+    static constexpr int kMinVisitSeconds = 5;    // 停留太短不调整频率
+
+    std::mutex mutex_;
+    esp_pm_lock_handle_t locks_[kPmSubsystemCount] = {};
+    esp_timer_handle_t sleep_timer_ = nullptr;
+    esp_timer_handle_t shutdown_timer_ = nullptr;
+
+    bool enabled_ = false;
+    bool in_sleep_mode_ = false;
+    bool applied_light_sleep_ = false;    // 最近一次 esp_pm_configure 是否启用了 light sleep
+    int cpu_max_freq_ = 240;
+    int seconds_to_sleep_ = -1;
+    int seconds_to_shutdown_ = -1;
+    int state_ = 0;
+    int state_freq_[kMaxStates] = {};
+    int current_freq_ = 0;
+
+    // 进入当前状态时的 CpuSampler 累计值
+    uint64_t enter_busy_ = 0;
+    uint64_t enter_total_ = 0;
+    int64_t enter_time_ = 0;
+
+    int64_t last_change_time_ = 0;
+    int64_t sleep_us_ = 0;
+    int64_t residency_us_[kMaxStates][kFreqStepCount] = {};
+
+    std::function<void()> on_enter_sleep_mode_;
+    std::function<void()> on_exit_sleep_mode_;
+    std::function<void()> on_shutdown_request_;
+
+    void AccountResidency();
+    void ApplyConfig();
+    void OnSleepTimer();
+    int FreqIndex(int freq) const;
+};
@@ -0,0 +1,195 @@
+#include "resumable_tls_transport.h"
+#include "tls_session_cache.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_crt_bundle.h>
+
+#define TAG "ResumableTls"
+
+// 恢复的会话沿用原会话的建立时间，完整握手则重新计时
+static bool IsSameSession(const mbedtls_ssl_session* offered, const mbedtls_ssl_session* negotiated) {
+#if defined(MBEDTLS_HAVE_TIME)
+    return offered->MBEDTLS_PRIVATE(start) == negotiated->MBEDTLS_PRIVATE(start);
+#else
+    return false;
+#endif
+}
+
+ResumableTlsTransport::ResumableTlsTransport() {
+    mbedtls_net_init(&net_);
+    mbedtls_ssl_init(&ssl_);
+    mbedtls_ssl_config_init(&conf_);
+    mbedtls_entropy_init(&entropy_);
+    mbedtls_ctr_drbg_init(&ctr_drbg_);
+}
+
+ResumableTlsTransport::~ResumableTlsTransport() {
+    Disconnect();
+    mbedtls_net_free(&net_);
+    mbedtls_ssl_free(&ssl_);
+    mbedtls_ssl_config_free(&conf_);
+    mbedtls_ctr_drbg_free(&ctr_drbg_);
+    mbedtls_entropy_free(&entropy_);
+}
+
+void ResumableTlsTransport::Reset() {
+    mbedtls_net_free(&net_);
+    mbedtls_ssl_free(&ssl_);
+    mbedtls_ssl_config_free(&conf_);
+    mbedtls_net_init(&net_);
+    mbedtls_ssl_init(&ssl_);
+    mbedtls_ssl_config_init(&conf_);
+}
+
+bool ResumableTlsTransport::Connect(const char* host, int port) {
+    Disconnect();
+    host_ = host;
+    port_ = port;
+
+    if (!seeded_) {
+        int ret = mbedtls_ctr_drbg_seed(&ctr_drbg_, mbedtls_entropy_func, &entropy_, nullptr, 0);
+        if (ret != 0) {
+            ESP_LOGE(TAG, "Failed to seed RNG: -0x%x", -ret);
+            return false;
+        }
+        seeded_ = true;
+    }
+
+    bool offered = false;
+    if (Handshake(true, &offered)) {
+        return true;
+    }
+    if (!offered) {
+        return false;
+    }
+    // 服务端可能已经轮换了票据密钥，丢弃缓存后做一次完整握手
+    TlsSessionCache::GetInstance().Forget(host_, port_);
+    return Handshake(false, &offered);
+}
+
+bool ResumableTlsTransport::Handshake(bool offer_cached_session, bool* offered_session) {
+    Reset();
+
+    int ret = mbedtls_ssl_config_defaults(&conf_, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+        MBEDTLS_SSL_PRESET_DEFAULT);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to set config defaults: -0x%x", -ret);
+        return false;
+    }
+    mbedtls_ssl_conf_authmode(&conf_, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_rng(&conf_, mbedtls_ctr_drbg_random, &ctr_drbg_);
+    esp_crt_bundle_attach(&conf_);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    mbedtls_ssl_conf_session_tickets(&conf_, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+
+    if ((ret = mbedtls_ssl_setup(&ssl_, &conf_)) != 0 ||
+        (ret = mbedtls_ssl_set_hostname(&ssl_, host_.c_str())) != 0) {
+        ESP_LOGE(TAG, "Failed to set up SSL: -0x%x", -ret);
+        return false;
+    }
+
+    ret = mbedtls_net_connect(&net_, host_.c_str(), std::to_string(port_).c_str(), MBEDTLS_NET_PROTO_TCP);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d: -0x%x", host_.c_str(), port_, -ret);
+        return false;
+    }
+    mbedtls_ssl_set_bio(&ssl_, &net_, mbedtls_net_send, mbedtls_net_recv, nullptr);
+
+    auto& cache = TlsSessionCache::GetInstance();
+    mbedtls_ssl_session offered;
+    mbedtls_ssl_session_init(&offered);
+    bool offering = offer_cached_session && cache.Load(host_, port_, &offered) &&
+        mbedtls_ssl_set_session(&ssl_, &offered) == 0;
+    *offered_session = offering;
+
+    auto start_time = esp_timer_get_time();
+    while ((ret = mbedtls_ssl_handshake(&ssl_)) != 0) {
+        if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            break;
+        }
+    }
+    auto duration = esp_timer_get_time() - start_time;
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Handshake with %s:%d failed: -0x%x%s", host_.c_str(), port_, -ret,
+            offering ? " (with cached session)" : "");
+        mbedtls_ssl_session_free(&offered);
+        return false;
+    }
+
+    bool resumed = false;
+    mbedtls_ssl_session negotiated;
+    mbedtls_ssl_session_init(&negotiated);
+    if (mbedtls_ssl_get_session(&ssl_, &negotiated) == 0) {
+        resumed = offering && IsSameSession(&offered, &negotiated);
+        cache.Store(host_, port_, &negotiated);
+    }
+    mbedtls_ssl_session_free(&negotiated);
+    mbedtls_ssl_session_free(&offered);
+
+    cache.RecordHandshake(resumed, duration);
+    ESP_LOGI(TAG, "Connected to %s:%d, %s handshake %lld ms", host_.c_str(), port_,
+        resumed ? "resumed" : "full", duration / 1000);
+    connected_ = true;
+    return true;
+}
+
+void ResumableTlsTransport::SaveSession() {
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    if (mbedtls_ssl_get_session(&ssl_, &session) == 0) {
+        TlsSessionCache::GetInstance().Store(host_, port_, &session);
+    }
+    mbedtls_ssl_session_free(&session);
+}
+
+void ResumableTlsTransport::Disconnect() {
+    if (connected_) {
+        mbedtls_ssl_close_notify(&ssl_);
+        connected_ = false;
+    }
+    mbedtls_net_free(&net_);
+}
+
+int ResumableTlsTransport::Send(const char* data, size_t length) {
+    size_t total_sent = 0;
+    while (total_sent < length) {
+        int ret = mbedtls_ssl_write(&ssl_, (const unsigned char*)data + total_sent, length - total_sent);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Send failed: -0x%x", -ret);
+            connected_ = false;
+            return ret;
+        }
+        total_sent += ret;
+    }
+    return total_sent;
+}
+
+int ResumableTlsTransport::Receive(char* buffer, size_t bufferSize) {
+    while (true) {
+        int ret = mbedtls_ssl_read(&ssl_, (unsigned char*)buffer, bufferSize);
+        if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+#if defined(MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET)
+        if (ret == MBEDTLS_ERR_SSL_RECEIVED_NEW_SESSION_TICKET) {
+            // TLS 1.3 的票据在握手之后才下发
+            SaveSession();
+            continue;
+        }
+#endif
+        if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || ret == 0) {
+            connected_ = false;
+            return 0;
+        }
+        if (ret < 0) {
+            ESP_LOGE(TAG, "Receive failed: -0x%x", -ret);
+            connected_ = false;
+        }
+        return ret;
+    }
+}
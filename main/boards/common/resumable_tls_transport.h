@@ -0,0 +1,38 @@
+#ifndef RESUMABLE_TLS_TRANSPORT_H
+#define RESUMABLE_TLS_TRANSPORT_H
+
+#include <transport.h>
+#include <string>
+
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+// 支持会话恢复的 TLS 传输层，握手前从 TlsSessionCache 取出会话，握手后把新票据写回
+class ResumableTlsTransport : public Transport {
+public:
+    ResumableTlsTransport();
+    ~ResumableTlsTransport();
+
+    bool Connect(const char* host, int port) override;
+    void Disconnect() override;
+    int Send(const char* data, size_t length) override;
+    int Receive(char* buffer, size_t bufferSize) override;
+
+private:
+    mbedtls_net_context net_;
+    mbedtls_ssl_context ssl_;
+    mbedtls_ssl_config conf_;
+    mbedtls_entropy_context entropy_;
+    mbedtls_ctr_drbg_context ctr_drbg_;
+    bool seeded_ = false;
+    std::string host_;
+    int port_ = 0;
+
+    bool Handshake(bool offer_cached_session, bool* offered_session);
+    void SaveSession();
+    void Reset();
+};
+
+#endif // RESUMABLE_TLS_TRANSPORT_H
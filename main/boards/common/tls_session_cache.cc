@@ -0,0 +1,104 @@
+#include "tls_session_cache.h"
+#include "metrics.h"
+
+#include <esp_log.h>
+#include <nvs.h>
+
+#define TAG "TlsSessionCache"
+
+std::string TlsSessionCache::MakeName(const std::string& host, int port) {
+    return host + ":" + std::to_string(port);
+}
+
+// 旧固件把会话明文存在 NVS "tls" 命名空间，启动后第一次用到缓存时清掉
+void TlsSessionCache::EraseLegacySessions() {
+    nvs_handle_t handle;
+    if (nvs_open("tls", NVS_READONLY, &handle) != ESP_OK) {
+        return;
+    }
+    nvs_close(handle);
+    if (nvs_open("tls", NVS_READWRITE, &handle) != ESP_OK) {
+        return;
+    }
+    if (nvs_erase_all(handle) == ESP_OK && nvs_commit(handle) == ESP_OK) {
+        ESP_LOGI(TAG, "Erased sessions persisted by an older firmware");
+    }
+    nvs_close(handle);
+}
+
+bool TlsSessionCache::Load(const std::string& host, int port, mbedtls_ssl_session* session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!legacy_erased_) {
+        legacy_erased_ = true;
+        EraseLegacySessions();
+    }
+    auto name = MakeName(host, port);
+    auto it = sessions_.find(name);
+    if (it == sessions_.end()) {
+        return false;
+    }
+
+    int ret = mbedtls_ssl_session_load(session, it->second.data(), it->second.size());
+    if (ret != 0) {
+        ESP_LOGW(TAG, "Drop cached session for %s: -0x%x", name.c_str(), -ret);
+        sessions_.erase(it);
+        return false;
+    }
+    return true;
+}
+
+void TlsSessionCache::Store(const std::string& host, int port, const mbedtls_ssl_session* session) {
+    size_t length = 0;
+    mbedtls_ssl_session_save(session, nullptr, 0, &length);
+    if (length == 0) {
+        return;
+    }
+    std::vector<uint8_t> data(length);
+    if (mbedtls_ssl_session_save(session, data.data(), data.size(), &length) != 0) {
+        return;
+    }
+    data.resize(length);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_[MakeName(host, port)] = std::move(data);
+}
+
+void TlsSessionCache::Forget(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sessions_.erase(MakeName(host, port));
+}
+
+void TlsSessionCache::RecordHandshake(bool resumed, int64_t duration_us) {
+    auto& metrics = Metrics::GetInstance();
+    metrics.Increment(kMetricTlsHandshakes);
+    if (resumed) {
+        metrics.Increment(kMetricTlsResumed);
+    }
+    metrics.Observe(kMetricTlsHandshakeUs, duration_us);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto stats : {&boot_stats_, &conversation_stats_}) {
+        stats->handshakes++;
+        stats->resumed += resumed ? 1 : 0;
+        stats->total_us += duration_us;
+    }
+}
+
+void TlsSessionCache::EndConversation() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (conversation_stats_.handshakes == 0) {
+        return;
+    }
+    ESP_LOGI(TAG, "TLS handshakes this conversation: %d (%d resumed, %lld ms), this boot: %d (%d resumed, %lld ms)",
+        conversation_stats_.handshakes, conversation_stats_.resumed, conversation_stats_.total_us / 1000,
+        boot_stats_.handshakes, boot_stats_.resumed, boot_stats_.total_us / 1000);
+    conversation_stats_ = HandshakeStats();
+}
+
+std::string TlsSessionCache::GetJson() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string json = "{\"handshakes\":" + std::to_string(boot_stats_.handshakes);
+    json += ",\"resumed\":" + std::to_string(boot_stats_.resumed);
+    json += ",\"handshake_ms\":" + std::to_string(boot_stats_.total_us / 1000) + "}";
+    return json;
+}
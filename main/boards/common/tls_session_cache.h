@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <mbedtls/ssl.h>
+
+/**
+ * @brief TlsSessionCache 按 host:port 缓存 TLS 会话（含服务端下发的会话票据）。
+ *
+ * - 重连时把缓存的会话交给 mbedtls，服务端接受时只需一次简短握手，省去证书链传输与校验；
+ * - 会话里有主密钥，只保存在内存中，不写入 NVS（NVS 未加密）。重启后第一次连接是完整握手；
+ * - 统计本次启动和本次对话的握手次数、恢复次数与耗时，进入空闲时输出日志。
+ */
+class TlsSessionCache {
+public:
+    static TlsSessionCache& GetInstance() {
+        static TlsSessionCache instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache& operator=(const TlsSessionCache&) = delete;
+
+    // 取出缓存的会话，session 需已 mbedtls_ssl_session_init
+    bool Load(const std::string& host, int port, mbedtls_ssl_session* session);
+    // 握手完成或收到新票据后保存
+    void Store(const std::string& host, int port, const mbedtls_ssl_session* session);
+    // 服务端拒绝或会话损坏时丢弃
+    void Forget(const std::string& host, int port);
+
+    void RecordHandshake(bool resumed, int64_t duration_us);
+    // 一次对话结束，输出本次对话与本次启动的握手统计并清零对话统计
+    void EndConversation();
+
+    // {"handshakes":3,"resumed":2,"handshake_ms":410}
+    std::string GetJson();
+
+private:
+    TlsSessionCache() = default;
+    ~TlsSessionCache() = default;
+
+    struct HandshakeStats {
+        int handshakes = 0;
+        int resumed = 0;
+        int64_t total_us = 0;
+    };
+
+    std::mutex mutex_;
+    std::map<std::string, std::vector<uint8_t>> sessions_;
+    bool legacy_erased_ = false;
+    HandshakeStats boot_stats_;
+    HandshakeStats conversation_stats_;
+
+    static std::string MakeName(const std::string& host, int port);
+    static void EraseLegacySessions();
+};
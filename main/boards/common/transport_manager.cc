@@ -0,0 +1,48 @@
+#include "transport_manager.h"
+
+int TransportManager::Smooth(int previous, int quality) {
+    // 断开立即生效，其余情况做指数平滑，避免单次 RSSI 抖动触发迁移
+    if (quality <= 0 || previous < 0) {
+        return quality < 0 ? 0 : quality;
+    }
+    return (previous * 3 + quality) / 4;
+}
+
+TransportManager::Decision TransportManager::Sample(int active_quality, int standby_quality,
+    bool active_is_preferred, int64_t now_ms) {
+    active_quality_ = Smooth(active_quality_, active_quality);
+    standby_quality_ = Smooth(standby_quality_, standby_quality);
+
+    if (active_quality_ < kPoorQuality) {
+        poor_count_++;
+    } else {
+        poor_count_ = 0;
+    }
+    if (standby_quality_ >= kGoodQuality) {
+        if (standby_good_since_ms_ < 0) {
+            standby_good_since_ms_ = now_ms;
+        }
+    } else {
+        standby_good_since_ms_ = -1;
+    }
+
+    if (now_ms - last_migration_ms_ < kMinDwellMs || standby_good_since_ms_ < 0) {
+        return kDecisionStay;
+    }
+    if (poor_count_ >= kPoorSamples) {
+        return kDecisionMigrate;
+    }
+    if (!active_is_preferred && now_ms - standby_good_since_ms_ >= kRecoverMs) {
+        return kDecisionMigrate;
+    }
+    return kDecisionStay;
+}
+
+void TransportManager::OnMigrated(int64_t now_ms) {
+    int quality = active_quality_;
+    active_quality_ = standby_quality_;
+    standby_quality_ = quality;
+    poor_count_ = 0;
+    standby_good_since_ms_ = -1;
+    last_migration_ms_ = now_ms;
+}
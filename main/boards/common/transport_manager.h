@@ -0,0 +1,47 @@
+#ifndef TRANSPORT_MANAGER_H
+#define TRANSPORT_MANAGER_H
+
+#include <cstdint>
+
+/**
+ * @brief TransportManager 双链路（WiFi/ML307）切换策略，不依赖具体网络实现。
+ *
+ * 调用者定期传入两条链路的质量（0-100，0 表示断开），返回是否需要迁移到备用链路：
+ * - 当前链路连续 kPoorSamples 次低于 kPoorQuality，且备用链路不低于 kGoodQuality 时迁移；
+ * - 运行在非首选链路上时，首选链路持续良好 kRecoverMs 后迁回；
+ * - 两次迁移之间至少间隔 kMinDwellMs，避免来回抖动。
+ *
+ * scripts/transport/transport_check.cc 在主机上编译这个类做回归检查，scripts/transport_sim.py
+ * 通过它模拟断网场景，两者都直接使用这里的实现。
+ */
+class TransportManager {
+public:
+    enum Decision {
+        kDecisionStay,
+        kDecisionMigrate,
+    };
+
+    static constexpr int kPoorQuality = 25;
+    static constexpr int kGoodQuality = 50;
+    static constexpr int kPoorSamples = 3;
+    static constexpr int64_t kMinDwellMs = 30 * 1000;
+    static constexpr int64_t kRecoverMs = 60 * 1000;
+
+    Decision Sample(int active_quality, int standby_quality, bool active_is_preferred, int64_t now_ms);
+    // 迁移完成后调用，交换两条链路的统计
+    void OnMigrated(int64_t now_ms);
+
+    int active_quality() const { return active_quality_; }
+    int standby_quality() const { return standby_quality_; }
+
+private:
+    int active_quality_ = -1;
+    int standby_quality_ = -1;
+    int poor_count_ = 0;
+    int64_t last_migration_ms_ = INT64_MIN / 2;
+    int64_t standby_good_since_ms_ = -1;
+
+    static int Smooth(int previous, int quality);
+};
+
+#endif // TRANSPORT_MANAGER_H
@@ -6,6 +6,7 @@
 #include "font_awesome_symbols.h"
 #include "settings.h"
 #include "assets/lang_config.h"
+#include "resumable_tls_transport.h"
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -13,9 +14,9 @@
 #include <esp_mqtt.h>
 #include <esp_udp.h>
 #include <tcp_transport.h>
-#include <tls_transport.h>
 #include <web_socket.h>
 #include <esp_log.h>
+#include <algorithm>
 
 #include <wifi_station.h>
 #include <wifi_configuration_ap.h>
@@ -117,7 +118,8 @@ WebSocket* WifiBoard::CreateWebSocket() {
 #ifdef CONFIG_CONNECTION_TYPE_WEBSOCKET
     std::string url = CONFIG_WEBSOCKET_URL;
     if (url.find("wss://") == 0) {
-        return new WebSocket(new TlsTransport());
+        // 重连时恢复 TLS 会话，省去完整握手
+        return new WebSocket(new ResumableTlsTransport());
     } else {
         return new WebSocket(new TcpTransport());
     }
@@ -171,6 +173,25 @@ void WifiBoard::SetPowerSaveMode(bool enabled) {
     wifi_station.SetPowerSaveMode(enabled);
 }
 
+bool WifiBoard::StartStandby() {
+    auto& ssid_manager = SsidManager::GetInstance();
+    if (ssid_manager.GetSsidList().empty()) {
+        return false;
+    }
+    WifiStation::GetInstance().Start();
+    return true;
+}
+
+int WifiBoard::GetLinkQuality() {
+    auto& wifi_station = WifiStation::GetInstance();
+    if (wifi_config_mode_ || !wifi_station.IsConnected()) {
+        return 0;
+    }
+    // -90dBm 到 -50dBm 线性映射到 0-100
+    int quality = (wifi_station.GetRssi() + 90) * 100 / 40;
+    return std::max(0, std::min(100, quality));
+}
+
 void WifiBoard::ResetWifiConfiguration() {
     // Set a flag and reboot the device to enter the network configuration mode
     {
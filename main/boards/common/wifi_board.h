@@ -23,6 +23,11 @@ public:
     virtual void SetPowerSaveMode(bool enabled) override;
     virtual void ResetWifiConfiguration();
 
+    // 作为备用链路启动：只在后台连接已保存的 WiFi，不进入配网模式
+    bool StartStandby();
+    // 链路质量 0-100，未连接为 0
+    int GetLinkQuality();
+
     virtual AudioCodec* GetAudioCodec() override { return nullptr; }
 };
 
@@ -8,6 +8,7 @@
 #include "config.h" // OLED的I2C引脚和屏幕尺寸定义
 #include "iot/thing_manager.h"
 #include "led/single_led.h"
+#include "power_state_manager.h"
 
 #include <wifi_station.h>
 #include <esp_log.h>
@@ -203,6 +204,8 @@ public:
         InitUart();                  // 初始化串口
         InitializeButtons();         // 初始化按钮
         InitializeIot();             // 初始化IOT
+        // 只启用按状态调频，常供电设备不进入 light sleep
+        PowerStateManager::GetInstance().Initialize(240, -1);
     }
 
     virtual AudioCodec* GetAudioCodec() override {
@@ -14,6 +14,7 @@
 #include <esp_lcd_panel_ops.h>
 #include <esp_lcd_panel_vendor.h>
 #include "dual_display_manager.h"
+#include "power_state_manager.h"
 
 // 修改：使用EyeAnimationDisplay替换EyeDisplay
 #include "display/eye_animation_display.h"  // 包含EyeAnimationDisplay类定义
@@ -84,6 +85,8 @@ YuwellXiaoyuEsp32S3BoardDoubleLcd::YuwellXiaoyuEsp32S3BoardDoubleLcd() :
     InitUart();
     InitializeButtons();
     InitializeIot();
+    // 只启用按状态调频，常供电设备不进入 light sleep
+    PowerStateManager::GetInstance().Initialize(240, -1);
     dual_display_manager_.Initialize();
     g_dual_display_manager = &dual_display_manager_;
     // 创建EyeAnimationDisplay对象，去掉UI只保留双屏眼睛
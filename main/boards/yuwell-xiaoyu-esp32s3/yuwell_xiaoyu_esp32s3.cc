@@ -5,9 +5,11 @@
 //#include "display/lcd_ display.h"
 #include "application.h"
 #include "button.h"
+#include "input_event_bus.h"
 #include "config.h" // OLED的I2C引脚和屏幕尺寸定义
 #include "iot/thing_manager.h"
 #include "led/single_led.h"
+#include "power_state_manager.h"
 
 #include <wifi_station.h>
 #include <esp_log.h>
@@ -240,21 +242,34 @@ private:
 
 
 
+    // InputEventBus 中的按键编号
+    enum ButtonSource : uint8_t {
+        kButtonBoot,
+        kButtonInternal,
+        kButtonWifiSwitch,
+    };
+
     void InitializeButtons() {
+        // 按键事件交给 InputEventBus，处理函数在它的 input_events 任务里执行，主循环启动前也能响应
+        boot_button_.PostEvents(kButtonBoot);
+        internal_button_.PostEvents(kButtonInternal);
+        wifi_switch_button_.PostEvents(kButtonWifiSwitch);
+        auto& bus = InputEventBus::GetInstance();
+
         // Boot按键：切换聊天状态
-        boot_button_.OnClick([this]() {
+        bus.OnGesture(kGestureClick, kButtonBoot, [this](const InputGesture&) {
             auto& app = Application::GetInstance();
             app.ToggleChatState();
         });
 
         
-        internal_button_.OnClick([this]() {
+        bus.OnGesture(kGestureClick, kButtonInternal, [this](const InputGesture&) {
             //ESP_LOGI(TAG, "Internal button pressed");
             auto& app = Application::GetInstance();
             app.ChangeChatState();
         });
         // *** 将 key1 的单击事件放在这里 ***
-        wifi_switch_button_.OnClick([this]() {
+        bus.OnGesture(kGestureClick, kButtonWifiSwitch, [this](const InputGesture&) {
             ESP_LOGI(TAG, "key1 (wifi_switch_button) clicked, toggling Bluetooth.");
             cJSON *command = cJSON_CreateObject();
             cJSON_AddStringToObject(command, "name", "BluetoothControl");
@@ -264,7 +279,7 @@ private:
             thing_manager.Invoke(command);
             cJSON_Delete(command);
         });
-        wifi_switch_button_.OnLongPress([this]() {
+        bus.OnGesture(kGestureLongPress, kButtonWifiSwitch, [this](const InputGesture&) {
             ESP_LOGI(TAG, "WiFi切换按键长按");
 
              SwitchNetworkType();
@@ -303,6 +318,8 @@ public:
         InitUart();                  // 初始化串口
         InitializeButtons();         // 初始化按钮
         InitializeIot();            // 初始化IOT
+        // 只启用按状态调频，常供电设备不进入 light sleep
+        PowerStateManager::GetInstance().Initialize(240, -1);
         // 初始化背光
          if (DISPLAY_BACKLIGHT_PIN != GPIO_NUM_NC) {
             //GetBacklight()->RestoreBrightness();
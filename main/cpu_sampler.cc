@@ -0,0 +1,235 @@
+#include "cpu_sampler.h"
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+#include <cstring>
+
+#define TAG "CpuSampler"
+
+// 已删除任务占用的槽位，查找时跳过，插入时可复用
+#define SLOT_TOMBSTONE ((TaskHandle_t)1)
+
+CpuSampler::~CpuSampler() {
+    if (timer_ != nullptr) {
+        esp_timer_stop(timer_);
+        esp_timer_delete(timer_);
+    }
+    heap_caps_free(status_array_);
+    heap_caps_free(slots_);
+    heap_caps_free(states_);
+}
+
+void CpuSampler::Start(int interval_ms, const char* const* state_names, int state_count) {
+    if (timer_ != nullptr) {
+        return;
+    }
+
+    state_names_ = state_names;
+    state_count_ = std::min(state_count, kMaxStates);
+    interval_ms_ = interval_ms;
+
+    status_array_ = (TaskStatus_t*)heap_caps_calloc(kMaxSlots, sizeof(TaskStatus_t), MALLOC_CAP_INTERNAL);
+    slots_ = (TaskSlot*)heap_caps_calloc(kMaxSlots, sizeof(TaskSlot), MALLOC_CAP_SPIRAM);
+    states_ = (StateStats*)heap_caps_calloc(kMaxStates, sizeof(StateStats), MALLOC_CAP_SPIRAM);
+    if (slots_ == nullptr) {
+        slots_ = (TaskSlot*)heap_caps_calloc(kMaxSlots, sizeof(TaskSlot), MALLOC_CAP_INTERNAL);
+    }
+    if (states_ == nullptr) {
+        states_ = (StateStats*)heap_caps_calloc(kMaxStates, sizeof(StateStats), MALLOC_CAP_INTERNAL);
+    }
+    if (status_array_ == nullptr || slots_ == nullptr || states_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate sampler storage");
+        return;
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = [](void* arg) {
+            auto self = static_cast<CpuSampler*>(arg);
+            self->Sample();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "cpu_sampler",
+        .skip_unhandled_events = true
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &timer_));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(timer_, interval_ms * 1000));
+}
+
+int CpuSampler::FindSlot(TaskHandle_t handle, bool* created) {
+    int start = ((uintptr_t)handle >> 4) & (kMaxSlots - 1);
+    int free_slot = -1;
+    for (int i = 0; i < kMaxSlots; i++) {
+        int index = (start + i) & (kMaxSlots - 1);
+        auto& slot = slots_[index];
+        if (slot.handle == handle) {
+            *created = false;
+            return index;
+        }
+        if (slot.handle == SLOT_TOMBSTONE) {
+            if (free_slot < 0) {
+                free_slot = index;
+            }
+        } else if (slot.handle == nullptr) {
+            if (free_slot < 0) {
+                free_slot = index;
+            }
+            break;
+        }
+    }
+    if (free_slot >= 0) {
+        *created = true;
+        slots_[free_slot].handle = handle;
+    }
+    return free_slot;
+}
+
+void CpuSampler::Sample() {
+    UBaseType_t count = uxTaskGetSystemState(status_array_, kMaxSlots, nullptr);
+    if (count == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sample_id_++;
+    int state = state_;
+    StateStats* stats = (state >= 0 && state < state_count_) ? &states_[state] : nullptr;
+
+    uint64_t total = 0;
+    uint64_t idle = 0;
+    for (UBaseType_t i = 0; i < count; i++) {
+        auto& status = status_array_[i];
+        bool created = false;
+        int index = FindSlot(status.xHandle, &created);
+        if (index < 0) {
+            continue;
+        }
+        auto& slot = slots_[index];
+        if (created) {
+            // 新任务：复用的槽位要清空各状态的累计值
+            strncpy(slot.name, status.pcTaskName, sizeof(slot.name) - 1);
+            slot.name[sizeof(slot.name) - 1] = '\0';
+            slot.idle = strncmp(slot.name, "IDLE", 4) == 0;
+            slot.last_runtime = status.ulRunTimeCounter;
+            slot.last_delta = 0;
+            for (int s = 0; s < kMaxStates; s++) {
+                states_[s].task_time[index] = 0;
+            }
+        } else {
+            slot.last_delta = status.ulRunTimeCounter - slot.last_runtime;
+            slot.last_runtime = status.ulRunTimeCounter;
+        }
+        slot.sample_id = sample_id_;
+
+        total += slot.last_delta;
+        if (slot.idle) {
+            idle += slot.last_delta;
+        }
+        if (stats != nullptr) {
+            stats->task_time[index] += slot.last_delta;
+        }
+    }
+
+    // 本次未出现的任务已被删除
+    for (int i = 0; i < kMaxSlots; i++) {
+        auto& slot = slots_[i];
+        if (slot.handle != nullptr && slot.handle != SLOT_TOMBSTONE && slot.sample_id != sample_id_) {
+            slot.handle = SLOT_TOMBSTONE;
+        }
+    }
+
+    last_total_ = total;
+    if (stats != nullptr && total > 0) {
+        uint32_t load = (total - idle) * 100 / total;
+        stats->samples++;
+        stats->total_time += total;
+        stats->busy_time += total - idle;
+        stats->peak_load = std::max(stats->peak_load, load);
+    }
+}
+
+std::string CpuSampler::GetJson() {
+    std::string json = "{\"interval_ms\":" + std::to_string(interval_ms_) + ",\"states\":{";
+    if (states_ == nullptr || slots_ == nullptr) {
+        return json + "}}";
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    char buffer[64];
+    for (int s = 0; s < state_count_; s++) {
+        auto& stats = states_[s];
+        if (stats.samples == 0 || stats.total_time == 0) {
+            continue;
+        }
+        json += "\"" + std::string(state_names_[s]) + "\":{";
+        json += "\"samples\":" + std::to_string(stats.samples) + ",";
+        snprintf(buffer, sizeof(buffer), "\"avg_load\":%.1f,", stats.busy_time * 100.0 / stats.total_time);
+        json += buffer;
+        json += "\"peak_load\":" + std::to_string(stats.peak_load) + ",";
+
+        // 只输出占用最高的几个非空闲任务
+        int top[kTopTasks];
+        int top_count = 0;
+        for (int i = 0; i < kMaxSlots; i++) {
+            if (slots_[i].handle == nullptr || slots_[i].idle || stats.task_time[i] == 0) {
+                continue;
+            }
+            int pos = top_count < kTopTasks ? top_count++ : kTopTasks;
+            while (pos > 0 && stats.task_time[top[pos - 1]] < stats.task_time[i]) {
+                if (pos < kTopTasks) {
+                    top[pos] = top[pos - 1];
+                }
+                pos--;
+            }
+            if (pos < kTopTasks) {
+                top[pos] = i;
+            }
+        }
+        json += "\"top_tasks\":{";
+        for (int i = 0; i < top_count; i++) {
+            snprintf(buffer, sizeof(buffer), "\"%s\":%.1f,", slots_[top[i]].name,
+                stats.task_time[top[i]] * 100.0 / stats.total_time);
+            json += buffer;
+        }
+        if (top_count > 0) {
+            json.pop_back();
+        }
+        json += "}},";
+    }
+    if (json.back() == ',') {
+        json.pop_back();
+    }
+    json += "}}";
+    return json;
+}
+
+void CpuSampler::GetStateTotals(int state, uint64_t* busy, uint64_t* total) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (states_ == nullptr || state < 0 || state >= state_count_) {
+        *busy = 0;
+        *total = 0;
+        return;
+    }
+    *busy = states_[state].busy_time;
+    *total = states_[state].total_time;
+}
+
+void CpuSampler::PrintLastSample() {
+    if (slots_ == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (last_total_ == 0) {
+        return;
+    }
+    printf("| Task | Run Time | Percentage\n");
+    for (int i = 0; i < kMaxSlots; i++) {
+        auto& slot = slots_[i];
+        if (slot.handle == nullptr || slot.handle == SLOT_TOMBSTONE) {
+            continue;
+        }
+        printf("| %-16s | %8lu | %4lu%%\n", slot.name, (unsigned long)slot.last_delta,
+            (unsigned long)((uint64_t)slot.last_delta * 100 / last_total_));
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef _CPU_SAMPLER_H_
+#define _CPU_SAMPLER_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+#include <mutex>
+#include <string>
+
+/*
+ * 后台 CPU 占用采样
+ * 定时读取各任务的运行时间，按当前设备状态分别累计，用于统计每个状态下的 CPU 预算。
+ * 所有存储在 Start() 时一次性分配，采样过程不再申请内存；任务按句柄哈希查找，单次采样 O(n)。
+ */
+class CpuSampler {
+public:
+    static CpuSampler& GetInstance() {
+        static CpuSampler instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    CpuSampler(const CpuSampler&) = delete;
+    CpuSampler& operator=(const CpuSampler&) = delete;
+
+    void Start(int interval_ms, const char* const* state_names, int state_count);
+    void SetState(int state) { state_ = state; }
+
+    // {"interval_ms":1000,"states":{"idle":{"samples":10,"avg_load":12.5,"peak_load":30,"top_tasks":{...}}}}
+    std::string GetJson();
+    // 某个状态累计的忙碌时间和总时间（运行时间计数单位）
+    void GetStateTotals(int state, uint64_t* busy, uint64_t* total);
+    // 打印最近一次采样的各任务占用
+    void PrintLastSample();
+
+private:
+    CpuSampler() = default;
+    ~CpuSampler();
+
+    static constexpr int kMaxSlots = 64;
+    static constexpr int kMaxStates = 12;
+    static constexpr int kTopTasks = 5;
+
+    struct TaskSlot {
+        TaskHandle_t handle;
+        char name[configMAX_TASK_NAME_LEN];
+        configRUN_TIME_COUNTER_TYPE last_runtime;
+        uint32_t last_delta;
+        uint32_t sample_id;
+        bool idle;
+    };
+
+    struct StateStats {
+        uint32_t samples;
+        uint32_t peak_load;
+        uint64_t total_time;
+        uint64_t busy_time;
+        uint64_t task_time[kMaxSlots];
+    };
+
+    std::mutex mutex_;
+    esp_timer_handle_t timer_ = nullptr;
+    TaskStatus_t* status_array_ = nullptr;
+    TaskSlot* slots_ = nullptr;
+    StateStats* states_ = nullptr;
+    const char* const* state_names_ = nullptr;
+    int state_count_ = 0;
+    int interval_ms_ = 0;
+    uint32_t sample_id_ = 0;
+    uint32_t last_total_ = 0;
+    volatile int state_ = 0;
+
+    int FindSlot(TaskHandle_t handle, bool* created);
+    void Sample();
+};
+
+#endif // _CPU_SAMPLER_H_
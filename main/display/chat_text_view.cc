@@ -0,0 +1,202 @@
+#include "chat_text_view.h"
+#include "frame_rate_governor.h"
+
+#include <algorithm>
+#include <cstring>
+
+// 读出一个 UTF-8 字符，返回字节数；非法字节按单字节处理
+static size_t DecodeUtf8(const char* p, uint32_t& letter) {
+    auto s = reinterpret_cast<const uint8_t*>(p);
+    if (s[0] < 0x80) {
+        letter = s[0];
+        return 1;
+    }
+    size_t length = (s[0] & 0xE0) == 0xC0 ? 2 : (s[0] & 0xF0) == 0xE0 ? 3 : (s[0] & 0xF8) == 0xF0 ? 4 : 1;
+    letter = length == 1 ? s[0] : s[0] & (0x7F >> length);
+    for (size_t i = 1; i < length; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            letter = s[0];
+            return 1;
+        }
+        letter = (letter << 6) | (s[i] & 0x3F);
+    }
+    return length;
+}
+
+// 字符串最后一个 UTF-8 字符，空串返回 0
+static uint32_t LastLetter(const char* text) {
+    size_t length = strlen(text);
+    if (length == 0) {
+        return 0;
+    }
+    size_t start = length - 1;
+    while (start > 0 && length - start < 4 && (text[start] & 0xC0) == 0x80) {
+        start--;
+    }
+    uint32_t letter;
+    return start + DecodeUtf8(text + start, letter) == length ? letter : (uint8_t)text[length - 1];
+}
+
+// 全角标点（CJK 符号和全角 ASCII 标点）自带间距，后面不用再补空格
+static bool IsSpaceOrWidePunctuation(uint32_t letter) {
+    return letter == ' ' || letter == '\n' || letter == '\t' || letter == '\r' || letter == 0x3000 ||
+        (letter > 0x3000 && letter <= 0x303F) || (letter >= 0xFF01 && letter <= 0xFF0F) ||
+        (letter >= 0xFF1A && letter <= 0xFF20) || letter == 0x2026 || letter == 0x2014;
+}
+
+ChatTextView::ChatTextView(lv_obj_t* parent, const lv_font_t* font, lv_coord_t width, size_t max_lines)
+    : font_(font), max_width_(width), lines_(std::max<size_t>(max_lines, 1)) {
+    // 高度固定为 max_lines 行，内容变化时父对象不需要重新布局
+    container_ = lv_obj_create(parent);
+    lv_obj_set_size(container_, width, font_->line_height * lines_.size());
+    lv_obj_set_style_pad_all(container_, 0, 0);
+    lv_obj_set_style_pad_row(container_, 0, 0);
+    lv_obj_set_style_border_width(container_, 0, 0);
+    lv_obj_set_style_bg_opa(container_, LV_OPA_TRANSP, 0);
+    lv_obj_set_scrollbar_mode(container_, LV_SCROLLBAR_MODE_OFF);
+    lv_obj_clear_flag(container_, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_flex_flow(container_, LV_FLEX_FLOW_COLUMN);
+
+    for (auto& line : lines_) {
+        line.label = lv_label_create(container_);
+        lv_obj_set_size(line.label, width, font_->line_height);
+        lv_label_set_long_mode(line.label, LV_LABEL_LONG_CLIP);
+        lv_obj_set_style_text_align(line.label, LV_TEXT_ALIGN_CENTER, 0);
+        lv_obj_set_style_text_font(line.label, font_, 0);
+        lv_label_set_text(line.label, "");
+    }
+
+    period_ = FrameRateGovernor::GetInstance().GetMinFrameIntervalMs();
+    timer_ = lv_timer_create([](lv_timer_t* timer) {
+        static_cast<ChatTextView*>(lv_timer_get_user_data(timer))->Flush();
+    }, period_, this);
+}
+
+ChatTextView::~ChatTextView() {
+    if (timer_ != nullptr) {
+        lv_timer_delete(timer_);
+    }
+}
+
+void ChatTextView::Append(const char* role, const char* text) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (role_ != role) {
+            role_ = role;
+            pending_.clear();
+            last_letter_ = 0;
+            clear_pending_ = true;
+        }
+        uint32_t first = 0;
+        if (*text != '\0') {
+            DecodeUtf8(text, first);
+        }
+        if (last_letter_ != 0 && first != 0 && !IsSpaceOrWidePunctuation(last_letter_) &&
+            !IsSpaceOrWidePunctuation(first)) {
+            pending_ += ' ';
+        }
+        pending_ += text;
+        if (first != 0) {
+            last_letter_ = LastLetter(text);
+        }
+    }
+    dirty_ = true;
+}
+
+void ChatTextView::Set(const char* role, const char* text) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        role_ = role;
+        pending_ = text;
+        last_letter_ = LastLetter(text);
+        clear_pending_ = true;
+    }
+    dirty_ = true;
+}
+
+void ChatTextView::SetTextColor(lv_color_t color) {
+    for (auto& line : lines_) {
+        lv_obj_set_style_text_color(line.label, color, 0);
+    }
+}
+
+void ChatTextView::NewLine() {
+    if (used_ < lines_.size()) {
+        used_++;
+        return;
+    }
+    // 已满：最上面一行清空后挪到最后，其余行整体上移一行
+    auto& oldest = lines_[first_];
+    lv_label_set_text(oldest.label, "");
+    oldest.width = 0;
+    lv_obj_move_to_index(oldest.label, -1);
+    first_ = (first_ + 1) % lines_.size();
+}
+
+void ChatTextView::Clear() {
+    for (size_t i = 0; i < used_; i++) {
+        auto& line = lines_[(first_ + i) % lines_.size()];
+        lv_label_set_text(line.label, "");
+        line.width = 0;
+    }
+    used_ = 1;
+}
+
+void ChatTextView::Flush() {
+    // 跟随当前的帧率档位
+    uint32_t period = FrameRateGovernor::GetInstance().GetMinFrameIntervalMs();
+    if (period != period_) {
+        period_ = period;
+        lv_timer_set_period(timer_, period);
+    }
+    if (!dirty_) {
+        return;
+    }
+
+    std::string text;
+    bool clear;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        text.swap(pending_);
+        clear = clear_pending_;
+        clear_pending_ = false;
+        dirty_ = false;
+    }
+    if (clear) {
+        Clear();
+    }
+
+    // 按行切成连续的字形片段，每段只在所在行末尾插入一次
+    std::string run;
+    auto commit_run = [this, &run]() {
+        if (!run.empty()) {
+            lv_label_ins_text(CurrentLine().label, LV_LABEL_POS_LAST, run.c_str());
+            run.clear();
+        }
+    };
+    const char* p = text.c_str();
+    while (*p != '\0') {
+        uint32_t letter;
+        size_t length = DecodeUtf8(p, letter);
+        if (letter == '\n') {
+            commit_run();
+            NewLine();
+        } else if (letter != '\r') {
+            lv_coord_t glyph_width = lv_font_get_glyph_width(font_, letter, 0);
+            auto& line = CurrentLine();
+            if (line.width > 0 && line.width + glyph_width > max_width_) {
+                commit_run();
+                NewLine();
+                if (letter == ' ') {
+                    // 折行处的空格不显示，否则新行开头空一格
+                    p += length;
+                    continue;
+                }
+            }
+            CurrentLine().width += glyph_width;
+            run.append(p, length);
+        }
+        p += length;
+    }
+    commit_run();
+}
@@ -0,0 +1,62 @@
+#ifndef CHAT_TEXT_VIEW_H
+#define CHAT_TEXT_VIEW_H
+
+#include <lvgl.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * 流式对话文字视图
+ * - 最近 max_lines 行放在一个环形缓冲里，每行一个固定高度的 label；追加文字只在最后一行末尾插入，
+ *   LVGL 只重绘这一行，容器高度固定，不会触发整个界面重新布局。
+ * - 换行在追加时按字形宽度计算，每行缓存已用宽度，不会重新测量已经显示的文字；每行居中显示。
+ * - 逐句追加时，上一句不是以空白或全角标点结尾就补一个空格，英文句子不会连在一起。
+ * - Append/Set 可以在任意任务调用，只把文字放进待处理缓冲；LVGL 定时器按 FrameRateGovernor 的帧间隔
+ *   把这段时间收到的文字合并成一次刷新。
+ * label 属于 parent，随 parent 一起删除；析构只删除定时器。
+ */
+class ChatTextView {
+public:
+    // 需要在持有显示锁时创建
+    ChatTextView(lv_obj_t* parent, const lv_font_t* font, lv_coord_t width, size_t max_lines);
+    ~ChatTextView();
+
+    // 追加文字；角色和当前显示的不同时先清空
+    void Append(const char* role, const char* text);
+    // 替换为一条新消息，内容为空时清空
+    void Set(const char* role, const char* text);
+    // 需要在持有显示锁时调用
+    void SetTextColor(lv_color_t color);
+
+private:
+    struct Line {
+        lv_obj_t* label = nullptr;
+        lv_coord_t width = 0;   // 已用宽度，换行判断只看这个缓存
+    };
+
+    const lv_font_t* font_;
+    lv_coord_t max_width_;
+    lv_obj_t* container_ = nullptr;
+    lv_timer_t* timer_ = nullptr;
+    uint32_t period_ = 0;
+    std::vector<Line> lines_;   // 环形缓冲，显示顺序从 first_ 开始
+    size_t first_ = 0;
+    size_t used_ = 1;
+
+    std::mutex mutex_;
+    std::string pending_;
+    std::string role_;
+    uint32_t last_letter_ = 0;  // 当前消息最后一个字符，决定下一句前是否补空格
+    bool clear_pending_ = false;
+    std::atomic<bool> dirty_{false};
+
+    Line& CurrentLine() { return lines_[(first_ + used_ - 1) % lines_.size()]; }
+    void NewLine();
+    void Clear();
+    void Flush();
+};
+
+#endif // CHAT_TEXT_VIEW_H
@@ -5,6 +5,7 @@
 #include <cstring>
 
 #include "display.h"
+#include "chat_text_view.h"
 #include "board.h"
 #include "application.h"
 #include "font_awesome_symbols.h"
@@ -13,6 +14,7 @@
 #include "assets/lang_config.h"
 // 在文件顶部添加包含
 #include "emotion_manager.h"
+#include "power_state_manager.h"
 
 #define TAG "Display"
 
@@ -49,14 +51,6 @@ Display::Display() {
     };
     ESP_ERROR_CHECK(esp_timer_create(&update_display_timer_args, &update_timer_));
     // 注意：这里不启动定时器，将在UI初始化完成后启动
-
-    // Create a power management lock
-    auto ret = esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "display_update", &pm_lock_);
-    if (ret == ESP_ERR_NOT_SUPPORTED) {
-        ESP_LOGI(TAG, "Power management not supported");
-    } else {
-        ESP_ERROR_CHECK(ret);
-    }
 }
 
 Display::~Display() {
@@ -80,9 +74,6 @@ Display::~Display() {
     if( low_battery_popup_ != nullptr ) {
         lv_obj_del(low_battery_popup_);
     }
-    if (pm_lock_ != nullptr) {
-        esp_pm_lock_delete(pm_lock_);
-    }
 }
 
 void Display::SetStatus(const char* status) {
@@ -132,7 +123,7 @@ void Display::Update() {
         }
     }
 
-    esp_pm_lock_acquire(pm_lock_);
+    PowerStateManager::GetInstance().Acquire(kPmSubsystemDisplay);
     // 更新电池图标
     int battery_level;
     bool charging, discharging;
@@ -191,7 +182,7 @@ void Display::Update() {
         }
     }
 
-    esp_pm_lock_release(pm_lock_);
+    PowerStateManager::GetInstance().Release(kPmSubsystemDisplay);
 }
 
 
@@ -230,6 +221,10 @@ void Display::SetIcon(const char* icon) {
 }
 
 void Display::SetChatMessage(const char* role, const char* content) {
+    if (chat_text_view_ != nullptr) {
+        chat_text_view_->Set(role, content);
+        return;
+    }
     DisplayLockGuard lock(this);
     if (chat_message_label_ == nullptr) {
         return;
@@ -237,6 +232,14 @@ void Display::SetChatMessage(const char* role, const char* content) {
     lv_label_set_text(chat_message_label_, content);
 }
 
+void Display::AppendChatText(const char* role, const char* text) {
+    if (chat_text_view_ != nullptr) {
+        chat_text_view_->Append(role, text);
+        return;
+    }
+    SetChatMessage(role, text);
+}
+
 void Display::SetTheme(const std::string& theme_name) {
     current_theme_name_ = theme_name;
     Settings settings("display", true);
@@ -4,11 +4,12 @@
 #include <lvgl.h>
 #include <esp_timer.h>
 #include <esp_log.h>
-#include <esp_pm.h>
 
 #include <string>
+#include <memory>
 
 struct Animation;
+class ChatTextView;
 
 struct DisplayFonts {
     const lv_font_t* text_font = nullptr;
@@ -26,6 +27,9 @@ public:
     virtual void ShowNotification(const std::string &notification, int duration_ms = 3000);
     virtual void SetEmotion(const char* emotion);
     virtual void SetChatMessage(const char* role, const char* content);
+    // 流式追加对话文字（tts sentence_start 逐句到达），可以在任意任务调用；
+    // 有 ChatTextView 时只重绘新增的部分并按帧率合并刷新，否则按整条消息替换
+    virtual void AppendChatText(const char* role, const char* text);
     virtual void SetIcon(const char* icon);
     virtual void SetTheme(const std::string& theme_name);
     
@@ -49,7 +53,6 @@ protected:
     int width_ = 0;
     int height_ = 0;
     
-    esp_pm_lock_handle_t pm_lock_ = nullptr;
     lv_display_t *display_ = nullptr;
 
     lv_obj_t *emotion_label_ = nullptr;
@@ -59,6 +62,7 @@ protected:
     lv_obj_t *mute_label_ = nullptr;
     lv_obj_t *battery_label_ = nullptr;
     lv_obj_t* chat_message_label_ = nullptr;
+    std::unique_ptr<ChatTextView> chat_text_view_;
     lv_obj_t* low_battery_popup_ = nullptr;
     lv_obj_t* low_battery_label_ = nullptr;
     
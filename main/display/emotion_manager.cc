@@ -6,6 +6,7 @@
 #include "emotion_animation.h"
 #include "eye_animation_display.h"  // 添加这个头文件包含
 #include "board.h" // <--- 新增：为了使用 Board::GetInstance()
+#include "heap_tracker.h"
 #include "ui/eye.h"
 
 const char* EmotionManager::TAG = "EmotionManager";
@@ -262,6 +263,7 @@ void EmotionManager::EmotionTaskWrapper(void* param) {
 
 void EmotionManager::EmotionTask() {
     EmotionMessage msg;
+    HeapTracker::SetTaskTag(kHeapTagDisplay);
     ESP_LOGI(TAG, "表情处理任务启动");
     while (true) {
         if (xQueueReceive(emotion_queue_, &msg, portMAX_DELAY) == pdTRUE) {
@@ -303,6 +305,10 @@ void EmotionManager::ProcessEmotionAsync(const char* emotion_name) {
 }
 
 const Animation& EmotionManager::GetAnimation(const std::string& emotion_name) {
+    auto id = Keys::Emotion::Lookup(emotion_name);
+    if (animations_by_id_[id] != nullptr) {
+        return *animations_by_id_[id];
+    }
     auto it = animations_.find(emotion_name);
     if (it != animations_.end()) {
         return it->second;
@@ -340,7 +346,13 @@ void EmotionManager::RegisterAnimation(const std::string& emotion_name, const An
     }
 
     // 【修改】使用 emplace 或下标赋值，更安全高效
-    animations_.emplace(emotion_name, animation);
+    auto result = animations_.emplace(emotion_name, animation);
+    auto id = Keys::Emotion::Lookup(emotion_name);
+    if (id != Keys::Emotion::kUnknown) {
+        animations_by_id_[id] = &result.first->second;
+    } else {
+        ESP_LOGW(TAG, "表情 %s 不在 keywords.json 中，查找时回退到按名字比较", emotion_name.c_str());
+    }
 
     // 【修改】使用 std::get_if 访问 variant
     if (const auto* seq_data = std::get_if<ImageSequenceData>(&animation.data)) {
@@ -1,12 +1,14 @@
 #ifndef EMOTION_MANAGER_H
 #define EMOTION_MANAGER_H
 
+#include <array>
 #include <map>
 #include <string>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
 #include "emotion_animation.h"
+#include "assets/keywords.h"
 
 // 消息结构体定义
 struct EmotionMessage {
@@ -44,6 +46,8 @@ private:
     Animation CreateSleepAnimation();
 
     std::map<std::string, Animation> animations_;
+    // keywords.json 里有的表情按编号直接索引，指向 animations_ 里的元素
+    std::array<const Animation*, Keys::Emotion::kCount> animations_by_id_{};
     Animation default_animation_;
 
     static QueueHandle_t emotion_queue_;
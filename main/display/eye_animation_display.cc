@@ -6,9 +6,14 @@
 #include "esp_timer.h"
 #include "esp_lvgl_port.h"
 #include "lvgl.h"
+#include <algorithm>
 // 添加必要的头文件包含
 #include "../boards/yuwell-xiaoyu-esp32s3-double-lcd/dual_display_manager.h"
 #include "lcd_display.h"
+#include "trace.h"
+#include "heap_tracker.h"
+#include "power_state_manager.h"
+#include "frame_rate_governor.h"
 
 static const char* TAG = "EyeAnimationDisplay";
 
@@ -186,6 +191,11 @@ EyeAnimationDisplay::EyeAnimationDisplay() {
     // 存储显示对象引用
     primary_display_ = primary_display;
     secondary_display_ = secondary_display;
+    {
+        DisplayLockGuard lock(this);
+        AttachRenderPmLock(static_cast<LcdDisplay*>(primary_display)->getLvDisplay());
+        AttachRenderPmLock(static_cast<LcdDisplay*>(secondary_display)->getLvDisplay());
+    }
     
     // 清空screen_成员变量，因为我们现在使用双屏
    // 由于我们现在使用双屏显示,不再需要单个screen_变量,所以这行可以删除
@@ -201,9 +211,36 @@ EyeAnimationDisplay::EyeAnimationDisplay() {
     );
 }
 
+// 显示 PM 锁只覆盖真正有内容要渲染的帧：LVGL 没有脏区域时不会发 RENDER_START，
+// 两帧之间（图片序列等定时器、程序化动画等下一个 tick）不持有锁，light sleep 和降频照常生效
+void EyeAnimationDisplay::AttachRenderPmLock(lv_display_t* display) {
+    if (display == nullptr) {
+        return;
+    }
+    lv_display_add_event_cb(display, OnRenderStart, LV_EVENT_RENDER_START, this);
+    lv_display_add_event_cb(display, OnRenderReady, LV_EVENT_RENDER_READY, this);
+}
+
+void EyeAnimationDisplay::OnRenderStart(lv_event_t* e) {
+    auto self = static_cast<EyeAnimationDisplay*>(lv_event_get_user_data(e));
+    if (!self->pm_lock_held_ && (self->current_animation_ != nullptr || self->is_programmatic_anim_active_)) {
+        PowerStateManager::GetInstance().Acquire(kPmSubsystemDisplay);
+        self->pm_lock_held_ = true;
+    }
+}
+
+void EyeAnimationDisplay::OnRenderReady(lv_event_t* e) {
+    auto self = static_cast<EyeAnimationDisplay*>(lv_event_get_user_data(e));
+    if (self->pm_lock_held_) {
+        PowerStateManager::GetInstance().Release(kPmSubsystemDisplay);
+        self->pm_lock_held_ = false;
+    }
+}
+
 // 任务函数实现
 void EyeAnimationDisplay::animation_task(void* pvParameters) {
     EyeAnimationDisplay* self = static_cast<EyeAnimationDisplay*>(pvParameters);
+    HeapTracker::SetTaskTag(kHeapTagDisplay);
     
     while (true) {
         // 等待任务通知
@@ -211,6 +248,7 @@ void EyeAnimationDisplay::animation_task(void* pvParameters) {
         
         // 在任务上下文中安全地播放下一帧
         if (self) {
+            TRACE_SCOPE("eye_frame");
             self->PlayNextFrame();
         }
     }
@@ -251,6 +289,17 @@ EyeAnimationDisplay::~EyeAnimationDisplay() {
     
     // 清理LVGL对象
     DisplayLockGuard lock(this);
+    for (auto display : { primary_display_, secondary_display_ }) {
+        if (display != nullptr) {
+            auto lv_display = static_cast<LcdDisplay*>(display)->getLvDisplay();
+            lv_display_remove_event_cb_with_user_data(lv_display, OnRenderStart, this);
+            lv_display_remove_event_cb_with_user_data(lv_display, OnRenderReady, this);
+        }
+    }
+    if (pm_lock_held_) {
+        PowerStateManager::GetInstance().Release(kPmSubsystemDisplay);
+        pm_lock_held_ = false;
+    }
     if (left_eye_img_) {
         lv_obj_del(left_eye_img_);
         left_eye_img_ = nullptr;
@@ -274,6 +323,12 @@ void EyeAnimationDisplay::update_image_callback(void* user_data) {
     }
 }
 
+// 帧间隔不小于当前帧率档位的刷新周期，空闲或熄屏时图片序列也随之降速
+static uint64_t FrameDelayUs(int duration_ms) {
+    int min_interval_ms = FrameRateGovernor::GetInstance().GetMinFrameIntervalMs();
+    return (uint64_t)std::max(duration_ms, min_interval_ms) * 1000;
+}
+
 // in file: main/display/eye_animation_display.cc
 
 void EyeAnimationDisplay::PlayNextFrame() {
@@ -318,7 +373,7 @@ void EyeAnimationDisplay::PlayNextFrame() {
             // 重新获取第一帧，并为其设置定时器，以实现无缝循环
             const auto& first_frame = seq_data->frames[0];
             if (first_frame.duration_ms > 0) {
-                esp_timer_start_once(animation_timer_, first_frame.duration_ms * 1000);
+                esp_timer_start_once(animation_timer_, FrameDelayUs(first_frame.duration_ms));
             } else {
                 // 如果第一帧持续时间为0，可能需要立即通知任务播放下一帧
                  xTaskNotifyGive(animation_task_handle_);
@@ -333,7 +388,7 @@ void EyeAnimationDisplay::PlayNextFrame() {
     else {
          // 使用下一帧的持续时间（即当前帧显示的时长）
         if (frame.duration_ms > 0) {
-            esp_timer_start_once(animation_timer_, frame.duration_ms * 1000);
+            esp_timer_start_once(animation_timer_, FrameDelayUs(frame.duration_ms));
         } else {
              // 如果持续时间为0，立即通知任务播放紧接着的下一帧
              xTaskNotifyGive(animation_task_handle_);
@@ -38,6 +38,9 @@ private:
     static void animation_task(void* pvParameters);
 
     static void update_image_callback(void* user_data);
+    void AttachRenderPmLock(lv_display_t* display);
+    static void OnRenderStart(lv_event_t* e);
+    static void OnRenderReady(lv_event_t* e);
 
     // --- 图片轮播动画所需的状态变量 (保持不变) ---
     const Animation* current_animation_ = nullptr;
@@ -56,6 +59,8 @@ private:
     
     
     bool is_programmatic_anim_active_ = false;
+    // 只在 LVGL 任务的渲染事件里读写：动画播放时每渲染一帧持有一次显示 PM 锁，帧之间释放
+    bool pm_lock_held_ = false;
 
     // 添加静态成员声明
     static ImageUpdateData left_eye_data_;
@@ -0,0 +1,150 @@
+#include "frame_rate_governor.h"
+#include "application.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_lvgl_port.h>
+
+#define TAG "FrameRateGovernor"
+
+// 等 LVGL 锁的上限，超时后由 LVGL 任务在渲染结束时应用
+#define LVGL_LOCK_TIMEOUT_MS 10
+
+constexpr int FrameRateGovernor::kProfilePeriodMs[];
+
+static const char* const PROFILE_NAMES[kFpsProfileCount] = {
+    "full",
+    "battery",
+    "idle",
+    "paused",
+};
+
+FrameRateGovernor::FrameRateGovernor() {
+    last_change_time_ = esp_timer_get_time();
+}
+
+void FrameRateGovernor::RegisterDisplay(lv_display_t* display) {
+    if (display == nullptr) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        displays_.push_back(display);
+    }
+    lv_display_add_event_cb(display, [](lv_event_t* e) {
+        auto self = static_cast<FrameRateGovernor*>(lv_event_get_user_data(e));
+        self->frames_[self->profile_].fetch_add(1, std::memory_order_relaxed);
+        // 在 LVGL 任务里，已经持有 LVGL 锁
+        self->ApplyPendingLocked();
+    }, LV_EVENT_RENDER_READY, this);
+}
+
+void FrameRateGovernor::OnDeviceStateChanged(int state) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_ = state == kDeviceStateIdle;
+        Update();
+    }
+    ApplyPending();
+}
+
+void FrameRateGovernor::SetBacklightOn(bool on) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        backlight_on_ = on;
+        Update();
+    }
+    ApplyPending(on);
+}
+
+void FrameRateGovernor::SetDischarging(bool discharging) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        discharging_ = discharging;
+        Update();
+    }
+    ApplyPending();
+}
+
+void FrameRateGovernor::Update() {
+    FpsProfile profile = kFpsProfileFull;
+    if (!backlight_on_) {
+        profile = kFpsProfilePaused;
+    } else if (idle_) {
+        profile = kFpsProfileIdle;
+    } else if (discharging_) {
+        profile = kFpsProfileBattery;
+    }
+    if (profile == profile_) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    residency_us_[profile_] += now - last_change_time_;
+    last_change_time_ = now;
+    pending_profile_.store(profile);
+    ESP_LOGI(TAG, "Frame rate profile %s -> %s (%d ms)", PROFILE_NAMES[profile_], PROFILE_NAMES[profile],
+        kProfilePeriodMs[profile]);
+    profile_ = profile;
+}
+
+void FrameRateGovernor::ApplyPending(bool wait) {
+    if (pending_profile_.load() < 0) {
+        return;
+    }
+    // 不持有 mutex_；LVGL 正在渲染时不等待，RENDER_READY 里会应用。
+    // 从暂停恢复时渲染已停，等不到 RENDER_READY，必须拿到锁（0 表示一直等）
+    if (!lvgl_port_lock(wait ? 0 : LVGL_LOCK_TIMEOUT_MS)) {
+        return;
+    }
+    ApplyPendingLocked();
+    lvgl_port_unlock();
+}
+
+void FrameRateGovernor::ApplyPendingLocked() {
+    int pending = pending_profile_.exchange(-1);
+    if (pending < 0) {
+        return;
+    }
+    auto profile = (FpsProfile)pending;
+    int period = kProfilePeriodMs[profile];
+    // 锁顺序固定为 LVGL 锁 -> mutex_，持有 mutex_ 的地方不再等 LVGL 锁
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto display : displays_) {
+        lv_timer_t* refr_timer = lv_display_get_refr_timer(display);
+        if (refr_timer != nullptr) {
+            lv_timer_set_period(refr_timer, period);
+            if (profile < applied_profile_) {
+                // 提高帧率时立即刷新，不等旧周期结束
+                lv_timer_ready(refr_timer);
+            }
+        }
+    }
+    lv_timer_t* anim_timer = lv_anim_get_timer();
+    if (anim_timer != nullptr) {
+        if (profile == kFpsProfilePaused) {
+            lv_timer_pause(anim_timer);
+        } else {
+            lv_timer_set_period(anim_timer, period);
+            lv_timer_resume(anim_timer);
+        }
+    }
+    applied_profile_ = profile;
+}
+
+std::string FrameRateGovernor::GetJson() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t now = esp_timer_get_time();
+    residency_us_[profile_] += now - last_change_time_;
+    last_change_time_ = now;
+
+    std::string json = "{\"profile\":\"" + std::string(PROFILE_NAMES[profile_]) + "\",\"profiles\":{";
+    for (int i = 0; i < kFpsProfileCount; i++) {
+        json += "\"" + std::string(PROFILE_NAMES[i]) + "\":{";
+        json += "\"ms\":" + std::to_string(residency_us_[i] / 1000) + ",";
+        json += "\"frames\":" + std::to_string(frames_[i].load(std::memory_order_relaxed)) + "},";
+    }
+    json.pop_back();
+    json += "}}";
+    return json;
+}
@@ -0,0 +1,77 @@
+#ifndef FRAME_RATE_GOVERNOR_H
+#define FRAME_RATE_GOVERNOR_H
+
+#include <lvgl.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum FpsProfile {
+    kFpsProfileFull,     // 对话等活跃状态，全帧率
+    kFpsProfileBattery,  // 电池供电，限制帧率
+    kFpsProfileIdle,     // 空闲状态，低帧率
+    kFpsProfilePaused,   // 背光关闭，暂停动画
+    kFpsProfileCount
+};
+
+/**
+ * @brief FrameRateGovernor 根据设备状态、背光和供电情况调整 LVGL 刷新和动画周期。
+ *
+ * 取优先级最高的限制：背光关闭 > 空闲 > 电池供电 > 全帧率。
+ * 切回全帧率时立即生效并触发一次刷新，保证唤醒后没有卡顿。
+ * 同时统计每个档位的停留时间和实际渲染帧数，配合 CpuSampler 对比调整前后的 CPU 占用。
+ *
+ * 调用方可能是 esp_timer 任务（背光渐变），不能等 LVGL 渲染完：档位切换只记下待应用的档位，
+ * 不持有 mutex_ 短时间尝试 LVGL 锁，拿不到就留给 LVGL 任务在下一帧渲染结束时应用。
+ * 背光点亮（从暂停恢复）时例外：暂停期间没有渲染，不会有下一帧，所以阻塞等 LVGL 锁。
+ * 点亮由 SetBrightness 的调用方触发，不在 esp_timer 任务里。
+ */
+class FrameRateGovernor {
+public:
+    static FrameRateGovernor& GetInstance() {
+        static FrameRateGovernor instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    FrameRateGovernor(const FrameRateGovernor&) = delete;
+    FrameRateGovernor& operator=(const FrameRateGovernor&) = delete;
+
+    void RegisterDisplay(lv_display_t* display);
+    void OnDeviceStateChanged(int state);
+    void SetBacklightOn(bool on);
+    void SetDischarging(bool discharging);
+
+    // 图片序列动画每帧的最小间隔
+    int GetMinFrameIntervalMs() const { return kProfilePeriodMs[profile_]; }
+    FpsProfile profile() const { return profile_; }
+
+    // {"profile":"idle","profiles":{"full":{"ms":1000,"frames":30},...}}
+    std::string GetJson();
+
+private:
+    FrameRateGovernor();
+    ~FrameRateGovernor() = default;
+
+    static constexpr int kProfilePeriodMs[kFpsProfileCount] = {33, 50, 100, 1000};
+
+    std::mutex mutex_;
+    std::vector<lv_display_t*> displays_;
+    bool idle_ = false;
+    bool backlight_on_ = true;
+    bool discharging_ = false;
+    volatile FpsProfile profile_ = kFpsProfileFull;
+
+    int64_t last_change_time_ = 0;
+    int64_t residency_us_[kFpsProfileCount] = {};
+    std::atomic<uint32_t> frames_[kFpsProfileCount] = {};
+    std::atomic<int> pending_profile_{-1};
+    FpsProfile applied_profile_ = kFpsProfileFull;  // 只在持有 LVGL 锁时访问
+
+    void Update();
+    void ApplyPending(bool wait = false);
+    void ApplyPendingLocked();
+};
+
+#endif // FRAME_RATE_GOVERNOR_H
@@ -7,9 +7,15 @@
 #include <esp_lvgl_port.h>
 #include "assets/lang_config.h"
 #include <cstring>
+#include <algorithm>
 #include "settings.h"
 
 #include "board.h"
+#include "metrics.h"
+#include "trace.h"
+#include "heap_tracker.h"
+#include "frame_rate_governor.h"
+#include "chat_text_view.h"
 
 #define TAG "LcdDisplay"
 
@@ -77,6 +83,23 @@ static const ThemeColors LIGHT_THEME = {
 // Current theme - initialize based on default config
 static ThemeColors current_theme = LIGHT_THEME;
 
+// 统计每一帧的渲染耗时并记录追踪事件，所有屏幕都在同一个 LVGL 任务里串行渲染
+static void AttachFrameTimeMetrics(lv_display_t* display) {
+    static int64_t render_start_time = 0;
+    lv_display_add_event_cb(display, [](lv_event_t* e) {
+        TRACE_BEGIN("lvgl_render");
+        // 渲染事件在 LVGL 任务中触发，顺便把该任务的分配记到 display
+        HeapTracker::SetTaskTag(kHeapTagDisplay);
+        render_start_time = esp_timer_get_time();
+    }, LV_EVENT_RENDER_START, nullptr);
+    lv_display_add_event_cb(display, [](lv_event_t* e) {
+        if (render_start_time != 0) {
+            Metrics::GetInstance().Observe(kMetricLvglFrameUs, (uint32_t)(esp_timer_get_time() - render_start_time));
+        }
+        TRACE_END("lvgl_render");
+    }, LV_EVENT_RENDER_READY, nullptr);
+}
+
 
 LV_FONT_DECLARE(font_awesome_30_4);
 
@@ -152,6 +175,8 @@ SpiLcdDisplay::SpiLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_h
     if (offset_x != 0 || offset_y != 0) {
         lv_display_set_offset(display_, offset_x, offset_y);
     }
+    AttachFrameTimeMetrics(display_);
+    FrameRateGovernor::GetInstance().RegisterDisplay(display_);
 
     // Update the theme
     if (current_theme_name_ == "dark") {
@@ -237,6 +262,8 @@ RgbLcdDisplay::RgbLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_h
     if (offset_x != 0 || offset_y != 0) {
         lv_display_set_offset(display_, offset_x, offset_y);
     }
+    AttachFrameTimeMetrics(display_);
+    FrameRateGovernor::GetInstance().RegisterDisplay(display_);
 
     // Update the theme
     if (current_theme_name_ == "dark") {
@@ -249,6 +276,8 @@ RgbLcdDisplay::RgbLcdDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_h
 }
 
 LcdDisplay::~LcdDisplay() {
+    // 先停掉文字视图的刷新定时器，它的 label 随 content_ 删除
+    chat_text_view_.reset();
     // 然后再清理 LVGL 对象
     if (content_ != nullptr) {
         lv_obj_del(content_);
@@ -605,12 +634,10 @@ void LcdDisplay::SetupUI() {
     lv_obj_set_style_text_color(emotion_label_, current_theme.text, 0);
     lv_label_set_text(emotion_label_, FONT_AWESOME_AI_CHIP);
 
-    chat_message_label_ = lv_label_create(content_);
-    lv_label_set_text(chat_message_label_, "");
-    lv_obj_set_width(chat_message_label_, LV_HOR_RES * 0.9); // 限制宽度为屏幕宽度的 90%
-    lv_label_set_long_mode(chat_message_label_, LV_LABEL_LONG_WRAP); // 设置为自动换行模式
-    lv_obj_set_style_text_align(chat_message_label_, LV_TEXT_ALIGN_CENTER, 0); // 设置文本居中对齐
-    lv_obj_set_style_text_color(chat_message_label_, current_theme.text, 0);
+    // 对话文字按行增量显示，最多占内容区一半高度，宽度为屏幕宽度的 90%
+    size_t chat_lines = std::max(1, (int)(LV_VER_RES / 2 / fonts_.text_font->line_height));
+    chat_text_view_ = std::make_unique<ChatTextView>(content_, fonts_.text_font, LV_HOR_RES * 0.9, chat_lines);
+    chat_text_view_->SetTextColor(current_theme.text);
 
     /* Status bar */
     lv_obj_set_flex_flow(status_bar_, LV_FLEX_FLOW_ROW);
@@ -897,8 +924,8 @@ void LcdDisplay::SetTheme(const std::string& theme_name) {
         }
 #else
         // Simple UI mode - just update the main chat message
-        if (chat_message_label_ != nullptr) {
-            lv_obj_set_style_text_color(chat_message_label_, current_theme.text, 0);
+        if (chat_text_view_ != nullptr) {
+            chat_text_view_->SetTextColor(current_theme.text);
         }
         
         if (emotion_label_ != nullptr) {
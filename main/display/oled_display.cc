@@ -1,6 +1,7 @@
 #include "oled_display.h"
 #include "font_awesome_symbols.h"
 #include "assets/lang_config.h"
+#include "frame_rate_governor.h"
 
 #include <string>
 #include <algorithm>
@@ -55,6 +56,7 @@ OledDisplay::OledDisplay(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_handl
         ESP_LOGE(TAG, "Failed to add display");
         return;
     }
+    FrameRateGovernor::GetInstance().RegisterDisplay(display_);
 
     if (height_ == 64) {
         SetupUI_128x64();
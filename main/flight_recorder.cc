@@ -0,0 +1,76 @@
+#include "flight_recorder.h"
+
+#include <esp_log.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+
+#define TAG "FlightRecorder"
+
+#define FLIGHT_RECORDER_MAGIC 0x464C5431 // "FLT1"
+#define FLIGHT_RECORDER_SIZE 128         // 必须是 2 的幂
+
+struct FlightLog {
+    uint32_t magic;
+    uint32_t boot_count;
+    uint32_t head;
+    uint32_t reserved;
+    FlightRecord records[FLIGHT_RECORDER_SIZE];
+};
+
+static RTC_NOINIT_ATTR FlightLog flight_log;
+
+FlightRecorder::FlightRecorder() {
+    auto reset_reason = esp_reset_reason();
+    bool valid = flight_log.magic == FLIGHT_RECORDER_MAGIC && reset_reason != ESP_RST_POWERON;
+    if (valid) {
+        // 复制上一次运行的记录，按时间顺序排列
+        uint32_t head = flight_log.head;
+        uint32_t count = head < FLIGHT_RECORDER_SIZE ? head : FLIGHT_RECORDER_SIZE;
+        previous_records_.reserve(count);
+        for (uint32_t i = head - count; i != head; i++) {
+            auto& record = flight_log.records[i & (FLIGHT_RECORDER_SIZE - 1)];
+            if (record.type != 0) {
+                previous_records_.push_back(record);
+            }
+        }
+        boot_count_ = flight_log.boot_count + 1;
+        previous_reset_reason_ = reset_reason;
+        ESP_LOGI(TAG, "Recovered %u records from previous boot, reset reason %d",
+            (unsigned)previous_records_.size(), reset_reason);
+    }
+
+    flight_log.magic = FLIGHT_RECORDER_MAGIC;
+    flight_log.boot_count = boot_count_;
+    flight_log.head = 0;
+    for (auto& record : flight_log.records) {
+        record.type = (FlightEventType)0;
+    }
+    Record(kFlightEventBoot, reset_reason);
+}
+
+void FlightRecorder::Record(FlightEventType type, uint8_t a, uint16_t b, uint32_t c) {
+    uint32_t index = __atomic_fetch_add(&flight_log.head, 1, __ATOMIC_RELAXED) & (FLIGHT_RECORDER_SIZE - 1);
+    auto& record = flight_log.records[index];
+    record.timestamp_ms = esp_timer_get_time() / 1000;
+    record.type = type;
+    record.a = a;
+    record.b = b;
+    record.c = c;
+}
+
+std::string FlightRecorder::GetPreviousBootJson() const {
+    std::string json = "{\"boot_count\":" + std::to_string(boot_count_) + ",";
+    json += "\"reset_reason\":" + std::to_string(previous_reset_reason_) + ",";
+    json += "\"records\":[";
+    char buffer[64];
+    for (auto& record : previous_records_) {
+        snprintf(buffer, sizeof(buffer), "[%lu,%u,%u,%u,%lu],", (unsigned long)record.timestamp_ms,
+            record.type, record.a, record.b, (unsigned long)record.c);
+        json += buffer;
+    }
+    if (json.back() == ',') {
+        json.pop_back();
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,61 @@
+#ifndef _FLIGHT_RECORDER_H_
+#define _FLIGHT_RECORDER_H_
+
+#include <esp_timer.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum FlightEventType : uint8_t {
+    kFlightEventBoot = 1,       // a: 复位原因
+    kFlightEventState,          // a: 旧状态, b: 新状态
+    kFlightEventChannelOpened,
+    kFlightEventChannelClosed,
+    kFlightEventNetworkError,
+    kFlightEventQueues,         // b: 解码队列长度, c: 后台任务数
+    kFlightEventHeap,           // b: 内部 RAM 最大空闲块 (KB), c: 内部 RAM 空闲
+    kFlightEventUpgrade,
+};
+
+struct FlightRecord {
+    uint32_t timestamp_ms;
+    FlightEventType type;
+    uint8_t a;
+    uint16_t b;
+    uint32_t c;
+};
+
+/*
+ * 飞行记录仪
+ * 记录保存在 RTC 慢速内存（RTC_NOINIT），软件复位、看门狗和 panic 后仍然保留，上电复位后清空。
+ * 写入只有一次原子自增和一次 12 字节拷贝，可以在生产固件中常开。
+ * 启动时把上一次运行的记录复制出来，等 CheckNewVersion 成功或音频通道打开后上报一次。
+ */
+class FlightRecorder {
+public:
+    static FlightRecorder& GetInstance() {
+        static FlightRecorder instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    void Record(FlightEventType type, uint8_t a = 0, uint16_t b = 0, uint32_t c = 0);
+
+    bool HasPreviousBoot() const { return !previous_records_.empty() && !previous_uploaded_; }
+    // {"boot_count":3,"reset_reason":4,"records":[[timestamp_ms,type,a,b,c],...]}
+    std::string GetPreviousBootJson() const;
+    void MarkPreviousBootUploaded() { previous_uploaded_ = true; }
+
+private:
+    FlightRecorder();
+
+    std::vector<FlightRecord> previous_records_;
+    uint32_t boot_count_ = 0;
+    int previous_reset_reason_ = 0;
+    bool previous_uploaded_ = false;
+};
+
+#endif // _FLIGHT_RECORDER_H_
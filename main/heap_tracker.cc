@@ -0,0 +1,200 @@
+#include "heap_tracker.h"
+
+#include <atomic>
+#include <cstdio>
+
+#ifdef ESP_PLATFORM
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <esp_attr.h>
+#else
+// 主机构建：scripts/heap_tracker 用 malloc 拦截代替 IDF 的分配钩子，标签放在线程局部变量里
+#include <chrono>
+#include <malloc.h>
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+
+static int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+#define TAG "HeapTracker"
+
+static const char* const HEAP_TAG_NAMES[] = {
+    "other",
+    "audio",
+    "protocol",
+    "display",
+    "iot",
+    "ota",
+};
+
+struct HeapTagStats {
+    std::atomic<uint32_t> alloc_count;
+    std::atomic<uint32_t> alloc_bytes;
+    std::atomic<uint32_t> free_count;
+};
+
+// 钩子可能在任意任务中调用，计数器放在 DRAM，不经过单例
+static DRAM_ATTR HeapTagStats heap_tag_stats[kHeapTagCount];
+
+#ifdef ESP_PLATFORM
+// 槽位 0 给 pthread 用，标签放在最后一个槽位
+static_assert(CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS >= 2, "HeapTracker needs a task local storage slot");
+static constexpr BaseType_t kTagSlot = CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS - 1;
+
+static inline IRAM_ATTR HeapTag CurrentTag() {
+    if (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING || xPortInIsrContext()) {
+        return kHeapTagOther;
+    }
+    auto tag = (uintptr_t)pvTaskGetThreadLocalStoragePointer(nullptr, kTagSlot);
+    return tag < kHeapTagCount ? (HeapTag)tag : kHeapTagOther;
+}
+#else
+// 平凡类型的 thread_local 不经过 malloc，拦截函数里可以安全读取
+static thread_local HeapTag current_tag = kHeapTagOther;
+
+static inline HeapTag CurrentTag() {
+    return current_tag;
+}
+#endif
+
+// 主机上由 scripts/heap_tracker/heap_interposer.cc 的 malloc/free 调用
+#if CONFIG_HEAP_USE_HOOKS || !defined(ESP_PLATFORM)
+extern "C" IRAM_ATTR void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    (void)caps;
+    if (ptr == nullptr) {
+        return;
+    }
+    auto& stats = heap_tag_stats[CurrentTag()];
+    stats.alloc_count.fetch_add(1, std::memory_order_relaxed);
+    stats.alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+extern "C" IRAM_ATTR void esp_heap_trace_free_hook(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    // 块已经释放，不能再查询大小
+    heap_tag_stats[CurrentTag()].free_count.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+void HeapTracker::SetTaskTag(HeapTag tag) {
+#ifdef ESP_PLATFORM
+    vTaskSetThreadLocalStoragePointer(nullptr, kTagSlot, (void*)(uintptr_t)tag);
+#else
+    current_tag = tag;
+#endif
+}
+
+HeapTag HeapTracker::GetTaskTag() {
+    return CurrentTag();
+}
+
+const char* HeapTracker::GetTagName(HeapTag tag) {
+    return tag < kHeapTagCount ? HEAP_TAG_NAMES[tag] : "unknown";
+}
+
+static uint16_t Fragmentation(uint32_t free_size, uint32_t largest_block) {
+    if (free_size == 0) {
+        return 0;
+    }
+    return 1000 - (uint16_t)((uint64_t)largest_block * 1000 / free_size);
+}
+
+HeapSample HeapTracker::TakeSample() const {
+    HeapSample sample;
+    sample.uptime_s = esp_timer_get_time() / 1000000;
+#ifdef ESP_PLATFORM
+    sample.free_internal = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    sample.largest_internal = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    sample.min_free_internal = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    sample.free_spiram = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    sample.largest_spiram = heap_caps_get_largest_free_block(MALLOC_CAP_SPIRAM);
+#else
+    // glibc 主分配区：空闲总量为 fordblks，顶部可归还的空闲块 keepcost 作为最大空闲块的下限，没有 PSRAM
+    auto info = mallinfo2();
+    sample.free_internal = info.fordblks;
+    sample.largest_internal = info.keepcost;
+    sample.min_free_internal = info.fordblks;
+    sample.free_spiram = 0;
+    sample.largest_spiram = 0;
+#endif
+    sample.frag_internal = Fragmentation(sample.free_internal, sample.largest_internal);
+    sample.frag_spiram = Fragmentation(sample.free_spiram, sample.largest_spiram);
+    return sample;
+}
+
+void HeapTracker::Tick(int sample_interval_s) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 分配风暴检测：统计最近一秒各子系统的分配次数
+    uint32_t total = 0;
+    int top_tag = 0;
+    uint32_t top_count = 0;
+    for (int i = 0; i < kHeapTagCount; i++) {
+        uint32_t count = heap_tag_stats[i].alloc_count.load(std::memory_order_relaxed);
+        uint32_t delta = count - last_alloc_count_[i];
+        last_alloc_count_[i] = count;
+        total += delta;
+        if (delta > top_count) {
+            top_count = delta;
+            top_tag = i;
+        }
+    }
+    if (total > kStormAllocsPerSecond) {
+        storm_count_++;
+        ESP_LOGW(TAG, "Allocation storm: %lu allocs in the last second, %lu from %s",
+            (unsigned long)total, (unsigned long)top_count, HEAP_TAG_NAMES[top_tag]);
+    }
+
+    if (++ticks_ < sample_interval_s) {
+        return;
+    }
+    ticks_ = 0;
+    history_[history_head_] = TakeSample();
+    history_head_ = (history_head_ + 1) % kHistorySize;
+    if (history_count_ < kHistorySize) {
+        history_count_++;
+    }
+}
+
+std::string HeapTracker::GetJson() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string json = "{\"tags\":{";
+    for (int i = 0; i < kHeapTagCount; i++) {
+        auto& stats = heap_tag_stats[i];
+        json += "\"" + std::string(HEAP_TAG_NAMES[i]) + "\":{";
+        json += "\"allocs\":" + std::to_string(stats.alloc_count.load(std::memory_order_relaxed)) + ",";
+        json += "\"alloc_bytes\":" + std::to_string(stats.alloc_bytes.load(std::memory_order_relaxed)) + ",";
+        json += "\"frees\":" + std::to_string(stats.free_count.load(std::memory_order_relaxed));
+        json += "},";
+    }
+    json.pop_back();
+    json += "},\"storms\":" + std::to_string(storm_count_) + ",\"history\":[";
+
+    // 按时间顺序输出：[uptime, free_internal, largest_internal, min_free_internal, free_spiram, largest_spiram, frag_internal, frag_spiram]
+    int start = (history_head_ - history_count_ + kHistorySize) % kHistorySize;
+    for (int i = 0; i < history_count_; i++) {
+        auto& sample = history_[(start + i) % kHistorySize];
+        char buffer[96];
+        snprintf(buffer, sizeof(buffer), "[%lu,%lu,%lu,%lu,%lu,%lu,%u,%u],",
+            (unsigned long)sample.uptime_s, (unsigned long)sample.free_internal, (unsigned long)sample.largest_internal,
+            (unsigned long)sample.min_free_internal, (unsigned long)sample.free_spiram, (unsigned long)sample.largest_spiram,
+            sample.frag_internal, sample.frag_spiram);
+        json += buffer;
+    }
+    if (json.back() == ',') {
+        json.pop_back();
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,90 @@
+#ifndef _HEAP_TRACKER_H_
+#define _HEAP_TRACKER_H_
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+enum HeapTag : uint8_t {
+    kHeapTagOther,
+    kHeapTagAudio,
+    kHeapTagProtocol,
+    kHeapTagDisplay,
+    kHeapTagIot,
+    kHeapTagOta,
+    kHeapTagCount
+};
+
+// 一次堆采样，碎片率 = 1 - 最大空闲块 / 空闲总量，单位为千分比
+struct HeapSample {
+    uint32_t uptime_s;
+    uint32_t free_internal;
+    uint32_t largest_internal;
+    uint32_t min_free_internal;
+    uint32_t free_spiram;
+    uint32_t largest_spiram;
+    uint16_t frag_internal;
+    uint16_t frag_spiram;
+};
+
+/*
+ * 堆使用跟踪
+ * - 按子系统统计分配次数与字节数：依赖 CONFIG_HEAP_USE_HOOKS 的分配钩子，
+ *   每次分配记入当前任务的标签（HeapTagScope 设置），释放同样记入释放时的标签。
+ *   释放钩子在块已经归还之后才调用，拿不到块大小，所以释放只统计次数。
+ * - 标签保存在 FreeRTOS 任务本地存储指针的最后一个槽位里，钩子在中断或调度器启动前
+ *   调用时不读取，直接记为 other。
+ * - 定时采样内部 RAM 和 PSRAM 的空闲量、最大空闲块和碎片率，保存在一个小环形缓冲区里。
+ * - 分配风暴检测：一个采样周期内的分配次数超过阈值时告警。
+ * - 不依赖 IDF 时（主机构建）标签放在线程局部变量里，分配统计由 scripts/heap_tracker 的
+ *   malloc 拦截调用同样的钩子，接口与设备上一致。
+ */
+class HeapTracker {
+public:
+    static HeapTracker& GetInstance() {
+        static HeapTracker instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    HeapTracker(const HeapTracker&) = delete;
+    HeapTracker& operator=(const HeapTracker&) = delete;
+
+    static void SetTaskTag(HeapTag tag);
+    static HeapTag GetTaskTag();
+    static const char* GetTagName(HeapTag tag);
+
+    // 每秒调用一次，检测分配风暴，每 interval 秒写入一条时间序列
+    void Tick(int sample_interval_s = 10);
+    HeapSample TakeSample() const;
+    std::string GetJson();
+
+private:
+    HeapTracker() = default;
+
+    static constexpr int kHistorySize = 32;
+    static constexpr uint32_t kStormAllocsPerSecond = 2000;
+
+    std::mutex mutex_;
+    uint32_t last_alloc_count_[kHeapTagCount] = {};
+    HeapSample history_[kHistorySize] = {};
+    int history_head_ = 0;
+    int history_count_ = 0;
+    int ticks_ = 0;
+    uint32_t storm_count_ = 0;
+};
+
+// 在作用域内把当前任务的分配记到指定子系统，退出时恢复
+class HeapTagScope {
+public:
+    explicit HeapTagScope(HeapTag tag) : previous_(HeapTracker::GetTaskTag()) {
+        HeapTracker::SetTaskTag(tag);
+    }
+    ~HeapTagScope() {
+        HeapTracker::SetTaskTag(previous_);
+    }
+
+private:
+    HeapTag previous_;
+};
+
+#endif // _HEAP_TRACKER_H_
@@ -0,0 +1,167 @@
+#include "command_executor.h"
+#include "heap_tracker.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+#include <algorithm>
+#include <exception>
+
+#define TAG "CommandExecutor"
+
+namespace iot {
+
+std::string CommandResult::ToJson() const {
+    auto root = cJSON_CreateObject();
+    if (!request_id.empty()) {
+        cJSON_AddStringToObject(root, "id", request_id.c_str());
+    }
+    cJSON_AddStringToObject(root, "name", thing.c_str());
+    cJSON_AddStringToObject(root, "method", method.c_str());
+    cJSON_AddStringToObject(root, "status", success ? "ok" : "error");
+    if (!message.empty()) {
+        cJSON_AddStringToObject(root, "message", message.c_str());
+    }
+    cJSON_AddNumberToObject(root, "queued_ms", queued_ms);
+    cJSON_AddNumberToObject(root, "duration_ms", duration_ms);
+    auto json_str = cJSON_PrintUnformatted(root);
+    std::string json(json_str);
+    cJSON_free(json_str);
+    cJSON_Delete(root);
+    return json;
+}
+
+CommandExecutor::CommandExecutor() : pool_(CONFIG_IOT_COMMAND_POOL_SIZE) {
+    free_.reserve(pool_.size());
+    pending_.reserve(pool_.size());
+    busy_things_.reserve(CONFIG_IOT_COMMAND_WORKERS);
+    for (auto& command : pool_) {
+        free_.push_back(&command);
+    }
+
+    workers_.resize(CONFIG_IOT_COMMAND_WORKERS);
+    for (size_t i = 0; i < workers_.size(); i++) {
+        xTaskCreate([](void* arg) {
+            static_cast<CommandExecutor*>(arg)->WorkerLoop();
+        }, "iot_worker", 4096, this, 2, &workers_[i]);
+    }
+}
+
+Command* CommandExecutor::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_.empty()) {
+        return nullptr;
+    }
+    auto command = free_.back();
+    free_.pop_back();
+    return command;
+}
+
+void CommandExecutor::Release(Command* command) {
+    // 只清掉引用，参数快照的存储留给下一条命令复用
+    command->thing = nullptr;
+    command->method = nullptr;
+    command->request_id.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(command);
+}
+
+void CommandExecutor::Submit(Command* command) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        command->sequence = next_sequence_++;
+        command->received_us = esp_timer_get_time();
+        pending_.push_back(command);
+    }
+    condition_variable_.notify_all();
+}
+
+void CommandExecutor::Reject(const std::string& request_id, const std::string& thing, const std::string& method,
+    const std::string& message) {
+    ESP_LOGE(TAG, "Rejected %s.%s: %s", thing.c_str(), method.c_str(), message.c_str());
+    CommandResult result;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        result.sequence = next_sequence_++;
+    }
+    result.request_id = request_id;
+    result.thing = thing;
+    result.method = method;
+    result.message = message;
+    Report(result);
+}
+
+void CommandExecutor::OnComplete(std::function<void(const CommandResult&)> callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    on_complete_ = callback;
+}
+
+void CommandExecutor::Report(const CommandResult& result) {
+    std::function<void(const CommandResult&)> callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback = on_complete_;
+    }
+    if (callback) {
+        callback(result);
+    }
+}
+
+Command* CommandExecutor::TakeRunnable() {
+    // 取最早的一条所属 Thing 空闲的命令；Thing 忙时它后面的命令都跳过，保证同一设备内的顺序
+    for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+        auto thing = (*it)->thing;
+        if (std::find(busy_things_.begin(), busy_things_.end(), thing) == busy_things_.end()) {
+            auto command = *it;
+            pending_.erase(it);
+            busy_things_.push_back(thing);
+            return command;
+        }
+    }
+    return nullptr;
+}
+
+void CommandExecutor::WorkerLoop() {
+    HeapTracker::SetTaskTag(kHeapTagIot);
+    while (true) {
+        Command* command = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_variable_.wait(lock, [this, &command]() {
+                command = TakeRunnable();
+                return command != nullptr;
+            });
+        }
+
+        CommandResult result;
+        result.sequence = command->sequence;
+        result.request_id = command->request_id;
+        result.thing = command->thing->name();
+        result.method = command->method->name();
+        int64_t start = esp_timer_get_time();
+        result.queued_ms = (start - command->received_us) / 1000;
+        try {
+            std::lock_guard<std::mutex> state_lock(command->thing->state_mutex());
+            command->method->Invoke(command->parameters);
+            result.success = true;
+        } catch (const std::exception& e) {
+            result.message = e.what();
+        }
+        result.duration_ms = (esp_timer_get_time() - start) / 1000;
+        ESP_LOGI(TAG, "#%lu %s.%s %s in %lu ms (queued %lu ms)", (unsigned long)result.sequence,
+            result.thing.c_str(), result.method.c_str(), result.success ? "done" : "failed",
+            (unsigned long)result.duration_ms, (unsigned long)result.queued_ms);
+
+        // 先放开这个 Thing，让它后面的命令可以开始，再回复结果
+        const Thing* thing = command->thing;
+        Release(command);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_things_.erase(std::find(busy_things_.begin(), busy_things_.end(), thing));
+        }
+        condition_variable_.notify_all();
+        Report(result);
+    }
+}
+
+} // namespace iot
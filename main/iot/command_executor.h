@@ -0,0 +1,89 @@
+#ifndef COMMAND_EXECUTOR_H
+#define COMMAND_EXECUTOR_H
+
+#include "thing.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace iot {
+
+// 一条命令的执行结果，回复给服务端
+struct CommandResult {
+    uint32_t sequence = 0;
+    std::string request_id;     // 服务端命令里的 id，没有时为空
+    std::string thing;
+    std::string method;
+    bool success = false;
+    std::string message;
+    uint32_t queued_ms = 0;     // 从收到到开始执行
+    uint32_t duration_ms = 0;   // 执行耗时
+
+    std::string ToJson() const;
+};
+
+// 池里的一条命令，参数是收到时的快照，之后的命令不会改写它
+struct Command {
+    uint32_t sequence = 0;
+    std::string request_id;
+    Thing* thing = nullptr;
+    const Method* method = nullptr;
+    ParameterList parameters;
+    int64_t received_us = 0;
+};
+
+/*
+ * IoT 命令执行器
+ * - 命令从固定大小的池里取，池和队列在构造时一次分配，执行期间不再申请队列内存。
+ * - CONFIG_IOT_COMMAND_WORKERS 个任务执行命令；同一个 Thing 的命令串行且保持顺序，
+ *   不同 Thing 的命令可以并行，慢方法（GPIO 时序、NVS 写入）不会阻塞主循环和其他设备。
+ * - 每条命令（包括解析失败的）都通过 OnComplete 回调报告结果，回调在执行任务里调用。
+ */
+class CommandExecutor {
+public:
+    static CommandExecutor& GetInstance() {
+        static CommandExecutor instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    CommandExecutor(const CommandExecutor&) = delete;
+    CommandExecutor& operator=(const CommandExecutor&) = delete;
+
+    // 从池里取一条命令，池空时返回 nullptr
+    Command* Acquire();
+    // 归还没有提交的命令
+    void Release(Command* command);
+    void Submit(Command* command);
+    // 命令没能进入队列时直接报告失败
+    void Reject(const std::string& request_id, const std::string& thing, const std::string& method,
+        const std::string& message);
+    void OnComplete(std::function<void(const CommandResult&)> callback);
+
+private:
+    CommandExecutor();
+    ~CommandExecutor() = default;
+
+    std::mutex mutex_;
+    std::condition_variable condition_variable_;
+    std::vector<Command> pool_;
+    std::vector<Command*> free_;
+    std::vector<Command*> pending_;         // 按收到的顺序
+    std::vector<const Thing*> busy_things_; // 正在执行命令的 Thing
+    std::function<void(const CommandResult&)> on_complete_;
+    uint32_t next_sequence_ = 1;
+    std::vector<TaskHandle_t> workers_;
+
+    Command* TakeRunnable();
+    void Report(const CommandResult& result);
+    void WorkerLoop();
+};
+
+} // namespace iot
+
+#endif // COMMAND_EXECUTOR_H
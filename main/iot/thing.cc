@@ -1,5 +1,4 @@
 #include "thing.h"
-#include "application.h"
 
 #include <esp_log.h>
 
@@ -37,40 +36,58 @@ std::string Thing::GetDescriptorJson() {
 }
 
 std::string Thing::GetStateJson() {
+    std::unique_lock<std::mutex> lock(state_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        // 命令完成后主循环会再发一次增量状态，这里先用上一次的结果
+        if (!last_state_json_.empty()) {
+            return last_state_json_;
+        }
+        lock.lock();
+    }
     std::string json_str = "{";
     json_str += "\"name\":\"" + name_ + "\",";
     json_str += "\"state\":" + properties_.GetStateJson();
     json_str += "}";
+    last_state_json_ = json_str;
     return json_str;
 }
 
-void Thing::Invoke(const cJSON* command) {
+bool Thing::ParseCommand(const cJSON* command, const Method*& method, ParameterList& parameters, std::string& error) const {
     auto method_name = cJSON_GetObjectItem(command, "method");
     auto input_params = cJSON_GetObjectItem(command, "parameters");
+    if (!cJSON_IsString(method_name)) {
+        error = "Method name is missing";
+        return false;
+    }
+    method = methods_.Find(method_name->valuestring);
+    if (method == nullptr) {
+        error = std::string("Method not found: ") + method_name->valuestring;
+        return false;
+    }
 
-    try {
-        auto& method = methods_[method_name->valuestring];
-        for (auto& param : method.parameters()) {
-            auto input_param = cJSON_GetObjectItem(input_params, param.name().c_str());
-            if (param.required() && input_param == nullptr) {
-                throw std::runtime_error("Parameter " + param.name() + " is required");
-            }
-            if (param.type() == kValueTypeNumber) {
-                param.set_number(input_param->valueint);
-            } else if (param.type() == kValueTypeString) {
-                param.set_string(input_param->valuestring);
-            } else if (param.type() == kValueTypeBoolean) {
-                param.set_boolean(input_param->valueint == 1);
+    // 先从方法定义拷贝一份参数表，再填入本次的值；池里的快照复用之前的存储
+    parameters = method->parameters();
+    for (auto& param : parameters) {
+        auto input_param = cJSON_GetObjectItem(input_params, param.name().c_str());
+        if (input_param == nullptr) {
+            if (param.required()) {
+                error = "Parameter " + param.name() + " is required";
+                return false;
             }
+            continue;
+        }
+        if (param.type() == kValueTypeNumber && cJSON_IsNumber(input_param)) {
+            param.set_number(input_param->valueint);
+        } else if (param.type() == kValueTypeString && cJSON_IsString(input_param)) {
+            param.set_string(input_param->valuestring);
+        } else if (param.type() == kValueTypeBoolean && (cJSON_IsBool(input_param) || cJSON_IsNumber(input_param))) {
+            param.set_boolean(cJSON_IsTrue(input_param) || input_param->valueint == 1);
+        } else {
+            error = "Parameter " + param.name() + " has the wrong type";
+            return false;
         }
-
-        Application::GetInstance().Schedule([&method]() {
-            method.Invoke();
-        });
-    } catch (const std::runtime_error& e) {
-        ESP_LOGE(TAG, "Method not found: %s", method_name->valuestring);
-        return;
     }
+    return true;
 }
 
 
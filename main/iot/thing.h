@@ -5,9 +5,12 @@
 #include <map>
 #include <functional>
 #include <vector>
+#include <mutex>
 #include <stdexcept>
 #include <cJSON.h>
 
+#include "assets/keywords.h"
+
 namespace iot {
 
 enum ValueType {
@@ -125,8 +128,8 @@ private:
     std::string description_;
     ValueType type_;
     bool required_;
-    bool boolean_;
-    int number_;
+    bool boolean_ = false;
+    int number_ = 0;
     std::string string_;
 
 public:
@@ -184,6 +187,8 @@ public:
     // iterator
     auto begin() { return parameters_.begin(); }
     auto end() { return parameters_.end(); }
+    auto begin() const { return parameters_.begin(); }
+    auto end() const { return parameters_.end(); }
 
     std::string GetDescriptorJson() {
         std::string json_str = "{";
@@ -201,17 +206,19 @@ public:
 class Method {
 private:
     std::string name_;
+    Keys::IotMethod::Id id_;
     std::string description_;
     ParameterList parameters_;
     std::function<void(const ParameterList&)> callback_;
 
 public:
     Method(const std::string& name, const std::string& description, const ParameterList& parameters, std::function<void(const ParameterList&)> callback) :
-        name_(name), description_(description), parameters_(parameters), callback_(callback) {}
+        name_(name), id_(Keys::IotMethod::Lookup(name)), description_(description), parameters_(parameters), callback_(callback) {}
 
     const std::string& name() const { return name_; }
+    Keys::IotMethod::Id id() const { return id_; }
     const std::string& description() const { return description_; }
-    ParameterList& parameters() { return parameters_; }
+    const ParameterList& parameters() const { return parameters_; }
 
     std::string GetDescriptorJson() {
         std::string json_str = "{";
@@ -221,8 +228,9 @@ public:
         return json_str;
     }
 
-    void Invoke() {
-        callback_(parameters_);
+    // parameters 是本次调用的参数快照，方法定义里的 parameters_ 只作为模板
+    void Invoke(const ParameterList& parameters) const {
+        callback_(parameters);
     }
 };
 
@@ -238,13 +246,23 @@ public:
         methods_.push_back(Method(name, description, parameters, callback));
     }
 
-    Method& operator[](const std::string& name) {
+    const Method* Find(const std::string& name) const {
+        // keywords.json 里有的方法名只比较编号，其余按名字比较
+        auto id = Keys::IotMethod::Lookup(name);
         for (auto& method : methods_) {
-            if (method.name() == name) {
-                return method;
+            if (id != Keys::IotMethod::kUnknown ? method.id() == id : method.name() == name) {
+                return &method;
             }
         }
-        throw std::runtime_error("Method not found: " + name);
+        return nullptr;
+    }
+
+    const Method& operator[](const std::string& name) const {
+        auto method = Find(name);
+        if (method == nullptr) {
+            throw std::runtime_error("Method not found: " + name);
+        }
+        return *method;
     }
 
     std::string GetDescriptorJson() {
@@ -267,11 +285,15 @@ public:
     virtual ~Thing() = default;
 
     virtual std::string GetDescriptorJson();
+    // 方法正在执行时不等待，返回上一次读到的状态。只由 ThingManager 在持有它的锁时调用
     virtual std::string GetStateJson();
-    virtual void Invoke(const cJSON* command);
+    // 解析服务端命令，把参数拷贝到 parameters 快照里，不修改方法定义；失败时 error 给出原因
+    bool ParseCommand(const cJSON* command, const Method*& method, ParameterList& parameters, std::string& error) const;
 
     const std::string& name() const { return name_; }
     const std::string& description() const { return description_; }
+    // 方法在命令执行任务里运行，属性在读取状态的任务里求值，两者用这把锁互斥
+    std::mutex& state_mutex() { return state_mutex_; }
 
 protected:
     PropertyList properties_;
@@ -280,6 +302,8 @@ protected:
 private:
     std::string name_;
     std::string description_;
+    std::mutex state_mutex_;
+    std::string last_state_json_;
 };
 
 
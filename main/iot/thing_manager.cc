@@ -1,4 +1,6 @@
 #include "thing_manager.h"
+#include "command_executor.h"
+#include "heap_tracker.h"
 
 #include <esp_log.h>
 
@@ -23,6 +25,7 @@ std::string ThingManager::GetDescriptorsJson() {
 }
 
 bool ThingManager::GetStatesJson(std::string& json, bool delta) {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (!delta) {
         last_states_.clear();
     }
@@ -51,15 +54,48 @@ bool ThingManager::GetStatesJson(std::string& json, bool delta) {
 }
 
 void ThingManager::Invoke(const cJSON* command) {
+    HeapTagScope heap_tag(kHeapTagIot);
+    auto& executor = CommandExecutor::GetInstance();
     auto name = cJSON_GetObjectItem(command, "name");
-    ESP_LOGI(TAG, "Invoking command for thing: %s", name->valuestring);
+    auto method_name = cJSON_GetObjectItem(command, "method");
+    auto id = cJSON_GetObjectItem(command, "id");
+    std::string request_id;
+    if (cJSON_IsString(id)) {
+        request_id = id->valuestring;
+    } else if (cJSON_IsNumber(id)) {
+        request_id = std::to_string(id->valueint);
+    }
+    std::string thing_name = cJSON_IsString(name) ? name->valuestring : "";
+    std::string method = cJSON_IsString(method_name) ? method_name->valuestring : "";
+    ESP_LOGI(TAG, "Invoking command for thing: %s", thing_name.c_str());
+
+    Thing* target = nullptr;
     for (auto& thing : things_) {
-        if (thing->name() == name->valuestring) {
-            thing->Invoke(command);
-            return;
+        if (thing->name() == thing_name) {
+            target = thing;
+            break;
         }
     }
-    ESP_LOGE(TAG, "Thing not found: %s", name->valuestring);
+    if (target == nullptr) {
+        executor.Reject(request_id, thing_name, method, "Thing not found");
+        return;
+    }
+
+    // 参数在调用方的任务里（协议接收任务或按键回调）解析成快照，执行交给命令执行器
+    auto item = executor.Acquire();
+    if (item == nullptr) {
+        executor.Reject(request_id, thing_name, method, "Too many pending commands");
+        return;
+    }
+    std::string error;
+    if (!target->ParseCommand(command, item->method, item->parameters, error)) {
+        executor.Release(item);
+        executor.Reject(request_id, thing_name, method, error);
+        return;
+    }
+    item->thing = target;
+    item->request_id = request_id;
+    executor.Submit(item);
 }
 
 } // namespace iot
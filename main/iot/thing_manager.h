@@ -10,6 +10,7 @@
 #include <memory>
 #include <functional>
 #include <map>
+#include <mutex>
 
 namespace iot {
 
@@ -33,6 +34,8 @@ private:
     ~ThingManager() = default;
 
     std::vector<Thing*> things_;
+    // 状态在主循环和通道打开回调（可能在唤醒上传或预连接任务里）读取
+    std::mutex mutex_;
     std::map<std::string, std::string> last_states_;
 };
 
@@ -1,11 +1,11 @@
 #include "circular_strip.h"
 #include "application.h"
 #include <esp_log.h>
+#include <algorithm>
+#include <cstdlib>
 
 #define TAG "CircularStrip"
 
-#define BLINK_INFINITE -1
-
 CircularStrip::CircularStrip(gpio_num_t gpio, uint8_t max_leds) : max_leds_(max_leds) {
     // If the gpio is not connected, you should use NoLed class
     assert(gpio != GPIO_NUM_NC);
@@ -26,11 +26,7 @@ CircularStrip::CircularStrip(gpio_num_t gpio, uint8_t max_leds) : max_leds_(max_
 
     esp_timer_create_args_t strip_timer_args = {
         .callback = [](void *arg) {
-            auto strip = static_cast<CircularStrip*>(arg);
-            std::lock_guard<std::mutex> lock(strip->mutex_);
-            if (strip->strip_callback_ != nullptr) {
-                strip->strip_callback_();
-            }
+            static_cast<CircularStrip*>(arg)->OnFrame();
         },
         .arg = this,
         .dispatch_method = ESP_TIMER_TASK,
@@ -48,132 +44,131 @@ CircularStrip::~CircularStrip() {
 }
 
 
-void CircularStrip::SetAllColor(StripColor color) {
+void CircularStrip::Show(const std::vector<StripColor>& colors) {
+    // 先写完整个缓冲区再做一次 RMT 传输，内容没有变化时不传输
+    bool changed = false;
+    for (int i = 0; i < max_leds_; i++) {
+        if (colors[i] != colors_[i]) {
+            colors_[i] = colors[i];
+            led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
+            changed = true;
+        }
+    }
+    if (changed) {
+        led_strip_refresh(led_strip_);
+    }
+}
+
+void CircularStrip::OnFrame() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (engine_.effect_type() == kLedEffectLevel) {
+        uint8_t peak = AudioLevelMeter::GetInstance().TakePeak(level_channel_);
+#if CONFIG_USE_AUDIO_PROCESSOR
+        // 没有检测到人声时不跟随底噪
+        if (level_channel_ == kAudioLevelInput && !Application::GetInstance().IsVoiceDetected()) {
+            peak = 0;
+        }
+#endif
+        engine_.SetLevel(level_follower_.Next(peak));
+    }
+    if (engine_.Step()) {
+        Show(engine_.frame());
+    }
+    if (engine_.finished()) {
+        esp_timer_stop(strip_timer_);
+    }
+}
+
+void CircularStrip::PlayEffect(const LedEffect& effect) {
+    if (led_strip_ == nullptr) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mutex_);
     esp_timer_stop(strip_timer_);
-    for (int i = 0; i < max_leds_; i++) {
-        colors_[i] = color;
-        led_strip_set_pixel(led_strip_, i, color.red, color.green, color.blue);
+    engine_.Start(effect, colors_);
+    // 第一帧立即显示，静态效果不需要启动定时器
+    if (engine_.Step()) {
+        Show(engine_.frame());
+    }
+    if (!engine_.finished()) {
+        esp_timer_start_periodic(strip_timer_, LedEffectEngine::kFrameMs * 1000);
+    }
+}
+
+void CircularStrip::ShowLevel(AudioLevelChannel channel, StripColor low, StripColor high) {
+    LedEffect effect;
+    effect.type = kLedEffectLevel;
+    effect.low = low;
+    effect.high = high;
+    {
+        // OnFrame 在定时器任务里持有 mutex_ 读取 level_channel_
+        std::lock_guard<std::mutex> lock(mutex_);
+        level_channel_ = channel;
+        // 丢掉切换之前积累的峰值
+        AudioLevelMeter::GetInstance().TakePeak(channel);
     }
-    led_strip_refresh(led_strip_);
+    PlayEffect(effect);
+}
+
+void CircularStrip::SetAllColor(StripColor color) {
+    LedEffect effect;
+    effect.type = kLedEffectSolid;
+    effect.high = color;
+    PlayEffect(effect);
 }
 
 void CircularStrip::SetSingleColor(uint8_t index, StripColor color) {
     std::lock_guard<std::mutex> lock(mutex_);
     esp_timer_stop(strip_timer_);
-    colors_[index] = color;
-    led_strip_set_pixel(led_strip_, index, color.red, color.green, color.blue);
-    led_strip_refresh(led_strip_);
+    auto colors = colors_;
+    colors[index] = color;
+    Show(colors);
 }
 
 void CircularStrip::Blink(StripColor color, int interval_ms) {
-    for (int i = 0; i < max_leds_; i++) {
-        colors_[i] = color;
-    }
-    StartStripTask(interval_ms, [this]() {
-        static bool on = true;
-        if (on) {
-            for (int i = 0; i < max_leds_; i++) {
-                led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
-            }
-            led_strip_refresh(led_strip_);
-        } else {
-            led_strip_clear(led_strip_);
-        }
-        on = !on;
-    });
+    LedEffect effect;
+    effect.type = kLedEffectBlink;
+    effect.high = color;
+    effect.period_ms = std::min(interval_ms * 2, 65535);
+    PlayEffect(effect);
 }
 
 void CircularStrip::FadeOut(int interval_ms) {
-    StartStripTask(interval_ms, [this]() {
-        bool all_off = true;
-        for (int i = 0; i < max_leds_; i++) {
-            colors_[i].red /= 2;
-            colors_[i].green /= 2;
-            colors_[i].blue /= 2;
-            if (colors_[i].red != 0 || colors_[i].green != 0 || colors_[i].blue != 0) {
-                all_off = false;
-            }
-            led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
-        }
-        if (all_off) {
-            led_strip_clear(led_strip_);
-            esp_timer_stop(strip_timer_);
-        } else {
-            led_strip_refresh(led_strip_);
-        }
-    });
+    LedEffect effect;
+    effect.type = kLedEffectFadeOut;
+    effect.period_ms = std::min(interval_ms, 65535);
+    PlayEffect(effect);
 }
 
 void CircularStrip::Breathe(StripColor low, StripColor high, int interval_ms) {
-    StartStripTask(interval_ms, [this, low, high]() {
-        static bool increase = true;
-        static StripColor color = low;
-        if (increase) {
-            if (color.red < high.red) {
-                color.red++;
-            }
-            if (color.green < high.green) {
-                color.green++;
-            }
-            if (color.blue < high.blue) {
-                color.blue++;
-            }
-            if (color.red == high.red && color.green == high.green && color.blue == high.blue) {
-                increase = false;
-            }
-        } else {
-            if (color.red > low.red) {
-                color.red--;
-            }
-            if (color.green > low.green) {
-                color.green--;
-            }
-            if (color.blue > low.blue) {
-                color.blue--;
-            }
-            if (color.red == low.red && color.green == low.green && color.blue == low.blue) {
-                increase = true;
-            }
-        }
-        for (int i = 0; i < max_leds_; i++) {
-            led_strip_set_pixel(led_strip_, i, color.red, color.green, color.blue);
-        }
-        led_strip_refresh(led_strip_);
-    });
+    // 与逐级加减的旧实现保持相同的周期：每个 interval 变化一级
+    int steps = std::max({abs(high.red - low.red), abs(high.green - low.green), abs(high.blue - low.blue), 1});
+    LedEffect effect;
+    effect.type = kLedEffectBreathe;
+    effect.low = low;
+    effect.high = high;
+    effect.period_ms = std::min(2 * steps * interval_ms, 65535);
+    PlayEffect(effect);
 }
 
 void CircularStrip::Scroll(StripColor low, StripColor high, int length, int interval_ms) {
-    for (int i = 0; i < max_leds_; i++) {
-        colors_[i] = low;
-    }
-    StartStripTask(interval_ms, [this, low, high, length]() {
-        static int offset = 0;
-        for (int i = 0; i < max_leds_; i++) {
-            colors_[i] = low;
-        }
-        for (int j = 0; j < length; j++) {
-            int i = (offset + j) % max_leds_;
-            colors_[i] = high;
-        }
-        for (int i = 0; i < max_leds_; i++) {
-            led_strip_set_pixel(led_strip_, i, colors_[i].red, colors_[i].green, colors_[i].blue);
-        }
-        led_strip_refresh(led_strip_);
-        offset = (offset + 1) % max_leds_;
-    });
+    LedEffect effect;
+    effect.type = kLedEffectScroll;
+    effect.low = low;
+    effect.high = high;
+    effect.length = length;
+    effect.period_ms = std::min(max_leds_ * interval_ms, 65535);
+    PlayEffect(effect);
 }
 
-void CircularStrip::StartStripTask(int interval_ms, std::function<void()> cb) {
-    if (led_strip_ == nullptr) {
-        return;
-    }
-
-    std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(strip_timer_);
-    
-    strip_callback_ = cb;
-    esp_timer_start_periodic(strip_timer_, interval_ms * 1000);
+void CircularStrip::Rainbow(StripColor low, StripColor high, int interval_ms) {
+    LedEffect effect;
+    effect.type = kLedEffectRainbow;
+    effect.low = low;
+    effect.high = high;
+    effect.period_ms = std::min(256 * interval_ms, 65535);
+    PlayEffect(effect);
 }
 
 void CircularStrip::SetBrightness(uint8_t default_brightness, uint8_t low_brightness) {
@@ -206,13 +201,15 @@ void CircularStrip::OnStateChanged() {
             break;
         }
         case kDeviceStateListening: {
-            StripColor color = { default_brightness_, low_brightness_, low_brightness_ };
-            SetAllColor(color);
+            StripColor low = { low_brightness_, 0, 0 };
+            StripColor high = { default_brightness_, low_brightness_, low_brightness_ };
+            ShowLevel(kAudioLevelInput, low, high);
             break;
         }
         case kDeviceStateSpeaking: {
-            StripColor color = { low_brightness_, default_brightness_, low_brightness_ };
-            SetAllColor(color);
+            StripColor low = { 0, low_brightness_, 0 };
+            StripColor high = { low_brightness_, default_brightness_, low_brightness_ };
+            ShowLevel(kAudioLevelOutput, low, high);
             break;
         }
         case kDeviceStateUpgrading: {
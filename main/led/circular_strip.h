@@ -2,6 +2,8 @@
 #define _CIRCULAR_STRIP_H_
 
 #include "led.h"
+#include "led_effect.h"
+#include "audio_level_meter.h"
 #include <driver/gpio.h>
 #include <led_strip.h>
 #include <esp_timer.h>
@@ -12,10 +14,6 @@
 #define DEFAULT_BRIGHTNESS 32
 #define LOW_BRIGHTNESS 4
 
-struct StripColor {
-    uint8_t red = 0, green = 0, blue = 0;
-};
-
 class CircularStrip : public Led {
 public:
     CircularStrip(gpio_num_t gpio, uint8_t max_leds);
@@ -28,22 +26,26 @@ public:
     void Blink(StripColor color, int interval_ms);
     void Breathe(StripColor low, StripColor high, int interval_ms);
     void Scroll(StripColor low, StripColor high, int length, int interval_ms);
+    void PlayEffect(const LedEffect& effect);
+    // 按固定帧率显示麦克风或 TTS 的电平
+    void ShowLevel(AudioLevelChannel channel, StripColor low, StripColor high);
 
 private:
     std::mutex mutex_;
     TaskHandle_t blink_task_ = nullptr;
     led_strip_handle_t led_strip_ = nullptr;
     int max_leds_ = 0;
-    std::vector<StripColor> colors_;
-    int blink_counter_ = 0;
-    int blink_interval_ms_ = 0;
+    std::vector<StripColor> colors_;    // 当前显示的颜色
     esp_timer_handle_t strip_timer_ = nullptr;
-    std::function<void()> strip_callback_ = nullptr;
+    LedEffectEngine engine_;
+    AudioLevelChannel level_channel_ = kAudioLevelInput;
+    AudioLevelFollower level_follower_;
 
     uint8_t default_brightness_ = DEFAULT_BRIGHTNESS;
     uint8_t low_brightness_ = LOW_BRIGHTNESS;
 
-    void StartStripTask(int interval_ms, std::function<void()> cb);
+    void OnFrame();
+    void Show(const std::vector<StripColor>& colors);
     void Rainbow(StripColor low, StripColor high, int interval_ms);
     void FadeOut(int interval_ms);
 };
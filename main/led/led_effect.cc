@@ -0,0 +1,207 @@
+#include "led_effect.h"
+
+#include <algorithm>
+
+// v 不超过 255 * 255 时等于 round(v / 255)
+static inline uint8_t Div255(uint32_t v) {
+    v += 128;
+    return (uint8_t)((v + (v >> 8)) >> 8);
+}
+
+static inline uint8_t MixChannel(uint8_t low, uint8_t high, uint8_t level) {
+    if (high >= low) {
+        return low + Div255((uint32_t)(high - low) * level);
+    }
+    return low - Div255((uint32_t)(low - high) * level);
+}
+
+StripColor LedEffectEngine::Mix(StripColor low, StripColor high, uint8_t level) {
+    return {
+        MixChannel(low.red, high.red, level),
+        MixChannel(low.green, high.green, level),
+        MixChannel(low.blue, high.blue, level),
+    };
+}
+
+const StripColor* LedEffectEngine::ColorWheel() {
+    // 256 个色相的满亮度颜色，首次使用时生成
+    static StripColor wheel[256];
+    static bool ready = false;
+    if (!ready) {
+        for (int i = 0; i < 256; i++) {
+            int sector = i / 86;
+            uint8_t rise = (uint8_t)((i - sector * 86) * 3);
+            uint8_t fall = 255 - rise;
+            switch (sector) {
+                case 0: wheel[i] = { fall, rise, 0 }; break;
+                case 1: wheel[i] = { 0, fall, rise }; break;
+                default: wheel[i] = { rise, 0, fall }; break;
+            }
+        }
+        ready = true;
+    }
+    return wheel;
+}
+
+void LedEffectEngine::Start(const LedEffect& effect, const std::vector<StripColor>& current) {
+    effect_ = effect;
+    if (effect_.period_ms == 0) {
+        effect_.period_ms = kFrameMs;
+    }
+    uint32_t period = effect_.period_ms;
+    frame_.assign(current.size(), StripColor());
+    base_.clear();
+    keyframes_.clear();
+    periodic_ = true;
+
+    switch (effect_.type) {
+        case kLedEffectSolid:
+            keyframes_ = { {0, 255} };
+            periodic_ = false;
+            break;
+        case kLedEffectBlink:
+            // 亮灭各半个周期，同一时刻的两个关键帧表示跳变
+            keyframes_ = { {0, 255}, {period / 2, 255}, {period / 2, 0}, {period, 0} };
+            break;
+        case kLedEffectBreathe:
+            keyframes_ = { {0, 0}, {period / 2, 255}, {period, 0} };
+            break;
+        case kLedEffectScroll:
+        case kLedEffectRainbow:
+        case kLedEffectLevel:
+            // 位置由时间或电平直接算出，不需要亮度关键帧
+            keyframes_ = { {0, 255}, {period, 255} };
+            break;
+        case kLedEffectFadeOut: {
+            // 每个周期亮度减半，关键帧之间线性插值
+            base_ = current;
+            uint8_t level = 255;
+            uint32_t time_ms = 0;
+            while (level > 0) {
+                keyframes_.push_back({time_ms, level});
+                level /= 2;
+                time_ms += period;
+            }
+            keyframes_.push_back({time_ms, 0});
+            periodic_ = false;
+            break;
+        }
+    }
+
+    duration_ms_ = keyframes_.back().time_ms;
+    cursor_ = 0;
+    frame_index_ = 0;
+    time_ms_ = 0;
+    first_frame_ = true;
+    finished_ = false;
+}
+
+uint8_t LedEffectEngine::LevelAt(uint32_t time_ms) {
+    if (time_ms < keyframes_[cursor_].time_ms) {
+        cursor_ = 0;
+    }
+    while (cursor_ + 1 < keyframes_.size() && keyframes_[cursor_ + 1].time_ms <= time_ms) {
+        cursor_++;
+    }
+    const Keyframe& a = keyframes_[cursor_];
+    if (cursor_ + 1 >= keyframes_.size()) {
+        return a.level;
+    }
+    const Keyframe& b = keyframes_[cursor_ + 1];
+    // Q16 定点插值
+    uint32_t fraction = ((time_ms - a.time_ms) << 16) / (b.time_ms - a.time_ms);
+    int32_t delta = (int32_t)b.level - a.level;
+    return (uint8_t)(a.level + ((delta * (int32_t)fraction + 32768) >> 16));
+}
+
+void LedEffectEngine::Render(uint32_t time_ms, std::vector<StripColor>& out) {
+    int count = out.size();
+    if (count == 0) {
+        return;
+    }
+    uint32_t period = effect_.period_ms;
+
+    switch (effect_.type) {
+        case kLedEffectScroll: {
+            // 亮灯窗口的起点，Q8 表示的灯珠位置；窗口两端的灯按覆盖比例部分点亮
+            uint32_t span = (uint32_t)count << 8;
+            uint32_t head = (uint32_t)(((uint64_t)time_ms * span) / period);
+            uint32_t window = (uint32_t)std::min<int>(effect_.length, count) << 8;
+            for (int i = 0; i < count; i++) {
+                uint32_t start = ((uint32_t)i << 8) + span - head;
+                start %= span;
+                // 灯珠 i 覆盖 [start, start + 256)，窗口覆盖 [0, window) 以及回绕后的 [span, span + window)
+                uint32_t covered = 0;
+                uint32_t end = start + 256;
+                if (start < window) {
+                    covered += std::min(end, window) - start;
+                }
+                if (end > span) {
+                    covered += std::min(end - span, window);
+                }
+                uint8_t level = (uint8_t)std::min<uint32_t>(covered, 255);
+                out[i] = Mix(effect_.low, effect_.high, level);
+            }
+            break;
+        }
+        case kLedEffectRainbow: {
+            const StripColor* wheel = ColorWheel();
+            uint8_t brightness = std::max({effect_.high.red, effect_.high.green, effect_.high.blue});
+            uint32_t shift = (time_ms << 8) / period;
+            for (int i = 0; i < count; i++) {
+                uint8_t hue = (uint8_t)(((uint32_t)i * 256 / count + shift) & 0xFF);
+                out[i] = { Div255(wheel[hue].red * brightness), Div255(wheel[hue].green * brightness),
+                    Div255(wheel[hue].blue * brightness) };
+            }
+            break;
+        }
+        case kLedEffectLevel: {
+            // 点亮的长度为 level * count / 255，最后一颗灯按小数部分部分点亮
+            uint32_t lit = ((uint32_t)level_ * count * 256 + 127) / 255;
+            for (int i = 0; i < count; i++) {
+                uint32_t start = (uint32_t)i << 8;
+                uint32_t covered = lit > start ? std::min<uint32_t>(lit - start, 255) : 0;
+                out[i] = Mix(effect_.low, effect_.high, (uint8_t)covered);
+            }
+            break;
+        }
+        case kLedEffectFadeOut: {
+            uint8_t level = LevelAt(time_ms);
+            for (int i = 0; i < count; i++) {
+                out[i] = Mix(StripColor(), base_[i], level);
+            }
+            break;
+        }
+        default: {
+            StripColor color = Mix(effect_.low, effect_.high, LevelAt(time_ms));
+            std::fill(out.begin(), out.end(), color);
+            break;
+        }
+    }
+}
+
+bool LedEffectEngine::Step() {
+    if (finished_) {
+        return false;
+    }
+    uint32_t time_ms = time_ms_;
+    if (!periodic_ && time_ms >= duration_ms_) {
+        time_ms = duration_ms_;
+        finished_ = true;
+    }
+    frame_index_++;
+    time_ms_ += kFrameMs;
+    if (periodic_ && duration_ms_ > 0) {
+        time_ms_ %= duration_ms_;
+    }
+
+    // 先渲染到临时帧再比较，内容不变就不需要刷新
+    next_.resize(frame_.size());
+    Render(time_ms, next_);
+    bool changed = first_frame_ || !std::equal(next_.begin(), next_.end(), frame_.begin());
+    first_frame_ = false;
+    if (changed) {
+        frame_.swap(next_);
+    }
+    return changed;
+}
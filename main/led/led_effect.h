@@ -0,0 +1,90 @@
+#ifndef _LED_EFFECT_H_
+#define _LED_EFFECT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct StripColor {
+    uint8_t red = 0, green = 0, blue = 0;
+};
+
+inline bool operator==(const StripColor& a, const StripColor& b) {
+    return a.red == b.red && a.green == b.green && a.blue == b.blue;
+}
+
+inline bool operator!=(const StripColor& a, const StripColor& b) {
+    return !(a == b);
+}
+
+enum LedEffectType : uint8_t {
+    kLedEffectSolid,
+    kLedEffectBlink,
+    kLedEffectBreathe,
+    kLedEffectScroll,
+    kLedEffectRainbow,
+    kLedEffectFadeOut,
+    kLedEffectLevel,            // 电平表：按 SetLevel() 的值从第一颗灯开始点亮
+};
+
+// 灯效描述，纯数据；切换设备状态只需要换一条描述
+struct LedEffect {
+    LedEffectType type = kLedEffectSolid;
+    StripColor low;             // Rainbow 不使用 low，high 的最大分量作为亮度
+    StripColor high;
+    uint16_t period_ms = 1000;  // 一个循环的时长，FadeOut 为亮度减半的间隔
+    uint8_t length = 1;         // Scroll 的亮灯数量
+};
+
+/**
+ * @brief LedEffectEngine 灯效引擎，不依赖 ESP-IDF，可以在主机上编译（scripts/led_effects）。
+ *
+ * Start() 把效果编译成关键帧表（时间 -> 0~255 的亮度），Step() 每帧按定点数在关键帧之间插值，
+ * 再在 low/high 两种颜色之间混合。Step() 返回这一帧是否与上一帧不同，调用者据此跳过刷新；
+ * 非循环的效果（常亮、淡出结束）播放完后 finished() 为 true，可以停掉定时器。
+ */
+class LedEffectEngine {
+public:
+    static constexpr int kFrameMs = 20;
+
+    // current: 当前显示的颜色，FadeOut 从这里开始淡出
+    void Start(const LedEffect& effect, const std::vector<StripColor>& current);
+    bool Step();
+    // 0~255，kLedEffectLevel 使用，在 Step() 之前设置
+    void SetLevel(uint8_t level) { level_ = level; }
+
+    bool finished() const { return finished_; }
+    LedEffectType effect_type() const { return effect_.type; }
+    int frame_index() const { return frame_index_; }
+    const std::vector<StripColor>& frame() const { return frame_; }
+
+    // 0~255 的混合系数，low + (high - low) * level / 255，结果精确舍入
+    static StripColor Mix(StripColor low, StripColor high, uint8_t level);
+
+private:
+    struct Keyframe {
+        uint32_t time_ms;
+        uint8_t level;
+    };
+
+    LedEffect effect_;
+    std::vector<Keyframe> keyframes_;
+    std::vector<StripColor> base_;      // FadeOut 的起始颜色
+    std::vector<StripColor> frame_;
+    std::vector<StripColor> next_;
+    uint32_t duration_ms_ = 0;
+    bool periodic_ = false;
+    bool finished_ = true;
+    bool first_frame_ = true;
+    int frame_index_ = 0;
+    uint32_t time_ms_ = 0;
+    uint8_t level_ = 0;
+    size_t cursor_ = 0;                 // 当前所在的关键帧区间，时间单调前进时不需要重新查找
+
+    static const StripColor* ColorWheel();
+
+    uint8_t LevelAt(uint32_t time_ms);
+    void Render(uint32_t time_ms, std::vector<StripColor>& out);
+};
+
+#endif // _LED_EFFECT_H_
@@ -38,10 +38,23 @@ SingleLed::SingleLed(gpio_num_t gpio) {
         .skip_unhandled_events = false,
     };
     ESP_ERROR_CHECK(esp_timer_create(&blink_timer_args, &blink_timer_));
+
+    esp_timer_create_args_t level_timer_args = {
+        .callback = [](void *arg) {
+            auto led = static_cast<SingleLed*>(arg);
+            led->OnLevelTimer();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "led_level_timer",
+        .skip_unhandled_events = true,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&level_timer_args, &level_timer_));
 }
 
 SingleLed::~SingleLed() {
     esp_timer_stop(blink_timer_);
+    esp_timer_stop(level_timer_);
     if (led_strip_ != nullptr) {
         led_strip_del(led_strip_);
     }
@@ -60,7 +73,7 @@ void SingleLed::TurnOn() {
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(blink_timer_);
+    StopTimers();
     led_strip_set_pixel(led_strip_, 0, r_, g_, b_);
     led_strip_refresh(led_strip_);
 }
@@ -71,7 +84,7 @@ void SingleLed::TurnOff() {
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(blink_timer_);
+    StopTimers();
     led_strip_clear(led_strip_);
 }
 
@@ -93,7 +106,7 @@ void SingleLed::StartBlinkTask(int times, int interval_ms) {
     }
 
     std::lock_guard<std::mutex> lock(mutex_);
-    esp_timer_stop(blink_timer_);
+    StopTimers();
     
     blink_counter_ = times * 2;
     blink_interval_ms_ = interval_ms;
@@ -115,6 +128,45 @@ void SingleLed::OnBlinkTimer() {
     }
 }
 
+void SingleLed::StopTimers() {
+    esp_timer_stop(blink_timer_);
+    esp_timer_stop(level_timer_);
+}
+
+void SingleLed::ShowLevel(AudioLevelChannel channel, StripColor low, StripColor high) {
+    if (led_strip_ == nullptr) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    StopTimers();
+    level_channel_ = channel;
+    level_low_ = low;
+    level_high_ = high;
+    level_color_ = low;
+    // 丢掉切换之前积累的峰值
+    AudioLevelMeter::GetInstance().TakePeak(channel);
+    led_strip_set_pixel(led_strip_, 0, low.red, low.green, low.blue);
+    led_strip_refresh(led_strip_);
+    esp_timer_start_periodic(level_timer_, LedEffectEngine::kFrameMs * 1000);
+}
+
+void SingleLed::OnLevelTimer() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint8_t peak = AudioLevelMeter::GetInstance().TakePeak(level_channel_);
+#if CONFIG_USE_AUDIO_PROCESSOR
+    // 没有检测到人声时不跟随底噪
+    if (level_channel_ == kAudioLevelInput && !Application::GetInstance().IsVoiceDetected()) {
+        peak = 0;
+    }
+#endif
+    auto color = LedEffectEngine::Mix(level_low_, level_high_, level_follower_.Next(peak));
+    if (color != level_color_) {
+        level_color_ = color;
+        led_strip_set_pixel(led_strip_, 0, color.red, color.green, color.blue);
+        led_strip_refresh(led_strip_);
+    }
+}
 
 void SingleLed::OnStateChanged() {
     auto& app = Application::GetInstance();
@@ -136,16 +188,10 @@ void SingleLed::OnStateChanged() {
             TurnOn();
             break;
         case kDeviceStateListening:
-            if (app.IsVoiceDetected()) {
-                SetColor(HIGH_BRIGHTNESS, 0, 0);
-            } else {
-                SetColor(LOW_BRIGHTNESS, 0, 0);
-            }
-            TurnOn();
+            ShowLevel(kAudioLevelInput, { LOW_BRIGHTNESS, 0, 0 }, { HIGH_BRIGHTNESS, 0, 0 });
             break;
         case kDeviceStateSpeaking:
-            SetColor(0, DEFAULT_BRIGHTNESS, 0);
-            TurnOn();
+            ShowLevel(kAudioLevelOutput, { 0, LOW_BRIGHTNESS, 0 }, { 0, HIGH_BRIGHTNESS, 0 });
             break;
         case kDeviceStateUpgrading:
             SetColor(0, DEFAULT_BRIGHTNESS, 0);
@@ -2,6 +2,8 @@
 #define _SINGLE_LED_H_
 
 #include "led.h"
+#include "led_effect.h"
+#include "audio_level_meter.h"
 #include <driver/gpio.h>
 #include <led_strip.h>
 #include <esp_timer.h>
@@ -23,9 +25,17 @@ private:
     int blink_counter_ = 0;
     int blink_interval_ms_ = 0;
     esp_timer_handle_t blink_timer_ = nullptr;
+    esp_timer_handle_t level_timer_ = nullptr;
+    AudioLevelChannel level_channel_ = kAudioLevelInput;
+    AudioLevelFollower level_follower_;
+    StripColor level_low_;
+    StripColor level_high_;
+    StripColor level_color_;
 
     void StartBlinkTask(int times, int interval_ms);
     void OnBlinkTimer();
+    void OnLevelTimer();
+    void StopTimers();
 
     void BlinkOnce();
     void Blink(int times, int interval_ms);
@@ -33,6 +43,8 @@ private:
     void TurnOn();
     void TurnOff();
     void SetColor(uint8_t r, uint8_t g, uint8_t b);
+    // 亮度随麦克风或 TTS 电平在 low 和 high 之间变化
+    void ShowLevel(AudioLevelChannel channel, StripColor low, StripColor high);
 };
 
 #endif // _SINGLE_LED_H_
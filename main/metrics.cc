@@ -0,0 +1,82 @@
+#include "metrics.h"
+
+#include <esp_heap_caps.h>
+#include <cstring>
+
+constexpr uint32_t Metrics::kBucketBounds[];
+
+void Metrics::Observe(MetricHistogram histogram, uint32_t value_us) {
+    auto& h = histograms_[histogram];
+    int bucket = 0;
+    while (bucket < METRICS_HISTOGRAM_BUCKETS - 1 && value_us > kBucketBounds[bucket]) {
+        bucket++;
+    }
+    h.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    h.count.fetch_add(1, std::memory_order_relaxed);
+    h.sum_us.fetch_add(value_us, std::memory_order_relaxed);
+
+    uint32_t max_us = h.max_us.load(std::memory_order_relaxed);
+    while (value_us > max_us &&
+           !h.max_us.compare_exchange_weak(max_us, value_us, std::memory_order_relaxed)) {
+    }
+}
+
+void Metrics::SampleHeap() {
+    SetGauge(kMetricFreeInternalHeap, heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    SetGauge(kMetricMinFreeInternalHeap, heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    SetGauge(kMetricLargestInternalBlock, heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    SetGauge(kMetricFreeSpiramHeap, heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+}
+
+void Metrics::FoldSums() {
+    std::lock_guard<std::mutex> lock(fold_mutex_);
+    for (auto& h : histograms_) {
+        h.total_us += h.sum_us.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+static inline void PutU32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(value & 0xFF);
+    out.push_back((value >> 8) & 0xFF);
+    out.push_back((value >> 16) & 0xFF);
+    out.push_back((value >> 24) & 0xFF);
+}
+
+static inline void PutU64(std::vector<uint8_t>& out, uint64_t value) {
+    PutU32(out, (uint32_t)value);
+    PutU32(out, (uint32_t)(value >> 32));
+}
+
+std::vector<uint8_t> Metrics::Snapshot() {
+    std::vector<uint8_t> out;
+    out.reserve(12 + kMetricCounterCount * 4 + kMetricGaugeCount * 4 +
+        kMetricHistogramCount * (4 + METRICS_HISTOGRAM_BUCKETS) * 4);
+
+    out.push_back(METRICS_SNAPSHOT_MAGIC);
+    out.push_back(METRICS_SNAPSHOT_VERSION);
+    out.push_back(kMetricCounterCount);
+    out.push_back(kMetricGaugeCount);
+    out.push_back(kMetricHistogramCount);
+    out.push_back(METRICS_HISTOGRAM_BUCKETS);
+    out.push_back(0);
+    out.push_back(0);
+    PutU32(out, (uint32_t)(esp_timer_get_time() / 1000000));
+
+    for (auto& counter : counters_) {
+        PutU32(out, counter.load(std::memory_order_relaxed));
+    }
+    for (auto& gauge : gauges_) {
+        PutU32(out, (uint32_t)gauge.load(std::memory_order_relaxed));
+    }
+    std::lock_guard<std::mutex> lock(fold_mutex_);
+    for (auto& h : histograms_) {
+        PutU32(out, h.count.load(std::memory_order_relaxed));
+        h.total_us += h.sum_us.exchange(0, std::memory_order_relaxed);
+        PutU64(out, h.total_us);
+        PutU32(out, h.max_us.load(std::memory_order_relaxed));
+        for (auto& bucket : h.buckets) {
+            PutU32(out, bucket.load(std::memory_order_relaxed));
+        }
+    }
+    return out;
+}
@@ -0,0 +1,130 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <esp_timer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// 计数器：单调递增，服务端按两次快照的差值计算速率
+enum MetricCounter {
+    kMetricAudioPacketsSent,
+    kMetricAudioPacketsReceived,
+    kMetricAudioPacketsDropped,
+    kMetricOpusDecodeErrors,
+    kMetricTlsHandshakes,
+    kMetricTlsResumed,
+    kMetricCounterCount
+};
+
+// 仪表：记录最近一次的取值
+enum MetricGauge {
+    kMetricDecodeQueueDepth,
+    kMetricBackgroundTasks,
+    kMetricFreeInternalHeap,
+    kMetricMinFreeInternalHeap,
+    kMetricLargestInternalBlock,
+    kMetricFreeSpiramHeap,
+    kMetricGaugeCount
+};
+
+// 延迟直方图，单位为微秒
+enum MetricHistogram {
+    kMetricOpusEncodeUs,
+    kMetricOpusDecodeUs,
+    kMetricSendAudioUs,
+    kMetricAfeFetchWaitUs,      // 等待 AFE 输出的阻塞时间，不是处理耗时
+    kMetricLvglFrameUs,
+    kMetricWakeToListenUs,
+    kMetricTlsHandshakeUs,
+    kMetricCaptureToFeedUs,
+    kMetricBeamformUs,
+    kMetricWakeConnectUs,       // 唤醒到音频通道打开
+    kMetricWakeUploadUs,        // 唤醒到唤醒词和桥接音频全部发出
+    kMetricWakeHandoffGapUs,    // 桥接音频交接给实时采集时丢失的音频时长
+    kMetricTtsTailUs,           // 收到 tts stop 到最后一段语音播完
+    kMetricTurnaroundUs,        // 最后一段语音播完到麦克风重新打开
+    kMetricHistogramCount
+};
+
+#define METRICS_SNAPSHOT_MAGIC 'M'
+#define METRICS_SNAPSHOT_VERSION 2
+#define METRICS_HISTOGRAM_BUCKETS 11
+
+/*
+ * 运行指标注册表
+ * 所有写入均为 relaxed 原子操作，可以在音频/显示等热路径以及任意任务中调用，不需要加锁。
+ *
+ * 快照格式（小端）：
+ *   u8 magic 'M' | u8 version | u8 counters | u8 gauges | u8 histograms | u8 buckets | u16 reserved
+ *   u32 uptime_s
+ *   u32 counter[counters]
+ *   i32 gauge[gauges]
+ *   histograms 个 { u32 count | u64 sum_us | u32 max_us | u32 bucket[buckets] }
+ * sum_us 为 64 位，高频直方图（每 32ms 一次）的累计值用 32 位一个多小时就会回绕。
+ * Xtensa 上 64 位原子量不是无锁的，热路径只累加 32 位，FoldSums 定期（每 10 秒和每次快照）
+ * 把 32 位累计值取走并加到 64 位总和上，两次之间的累计值远小于 2^32 微秒。
+ * 直方图桶的上界见 Metrics::kBucketBounds，最后一个桶为溢出桶。
+ */
+class Metrics {
+public:
+    static Metrics& GetInstance() {
+        static Metrics instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    static constexpr uint32_t kBucketBounds[METRICS_HISTOGRAM_BUCKETS - 1] = {
+        500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000
+    };
+
+    inline void Increment(MetricCounter counter, uint32_t value = 1) {
+        counters_[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+    inline void SetGauge(MetricGauge gauge, int32_t value) {
+        gauges_[gauge].store(value, std::memory_order_relaxed);
+    }
+    void Observe(MetricHistogram histogram, uint32_t value_us);
+
+    // 采样堆信息到仪表
+    void SampleHeap();
+    // 把直方图的 32 位累计值并入 64 位总和，至少每小时调用一次（Snapshot 也会并入）
+    void FoldSums();
+    std::vector<uint8_t> Snapshot();
+
+private:
+    Metrics() = default;
+
+    struct Histogram {
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> sum_us{0};    // 上次 FoldSums 之后的累计值
+        std::atomic<uint32_t> max_us{0};
+        uint64_t total_us = 0;              // 已并入的累计值，持有 fold_mutex_ 访问
+        std::atomic<uint32_t> buckets[METRICS_HISTOGRAM_BUCKETS] = {};
+    };
+
+    std::atomic<uint32_t> counters_[kMetricCounterCount] = {};
+    std::atomic<int32_t> gauges_[kMetricGaugeCount] = {};
+    Histogram histograms_[kMetricHistogramCount];
+    std::mutex fold_mutex_;
+};
+
+// 作用域计时，析构时把耗时写入直方图
+class MetricsTimer {
+public:
+    explicit MetricsTimer(MetricHistogram histogram)
+        : histogram_(histogram), start_time_(esp_timer_get_time()) {}
+    ~MetricsTimer() {
+        Metrics::GetInstance().Observe(histogram_, (uint32_t)(esp_timer_get_time() - start_time_));
+    }
+
+private:
+    MetricHistogram histogram_;
+    int64_t start_time_;
+};
+
+#endif // _METRICS_H_
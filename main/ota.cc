@@ -1,6 +1,7 @@
 #include "ota.h"
 #include "system_info.h"
 #include "settings.h"
+#include "heap_tracker.h"
 #include "assets/lang_config.h"
 
 #include <cJSON.h>
@@ -70,6 +71,7 @@ Http* Ota::SetupHttp() {
 }
 
 bool Ota::CheckVersion() {
+    HeapTagScope heap_tag(kHeapTagOta);
     auto& board = Board::GetInstance();
     auto app_desc = esp_app_get_description();
 
@@ -219,6 +221,7 @@ void Ota::MarkCurrentVersionValid() {
 }
 
 void Ota::Upgrade(const std::string& firmware_url) {
+    HeapTagScope heap_tag(kHeapTagOta);
     ESP_LOGI(TAG, "Upgrading firmware from %s", firmware_url.c_str());
     esp_ota_handle_t update_handle = 0;
     auto update_partition = esp_ota_get_next_update_partition(NULL);
@@ -0,0 +1,401 @@
+#include "control_codec.h"
+#include "assets/keywords.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static_assert(Keys::ControlWord::kCount <= 128, "control words must fit in the 7-bit word tag");
+
+enum ControlTag : uint8_t {
+    kTagEnd = 0x00,
+    kTagFalse = 0x01,
+    kTagTrue = 0x02,
+    kTagNull = 0x03,
+    kTagInt = 0x04,
+    kTagDouble = 0x05,
+    kTagString = 0x06,
+    kTagObject = 0x08,
+    kTagArray = 0x09,
+    kTagWord = 0x80,
+};
+
+static constexpr int kMaxDepth = 16;
+
+ControlWriter::ControlWriter(bool binary) : binary_(binary) {
+    data_.reserve(128);
+    if (binary_) {
+        data_.push_back((char)kControlFrameMagic);
+        data_.push_back((char)kControlFrameVersion);
+    }
+}
+
+void ControlWriter::BeginValue() {
+    if (binary_) {
+        return;
+    }
+    if (after_key_) {
+        after_key_ = false;
+    } else if (depth_ > 0) {
+        if (has_items_ & (1u << depth_)) {
+            data_.push_back(',');
+        }
+        has_items_ |= 1u << depth_;
+    }
+}
+
+void ControlWriter::Push() {
+    depth_++;
+    has_items_ &= ~(1u << depth_);
+}
+
+void ControlWriter::Pop() {
+    depth_--;
+}
+
+ControlWriter& ControlWriter::BeginObject() {
+    BeginValue();
+    data_.push_back(binary_ ? (char)kTagObject : '{');
+    Push();
+    return *this;
+}
+
+ControlWriter& ControlWriter::EndObject() {
+    Pop();
+    data_.push_back(binary_ ? (char)kTagEnd : '}');
+    return *this;
+}
+
+ControlWriter& ControlWriter::BeginArray() {
+    BeginValue();
+    data_.push_back(binary_ ? (char)kTagArray : '[');
+    Push();
+    return *this;
+}
+
+ControlWriter& ControlWriter::EndArray() {
+    Pop();
+    data_.push_back(binary_ ? (char)kTagEnd : ']');
+    return *this;
+}
+
+ControlWriter& ControlWriter::Key(std::string_view key) {
+    if (binary_) {
+        WriteTlvString(key);
+        return *this;
+    }
+    BeginValue();
+    WriteJsonString(key);
+    data_.push_back(':');
+    after_key_ = true;
+    return *this;
+}
+
+ControlWriter& ControlWriter::String(std::string_view value) {
+    BeginValue();
+    if (binary_) {
+        WriteTlvString(value);
+    } else {
+        WriteJsonString(value);
+    }
+    return *this;
+}
+
+ControlWriter& ControlWriter::Int(int64_t value) {
+    BeginValue();
+    if (binary_) {
+        data_.push_back((char)kTagInt);
+        WriteVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+    } else {
+        data_ += std::to_string(value);
+    }
+    return *this;
+}
+
+ControlWriter& ControlWriter::Double(double value) {
+    BeginValue();
+    if (binary_) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        data_.push_back((char)kTagDouble);
+        for (int i = 0; i < 8; i++) {
+            data_.push_back((char)(bits >> (i * 8)));
+        }
+    } else {
+        // 和 cJSON 一样先试 15 位有效数字，不能还原时用 17 位
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "%1.15g", value);
+        if (strtod(buffer, nullptr) != value) {
+            snprintf(buffer, sizeof(buffer), "%1.17g", value);
+        }
+        data_ += buffer;
+    }
+    return *this;
+}
+
+ControlWriter& ControlWriter::Bool(bool value) {
+    BeginValue();
+    if (binary_) {
+        data_.push_back((char)(value ? kTagTrue : kTagFalse));
+    } else {
+        data_ += value ? "true" : "false";
+    }
+    return *this;
+}
+
+ControlWriter& ControlWriter::Null() {
+    BeginValue();
+    if (binary_) {
+        data_.push_back((char)kTagNull);
+    } else {
+        data_ += "null";
+    }
+    return *this;
+}
+
+ControlWriter& ControlWriter::Value(const cJSON* item) {
+    if (cJSON_IsObject(item)) {
+        BeginObject();
+        for (auto child = item->child; child != nullptr; child = child->next) {
+            Key(child->string != nullptr ? child->string : "");
+            Value(child);
+        }
+        EndObject();
+    } else if (cJSON_IsArray(item)) {
+        BeginArray();
+        for (auto child = item->child; child != nullptr; child = child->next) {
+            Value(child);
+        }
+        EndArray();
+    } else if (cJSON_IsString(item)) {
+        String(item->valuestring);
+    } else if (cJSON_IsNumber(item)) {
+        double value = item->valuedouble;
+        if (std::fabs(value) < 9.0e15 && value == (double)(int64_t)value) {
+            Int((int64_t)value);
+        } else {
+            Double(value);
+        }
+    } else if (cJSON_IsBool(item)) {
+        Bool(cJSON_IsTrue(item));
+    } else {
+        Null();
+    }
+    return *this;
+}
+
+bool ControlWriter::Json(const std::string& json) {
+    if (!binary_) {
+        BeginValue();
+        data_ += json;
+        return true;
+    }
+    cJSON* root = cJSON_Parse(json.c_str());
+    if (root == nullptr) {
+        return false;
+    }
+    Value(root);
+    cJSON_Delete(root);
+    return true;
+}
+
+void ControlWriter::WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+        data_.push_back((char)(value | 0x80));
+        value >>= 7;
+    }
+    data_.push_back((char)value);
+}
+
+void ControlWriter::WriteTlvString(std::string_view text) {
+    auto id = Keys::ControlWord::Lookup(text);
+    if (id != Keys::ControlWord::kUnknown) {
+        data_.push_back((char)(kTagWord | id));
+        return;
+    }
+    data_.push_back((char)kTagString);
+    WriteVarint(text.size());
+    data_.append(text.data(), text.size());
+}
+
+void ControlWriter::WriteJsonString(std::string_view text) {
+    data_.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': data_ += "\\\""; break;
+            case '\\': data_ += "\\\\"; break;
+            case '\n': data_ += "\\n"; break;
+            case '\r': data_ += "\\r"; break;
+            case '\t': data_ += "\\t"; break;
+            default:
+                if ((uint8_t)c < 0x20) {
+                    char escaped[8];
+                    snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+                    data_ += escaped;
+                } else {
+                    data_.push_back(c);
+                }
+                break;
+        }
+    }
+    data_.push_back('"');
+}
+
+namespace {
+
+class ControlReader {
+public:
+    ControlReader(const uint8_t* data, size_t size) : p_(data), end_(data + size) {}
+
+    cJSON* ReadValue(int depth) {
+        uint8_t tag;
+        if (!ReadByte(tag)) {
+            return nullptr;
+        }
+        return ReadValue(tag, depth);
+    }
+
+    bool AtEnd() const { return p_ == end_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    std::string text_;
+
+    bool ReadByte(uint8_t& value) {
+        if (p_ == end_) {
+            return false;
+        }
+        value = *p_++;
+        return true;
+    }
+
+    bool ReadVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!ReadByte(byte)) {
+                return false;
+            }
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 读出字符串或词典词，返回以 NUL 结尾的指针（词典词直接指向常量，不拷贝）
+    const char* ReadText(uint8_t tag) {
+        if (tag & kTagWord) {
+            uint8_t id = tag & 0x7F;
+            if (id == Keys::ControlWord::kUnknown || id >= Keys::ControlWord::kCount) {
+                return nullptr;
+            }
+            return Keys::ControlWord::kNames[id].data();
+        }
+        uint64_t size;
+        if (tag != kTagString || !ReadVarint(size) || size > (uint64_t)(end_ - p_)) {
+            return nullptr;
+        }
+        text_.assign(reinterpret_cast<const char*>(p_), size);
+        p_ += size;
+        return text_.c_str();
+    }
+
+    cJSON* ReadValue(uint8_t tag, int depth) {
+        switch (tag) {
+            case kTagFalse:
+                return cJSON_CreateFalse();
+            case kTagTrue:
+                return cJSON_CreateTrue();
+            case kTagNull:
+                return cJSON_CreateNull();
+            case kTagInt: {
+                uint64_t zigzag;
+                if (!ReadVarint(zigzag)) {
+                    return nullptr;
+                }
+                int64_t value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+                return cJSON_CreateNumber((double)value);
+            }
+            case kTagDouble: {
+                if (end_ - p_ < 8) {
+                    return nullptr;
+                }
+                uint64_t bits = 0;
+                for (int i = 0; i < 8; i++) {
+                    bits |= (uint64_t)p_[i] << (i * 8);
+                }
+                p_ += 8;
+                double value;
+                memcpy(&value, &bits, sizeof(value));
+                return cJSON_CreateNumber(value);
+            }
+            case kTagObject:
+            case kTagArray:
+                return depth < kMaxDepth ? ReadContainer(tag == kTagObject, depth + 1) : nullptr;
+            default: {
+                auto text = ReadText(tag);
+                return text != nullptr ? cJSON_CreateString(text) : nullptr;
+            }
+        }
+    }
+
+    cJSON* ReadContainer(bool object, int depth) {
+        cJSON* container = object ? cJSON_CreateObject() : cJSON_CreateArray();
+        while (true) {
+            uint8_t tag;
+            if (!ReadByte(tag)) {
+                break;
+            }
+            if (tag == kTagEnd) {
+                return container;
+            }
+            // 词典里的键是常量，直接引用；其他键在读值之前拷出来
+            const char* key = nullptr;
+            bool constant_key = false;
+            std::string key_copy;
+            if (object) {
+                key = ReadText(tag);
+                constant_key = tag & kTagWord;
+                if (key == nullptr || !ReadByte(tag)) {
+                    break;
+                }
+                if (!constant_key) {
+                    key_copy = key;
+                    key = key_copy.c_str();
+                }
+            }
+            cJSON* item = ReadValue(tag, depth);
+            if (item == nullptr) {
+                break;
+            }
+            if (!object) {
+                cJSON_AddItemToArray(container, item);
+            } else if (constant_key) {
+                cJSON_AddItemToObjectCS(container, key, item);
+            } else {
+                cJSON_AddItemToObject(container, key, item);
+            }
+        }
+        cJSON_Delete(container);
+        return nullptr;
+    }
+};
+
+} // namespace
+
+cJSON* DecodeControlFrame(const void* data, size_t size) {
+    if (!IsControlFrame(data, size)) {
+        return nullptr;
+    }
+    ControlReader reader(static_cast<const uint8_t*>(data) + 2, size - 2);
+    cJSON* root = reader.ReadValue(0);
+    if (root != nullptr && !reader.AtEnd()) {
+        cJSON_Delete(root);
+        return nullptr;
+    }
+    return root;
+}
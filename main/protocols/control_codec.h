@@ -0,0 +1,76 @@
+#ifndef CONTROL_CODEC_H
+#define CONTROL_CODEC_H
+
+#include <cJSON.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/*
+ * 控制消息编码
+ * - JSON：原来的文本帧，没有协商时一直使用。
+ * - TLV（"tlv1"）：客户端 hello 里带 "control":["tlv1"]，服务端 hello 回 "control":"tlv1" 后，双方的控制消息
+ *   都改用二进制帧：0xFF、版本号 1，后面是一个值。0xFF 作为 Opus TOC 带立体声标志，协商的音频都是单声道，
+ *   所以和音频帧共用 websocket 二进制帧时不会混淆。
+ *
+ * 值的编码（一个标记字节 + 数据）：
+ *   0x00 对象/数组结束    0x01 false    0x02 true    0x03 null
+ *   0x04 整数，zigzag varint          0x05 double，8 字节小端
+ *   0x06 字符串，varint 长度 + UTF-8  0x08 对象，键值交替，0x00 结束    0x09 数组，0x00 结束
+ *   0x80 | id  词典里的字符串（键或值），id 是 Keys::ControlWord 的编号
+ * 词典由 main/assets/keywords.json 的 ControlWord 组生成，编号就是协议的一部分，只能在末尾追加。
+ * scripts/control_codec.py 是同一格式的 Python 实现，用于服务端和字节数对比。
+ */
+constexpr uint8_t kControlFrameMagic = 0xFF;
+constexpr uint8_t kControlFrameVersion = 1;
+constexpr const char* kControlEncodingTlv = "tlv1";
+
+// 同一套调用按协商结果写出 JSON 文本或 TLV 帧
+class ControlWriter {
+public:
+    explicit ControlWriter(bool binary);
+
+    ControlWriter& BeginObject();
+    ControlWriter& EndObject();
+    ControlWriter& BeginArray();
+    ControlWriter& EndArray();
+    ControlWriter& Key(std::string_view key);
+    ControlWriter& String(std::string_view value);
+    ControlWriter& Int(int64_t value);
+    ControlWriter& Double(double value);
+    ControlWriter& Bool(bool value);
+    ControlWriter& Null();
+    ControlWriter& Value(const cJSON* item);
+    // 已经是 JSON 文本的值（IoT 描述、状态等）；TLV 模式下解析后转换，解析失败返回 false
+    bool Json(const std::string& json);
+
+    bool binary() const { return binary_; }
+    const std::string& data() const { return data_; }
+
+private:
+    bool binary_;
+    std::string data_;
+    // JSON 模式：每层是否已经写过元素（需要逗号），最多 32 层
+    uint32_t has_items_ = 0;
+    int depth_ = 0;
+    bool after_key_ = false;
+
+    void BeginValue();
+    void Push();
+    void Pop();
+    void WriteVarint(uint64_t value);
+    void WriteTlvString(std::string_view text);
+    void WriteJsonString(std::string_view text);
+};
+
+inline bool IsControlFrame(const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    return size >= 3 && bytes[0] == kControlFrameMagic && bytes[1] == kControlFrameVersion;
+}
+
+// TLV 控制帧解码成 cJSON，交给原来处理 JSON 消息的回调；格式错误返回 nullptr
+cJSON* DecodeControlFrame(const void* data, size_t size);
+
+#endif // CONTROL_CODEC_H
@@ -9,6 +9,7 @@
 #include <cstring>
 #include <arpa/inet.h>
 #include "assets/lang_config.h"
+#include "assets/keywords.h"
 
 #define TAG "MQTT"
 
@@ -32,9 +33,15 @@ void MqttProtocol::Start() {
 }
 
 bool MqttProtocol::StartMqttClient(bool report_error) {
-    if (mqtt_ != nullptr) {
+    Mqtt* old_mqtt;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        old_mqtt = mqtt_;
+        mqtt_ = nullptr;
+    }
+    if (old_mqtt != nullptr) {
         ESP_LOGW(TAG, "Mqtt client already started");
-        delete mqtt_;
+        delete old_mqtt;
     }
 
     Settings settings("mqtt", false);
@@ -52,32 +59,44 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
         return false;
     }
 
-    mqtt_ = Board::GetInstance().CreateMqtt();
-    mqtt_->SetKeepAlive(90);
+    // 连接成功后才挂到 mqtt_ 上，其他任务发送时不会用到正在连接的客户端
+    auto mqtt = Board::GetInstance().CreateMqtt();
+    mqtt->SetKeepAlive(90);
 
-    mqtt_->OnDisconnected([this]() {
+    mqtt->OnDisconnected([this]() {
         ESP_LOGI(TAG, "Disconnected from endpoint");
     });
 
-    mqtt_->OnMessage([this](const std::string& topic, const std::string& payload) {
-        cJSON* root = cJSON_Parse(payload.c_str());
-        if (root == nullptr) {
-            ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
-            return;
+    mqtt->OnMessage([this](const std::string& topic, const std::string& payload) {
+        // 协商了 TLV 后服务端的控制消息是二进制负载，hello 本身总是 JSON
+        cJSON* root;
+        if (control_binary_ && IsControlFrame(payload.data(), payload.size())) {
+            root = DecodeControlFrame(payload.data(), payload.size());
+            if (root == nullptr) {
+                ESP_LOGE(TAG, "Invalid control frame, size: %u", (unsigned)payload.size());
+                return;
+            }
+        } else {
+            root = cJSON_Parse(payload.c_str());
+            if (root == nullptr) {
+                ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());
+                return;
+            }
         }
         cJSON* type = cJSON_GetObjectItem(root, "type");
-        if (type == nullptr) {
+        if (!cJSON_IsString(type)) {
             ESP_LOGE(TAG, "Message type is not specified");
             cJSON_Delete(root);
             return;
         }
 
-        if (strcmp(type->valuestring, "hello") == 0) {
+        auto message_type = Keys::MessageType::Lookup(type->valuestring);
+        if (message_type == Keys::MessageType::kHello) {
             ParseServerHello(root);
-        } else if (strcmp(type->valuestring, "goodbye") == 0) {
+        } else if (message_type == Keys::MessageType::kGoodbye) {
             auto session_id = cJSON_GetObjectItem(root, "session_id");
             ESP_LOGI(TAG, "Received goodbye message, session_id: %s", session_id ? session_id->valuestring : "null");
-            if (session_id == nullptr || session_id_ == session_id->valuestring) {
+            if (session_id == nullptr || this->session_id() == session_id->valuestring) {
                 Application::GetInstance().Schedule([this]() {
                     CloseAudioChannel();
                 });
@@ -90,21 +109,29 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
     });
 
     ESP_LOGI(TAG, "Connecting to endpoint %s", endpoint_.c_str());
-    if (!mqtt_->Connect(endpoint_, 8883, client_id_, username_, password_)) {
+    if (!mqtt->Connect(endpoint_, 8883, client_id_, username_, password_)) {
         ESP_LOGE(TAG, "Failed to connect to endpoint");
+        delete mqtt;
         SetError(Lang::Strings::SERVER_NOT_CONNECTED);
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        mqtt_ = mqtt;
+    }
+
     ESP_LOGI(TAG, "Connected to endpoint");
     return true;
 }
 
 bool MqttProtocol::SendText(const std::string& text) {
-    if (publish_topic_.empty()) {
+    std::unique_lock<std::mutex> lock(channel_mutex_);
+    if (publish_topic_.empty() || mqtt_ == nullptr) {
         return false;
     }
     if (!mqtt_->Publish(publish_topic_, text)) {
+        lock.unlock();
         ESP_LOGE(TAG, "Failed to publish message: %s", text.c_str());
         SetError(Lang::Strings::SERVER_ERROR);
         return false;
@@ -139,20 +166,23 @@ void MqttProtocol::SendAudio(const std::vector<uint8_t>& data) {
     busy_sending_audio_ = false;
 }
 
-void MqttProtocol::CloseAudioChannel() {
+void MqttProtocol::DeleteUdp() {
+    Udp* udp;
     {
         std::lock_guard<std::mutex> lock(channel_mutex_);
-        if (udp_ != nullptr) {
-            delete udp_;
-            udp_ = nullptr;
-        }
+        udp = udp_;
+        udp_ = nullptr;
     }
+    delete udp;
+}
+
+void MqttProtocol::CloseAudioChannel() {
+    channel_parked_ = false;
+    DeleteUdp();
 
-    std::string message = "{";
-    message += "\"session_id\":\"" + session_id_ + "\",";
-    message += "\"type\":\"goodbye\"";
-    message += "}";
-    SendText(message);
+    auto message = BeginControl("goodbye");
+    message.EndObject();
+    SendControl(message);
 
     if (on_audio_channel_closed_ != nullptr) {
         on_audio_channel_closed_();
@@ -160,7 +190,19 @@ void MqttProtocol::CloseAudioChannel() {
 }
 
 bool MqttProtocol::OpenAudioChannel() {
-    if (mqtt_ == nullptr || !mqtt_->IsConnected()) {
+    std::lock_guard<std::recursive_mutex> open_lock(open_mutex_);
+    if (ResumeAudioChannel()) {
+        return true;
+    }
+    // 申请新的 UDP 通道期间旧通道不再可用，session_id_ 会被服务端 hello 改写
+    DeleteUdp();
+
+    bool mqtt_connected;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        mqtt_connected = mqtt_ != nullptr && mqtt_->IsConnected();
+    }
+    if (!mqtt_connected) {
         ESP_LOGI(TAG, "MQTT is not connected, try to connect now");
         if (!StartMqttClient(true)) {
             return false;
@@ -169,18 +211,28 @@ bool MqttProtocol::OpenAudioChannel() {
 
     busy_sending_audio_ = false;
     error_occurred_ = false;
-    session_id_ = "";
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        session_id_ = "";
+    }
+    control_binary_ = false;
     xEventGroupClearBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);
 
     // 发送 hello 消息申请 UDP 通道
-    std::string message = "{";
-    message += "\"type\":\"hello\",";
-    message += "\"version\": 3,";
-    message += "\"transport\":\"udp\",";
-    message += "\"audio_params\":{";
-    message += "\"format\":\"opus\", \"sample_rate\":16000, \"channels\":1, \"frame_duration\":" + std::to_string(OPUS_FRAME_DURATION_MS);
-    message += "}}";
-    if (!SendText(message)) {
+    ControlWriter message(false);
+    message.BeginObject();
+    message.Key("type").String("hello");
+    message.Key("version").Int(3);
+    message.Key("transport").String("udp");
+    WriteControlEncodings(message);
+    message.Key("audio_params").BeginObject();
+    message.Key("format").String("opus");
+    message.Key("sample_rate").Int(16000);
+    message.Key("channels").Int(1);
+    message.Key("frame_duration").Int(OPUS_FRAME_DURATION_MS);
+    message.EndObject();
+    message.EndObject();
+    if (!SendText(message.data())) {
         return false;
     }
 
@@ -192,12 +244,8 @@ bool MqttProtocol::OpenAudioChannel() {
         return false;
     }
 
-    std::lock_guard<std::mutex> lock(channel_mutex_);
-    if (udp_ != nullptr) {
-        delete udp_;
-    }
-    udp_ = Board::GetInstance().CreateUdp();
-    udp_->OnMessage([this](const std::string& data) {
+    auto udp = Board::GetInstance().CreateUdp();
+    udp->OnMessage([this](const std::string& data) {
         if (data.size() < sizeof(aes_nonce_)) {
             ESP_LOGE(TAG, "Invalid audio packet size: %zu", data.size());
             return;
@@ -234,7 +282,11 @@ bool MqttProtocol::OpenAudioChannel() {
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
 
-    udp_->Connect(udp_server_, udp_port_);
+    udp->Connect(udp_server_, udp_port_);
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        udp_ = udp;
+    }
 
     if (on_audio_channel_opened_ != nullptr) {
         on_audio_channel_opened_();
@@ -251,6 +303,7 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
 
     auto session_id = cJSON_GetObjectItem(root, "session_id");
     if (session_id != nullptr) {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
         session_id_ = session_id->valuestring;
         ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());
     }
@@ -267,6 +320,7 @@ void MqttProtocol::ParseServerHello(const cJSON* root) {
             server_frame_duration_ = frame_duration->valueint;
         }
     }
+    ParseControlEncoding(root);
 
     auto udp = cJSON_GetObjectItem(root, "udp");
     if (udp == nullptr) {
@@ -307,6 +361,17 @@ std::string MqttProtocol::DecodeHexString(const std::string& hex_string) {
     return decoded;
 }
 
+bool MqttProtocol::IsControlChannelConnected() const {
+    std::lock_guard<std::mutex> lock(channel_mutex_);
+    return !publish_topic_.empty() && mqtt_ != nullptr && mqtt_->IsConnected();
+}
+
 bool MqttProtocol::IsAudioChannelOpened() const {
-    return udp_ != nullptr && !error_occurred_ && !IsTimeout();
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (udp_ == nullptr) {
+            return false;
+        }
+    }
+    return !error_occurred_ && !IsTimeout();
 }
@@ -30,6 +30,7 @@ public:
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    bool IsControlChannelConnected() const override;
 
 private:
     EventGroupHandle_t event_group_handle_;
@@ -40,7 +41,6 @@ private:
     std::string password_;
     std::string publish_topic_;
 
-    std::mutex channel_mutex_;
     Mqtt* mqtt_ = nullptr;
     Udp* udp_ = nullptr;
     mbedtls_aes_context aes_ctx_;
@@ -51,6 +51,7 @@ private:
     uint32_t remote_sequence_;
 
     bool StartMqttClient(bool report_error=false);
+    void DeleteUdp();
     void ParseServerHello(const cJSON* root);
     std::string DecodeHexString(const std::string& hex_string);
 
@@ -0,0 +1,59 @@
+#ifndef P3_STREAM_H
+#define P3_STREAM_H
+
+// P3 音频容器：每个 Opus 包前面是 4 字节的 BinaryProtocol3 头（type、reserved、大端 payload_size）。
+// 只依赖标准库，固件和 scripts/p3_tools/native 的主机工具共用这一份实现。
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct BinaryProtocol3 {
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t payload_size;
+    uint8_t payload[];
+} __attribute__((packed));
+
+class P3Reader {
+public:
+    P3Reader(const void* data, size_t size)
+        : p_(static_cast<const uint8_t*>(data)), end_(p_ + size) {}
+
+    // 读出下一个包；数据结束或包头越界时返回 false，越界时 error() 为 true
+    bool Next(const uint8_t*& payload, uint16_t& payload_size) {
+        if (p_ == end_) {
+            return false;
+        }
+        if (end_ - p_ < (ptrdiff_t)sizeof(BinaryProtocol3)) {
+            error_ = true;
+            return false;
+        }
+        uint16_t size = (uint16_t)((p_[2] << 8) | p_[3]);
+        if (end_ - p_ - (ptrdiff_t)sizeof(BinaryProtocol3) < size) {
+            error_ = true;
+            return false;
+        }
+        payload = p_ + sizeof(BinaryProtocol3);
+        payload_size = size;
+        p_ += sizeof(BinaryProtocol3) + size;
+        return true;
+    }
+
+    bool error() const { return error_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    bool error_ = false;
+};
+
+inline void P3AppendPacket(std::vector<uint8_t>& out, const uint8_t* payload, uint16_t payload_size) {
+    out.push_back(0);   // type
+    out.push_back(0);   // reserved
+    out.push_back((uint8_t)(payload_size >> 8));
+    out.push_back((uint8_t)(payload_size & 0xFF));
+    out.insert(out.end(), payload, payload + payload_size);
+}
+
+#endif // P3_STREAM_H
@@ -1,9 +1,19 @@
 #include "protocol.h"
+#include "application.h"
 
 #include <esp_log.h>
+#include <mbedtls/base64.h>
+#include <cstring>
 
 #define TAG "Protocol"
 
+Protocol::~Protocol() {
+    if (keep_alive_timer_ != nullptr) {
+        esp_timer_stop(keep_alive_timer_);
+        esp_timer_delete(keep_alive_timer_);
+    }
+}
+
 void Protocol::OnIncomingJson(std::function<void(const cJSON* root)> callback) {
     on_incoming_json_ = callback;
 }
@@ -31,38 +41,75 @@ void Protocol::SetError(const std::string& message) {
     }
 }
 
+bool Protocol::SendControlFrame(const std::string& frame) {
+    return SendText(frame);
+}
+
+bool Protocol::SendControl(const ControlWriter& message) {
+    return message.binary() ? SendControlFrame(message.data()) : SendText(message.data());
+}
+
+ControlWriter Protocol::BeginControl(const char* type) const {
+    ControlWriter message(control_binary_);
+    message.BeginObject();
+    message.Key("session_id").String(session_id());
+    message.Key("type").String(type);
+    return message;
+}
+
+void Protocol::WriteControlEncodings(ControlWriter& hello) const {
+#if CONFIG_CONTROL_BINARY_ENCODING
+    hello.Key("control").BeginArray().String(kControlEncodingTlv).EndArray();
+#endif
+}
+
+void Protocol::ParseControlEncoding(const cJSON* hello) {
+    control_binary_ = false;
+#if CONFIG_CONTROL_BINARY_ENCODING
+    auto control = cJSON_GetObjectItem(hello, "control");
+    if (cJSON_IsString(control) && strcmp(control->valuestring, kControlEncodingTlv) == 0) {
+        control_binary_ = true;
+    }
+#endif
+    ESP_LOGI(TAG, "Control encoding: %s", control_binary_ ? kControlEncodingTlv : "json");
+}
+
 void Protocol::SendAbortSpeaking(AbortReason reason) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"abort\"";
+    auto message = BeginControl("abort");
     if (reason == kAbortReasonWakeWordDetected) {
-        message += ",\"reason\":\"wake_word_detected\"";
+        message.Key("reason").String("wake_word_detected");
     }
-    message += "}";
-    SendText(message);
+    message.EndObject();
+    SendControl(message);
 }
 
 void Protocol::SendWakeWordDetected(const std::string& wake_word) {
-    std::string json = "{\"session_id\":\"" + session_id_ + 
-                      "\",\"type\":\"listen\",\"state\":\"detect\",\"text\":\"" + wake_word + "\"}";
-    SendText(json);
+    auto message = BeginControl("listen");
+    message.Key("state").String("detect");
+    message.Key("text").String(wake_word);
+    message.EndObject();
+    SendControl(message);
 }
 
 void Protocol::SendStartListening(ListeningMode mode) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\"";
-    message += ",\"type\":\"listen\",\"state\":\"start\"";
+    auto message = BeginControl("listen");
+    message.Key("state").String("start");
     if (mode == kListeningModeRealtime) {
-        message += ",\"mode\":\"realtime\"";
+        message.Key("mode").String("realtime");
     } else if (mode == kListeningModeAutoStop) {
-        message += ",\"mode\":\"auto\"";
+        message.Key("mode").String("auto");
     } else {
-        message += ",\"mode\":\"manual\"";
+        message.Key("mode").String("manual");
     }
-    message += "}";
-    SendText(message);
+    message.EndObject();
+    SendControl(message);
 }
 
 void Protocol::SendStopListening() {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"listen\",\"state\":\"stop\"}";
-    SendText(message);
+    auto message = BeginControl("listen");
+    message.Key("state").String("stop");
+    message.EndObject();
+    SendControl(message);
 }
 
 void Protocol::SendIotDescriptors(const std::string& descriptors) {
@@ -86,33 +133,37 @@ void Protocol::SendIotDescriptors(const std::string& descriptors) {
             continue;
         }
 
-        cJSON* messageRoot = cJSON_CreateObject();
-        cJSON_AddStringToObject(messageRoot, "session_id", session_id_.c_str());
-        cJSON_AddStringToObject(messageRoot, "type", "iot");
-        cJSON_AddBoolToObject(messageRoot, "update", true);
-
-        cJSON* descriptorArray = cJSON_CreateArray();
-        cJSON_AddItemToArray(descriptorArray, cJSON_Duplicate(descriptor, 1));
-        cJSON_AddItemToObject(messageRoot, "descriptors", descriptorArray);
-
-        char* message = cJSON_PrintUnformatted(messageRoot);
-        if (message == nullptr) {
-            ESP_LOGE(TAG, "Failed to print JSON message for IoT descriptor at index %d", i);
-            cJSON_Delete(messageRoot);
-            continue;
-        }
-
-        SendText(std::string(message));
-        cJSON_free(message);
-        cJSON_Delete(messageRoot);
+        auto message = BeginControl("iot");
+        message.Key("update").Bool(true);
+        message.Key("descriptors").BeginArray().Value(descriptor).EndArray();
+        message.EndObject();
+        SendControl(message);
     }
 
     cJSON_Delete(root);
 }
 
 void Protocol::SendIotStates(const std::string& states) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"iot\",\"update\":true,\"states\":" + states + "}";
-    SendText(message);
+    auto message = BeginControl("iot");
+    message.Key("update").Bool(true);
+    message.Key("states");
+    if (!message.Json(states)) {
+        ESP_LOGE(TAG, "Failed to parse IoT states: %s", states.c_str());
+        return;
+    }
+    message.EndObject();
+    SendControl(message);
+}
+
+void Protocol::SendIotResult(const std::string& result) {
+    auto message = BeginControl("iot");
+    message.Key("result");
+    if (!message.Json(result)) {
+        ESP_LOGE(TAG, "Failed to parse IoT result: %s", result.c_str());
+        return;
+    }
+    message.EndObject();
+    SendControl(message);
 }
 
 
@@ -131,16 +182,122 @@ bool Protocol::IsAudioChannelBusy() const {
     return busy_sending_audio_;
 }
 
+void Protocol::ReleaseAudioChannel() {
+#if CONFIG_AUDIO_CHANNEL_KEEP_ALIVE_SECONDS > 0
+    if (IsAudioChannelOpened()) {
+        if (keep_alive_timer_ == nullptr) {
+            esp_timer_create_args_t timer_args = {
+                .callback = [](void* arg) {
+                    auto self = static_cast<Protocol*>(arg);
+                    Application::GetInstance().Schedule([self]() {
+                        // 有任务正在打开通道时不关，它会恢复或替换这个通道
+                        std::unique_lock<std::recursive_mutex> lock(self->open_mutex_, std::try_to_lock);
+                        bool parked = true;
+                        if (lock.owns_lock() && self->channel_parked_.compare_exchange_strong(parked, false)) {
+                            ESP_LOGI(TAG, "Keep-alive window expired, closing audio channel");
+                            self->CloseAudioChannel();
+                        }
+                    });
+                },
+                .arg = this,
+                .dispatch_method = ESP_TIMER_TASK,
+                .name = "channel_keep_alive",
+                .skip_unhandled_events = true,
+            };
+            ESP_ERROR_CHECK(esp_timer_create(&timer_args, &keep_alive_timer_));
+        }
+        channel_parked_ = true;
+        esp_timer_stop(keep_alive_timer_);
+        esp_timer_start_once(keep_alive_timer_, CONFIG_AUDIO_CHANNEL_KEEP_ALIVE_SECONDS * 1000000LL);
+        ESP_LOGI(TAG, "Audio channel parked for %d seconds, session_id: %s",
+            CONFIG_AUDIO_CHANNEL_KEEP_ALIVE_SECONDS, session_id().c_str());
+        return;
+    }
+#endif
+    CloseAudioChannel();
+}
+
+bool Protocol::ResumeAudioChannel() {
+    if (!channel_parked_.exchange(false)) {
+        return false;
+    }
+    if (keep_alive_timer_ != nullptr) {
+        esp_timer_stop(keep_alive_timer_);
+    }
+    if (!IsAudioChannelOpened()) {
+        // 保活期间被服务器关闭或超时，重新建立
+        return false;
+    }
+    // 通道打开时的回调（采样率、IoT 描述等）在首次建立时已经执行过，这里不再重复
+    busy_sending_audio_ = false;
+    ESP_LOGI(TAG, "Resume audio channel, session_id: %s", session_id().c_str());
+    return true;
+}
+
+bool Protocol::PreconnectAudioChannel() {
+    std::lock_guard<std::recursive_mutex> lock(open_mutex_);
+    if (IsAudioChannelOpened()) {
+        return true;
+    }
+    if (!OpenAudioChannel()) {
+        return false;
+    }
+    ReleaseAudioChannel();
+    return true;
+}
+
 ///////////////////////////////新增///////////////////
 bool Protocol::SendCustomText(const std::string& text) {
+    if (control_binary_) {
+        ControlWriter message(true);
+        if (message.Json(text)) {
+            return SendControlFrame(message.data());
+        }
+        // 不是合法 JSON 的内容原样按文本发送
+    }
     return SendText(text);
 }
 
+bool Protocol::SendTextToSpeech(const std::string& text) {
+    auto message = BeginControl("text2speech");
+    message.Key("text").String(text);
+    message.EndObject();
+    return SendControl(message);
+}
+
 bool Protocol::SendCustomMessage(const std::string& type, const std::string& data) {
-    std::string message = "{";
-    message += "\"session_id\":\"" + session_id_ + "\",";
-    message += "\"type\":\"" + type + "\",";
-    message += "\"custom_data\":" + data;
-    message += "}";
-    return SendText(message);
+    auto message = BeginControl(type.c_str());
+    message.Key("custom_data");
+    if (!message.Json(data)) {
+        ESP_LOGE(TAG, "Failed to parse custom data of %s", type.c_str());
+        return false;
+    }
+    message.EndObject();
+    return SendControl(message);
+}
+
+bool Protocol::SendMetrics(const std::vector<uint8_t>& snapshot) {
+    size_t encoded_size = 0;
+    mbedtls_base64_encode(nullptr, 0, &encoded_size, snapshot.data(), snapshot.size());
+    std::string encoded(encoded_size, '\0');
+    if (mbedtls_base64_encode((unsigned char*)encoded.data(), encoded.size(), &encoded_size,
+            snapshot.data(), snapshot.size()) != 0) {
+        ESP_LOGE(TAG, "Failed to encode metrics snapshot");
+        return false;
+    }
+    encoded.resize(encoded_size);
+
+    auto message = BeginControl("metrics");
+    message.Key("format").String("bin");
+    message.Key("data").String(encoded);
+    message.EndObject();
+    return SendControl(message);
+}
+
+bool Protocol::SendTrace(const std::string& chunk, bool last) {
+    auto message = BeginControl("trace");
+    message.Key("data").String(chunk);
+    message.Key("last").Bool(last);
+    message.EndObject();
+    return SendControl(message);
 }
\ No newline at end of file
@@ -5,13 +5,12 @@
 #include <string>
 #include <functional>
 #include <chrono>
+#include <mutex>
+#include <atomic>
+#include <esp_timer.h>
 
-struct BinaryProtocol3 {
-    uint8_t type;
-    uint8_t reserved;
-    uint16_t payload_size;
-    uint8_t payload[];
-} __attribute__((packed));
+#include "p3_stream.h"
+#include "control_codec.h"
 
 enum AbortReason {
     kAbortReasonNone,
@@ -26,7 +25,7 @@ enum ListeningMode {
 
 class Protocol {
 public:
-    virtual ~Protocol() = default;
+    virtual ~Protocol();
 
     inline int server_sample_rate() const {
         return server_sample_rate_;
@@ -34,9 +33,14 @@ public:
     inline int server_frame_duration() const {
         return server_frame_duration_;
     }
-    inline const std::string& session_id() const {
+    inline std::string session_id() const {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
         return session_id_;
     }
+    // 服务端 hello 协商了 TLV 控制帧
+    inline bool control_binary() const {
+        return control_binary_;
+    }
 
     void OnIncomingAudio(std::function<void(std::vector<uint8_t>&& data)> callback);
     void OnIncomingJson(std::function<void(const cJSON* root)> callback);
@@ -49,6 +53,13 @@ public:
     virtual void CloseAudioChannel() = 0;
     virtual bool IsAudioChannelOpened() const = 0;
     virtual bool IsAudioChannelBusy() const;
+    // 能否发送控制消息；MQTT 的控制连接不依赖音频通道，空闲时也能发
+    virtual bool IsControlChannelConnected() const { return IsAudioChannelOpened(); }
+    // 结束一次对话但暂时保留通道，保活窗口内再次 OpenAudioChannel 直接复用同一个 session
+    virtual void ReleaseAudioChannel();
+    bool IsAudioChannelParked() const { return channel_parked_; }
+    // 建立通道后立即保留；和其他打开请求互斥，期间唤醒的打开请求会直接恢复这个通道
+    bool PreconnectAudioChannel();
     virtual void SendAudio(const std::vector<uint8_t>& data) = 0;
     virtual void SendWakeWordDetected(const std::string& wake_word);
     virtual void SendStartListening(ListeningMode mode);
@@ -56,10 +67,18 @@ public:
     virtual void SendAbortSpeaking(AbortReason reason);
     virtual void SendIotDescriptors(const std::string& descriptors);
     virtual void SendIotStates(const std::string& states);
+    // IoT 命令执行结果，result 为 iot::CommandResult::ToJson() 的输出
+    virtual void SendIotResult(const std::string& result);
     // 新增：直接发送文本消息
     virtual bool SendCustomText(const std::string& text);/////////////////////////
+    // 请求服务端把一段文字合成语音播放
+    virtual bool SendTextToSpeech(const std::string& text);
     // 发送带类型标识的自定义消息
     virtual bool SendCustomMessage(const std::string& type, const std::string& data);
+    // 上报运行指标快照（二进制，base64 编码后放入 JSON）
+    virtual bool SendMetrics(const std::vector<uint8_t>& snapshot);
+    // 分块上报追踪缓冲区导出的文本
+    virtual bool SendTrace(const std::string& chunk, bool last);
   
     
 
@@ -72,14 +91,34 @@ protected:
 
     int server_sample_rate_ = 24000;
     int server_frame_duration_ = 60;
-    bool error_occurred_ = false;
-    bool busy_sending_audio_ = false;
+    // 通道可能在唤醒上传、预连接任务里打开，同时主循环、接收任务在用，状态标志都是原子量
+    std::atomic<bool> error_occurred_{false};
+    std::atomic<bool> busy_sending_audio_{false};
+    std::atomic<bool> channel_parked_{false};
+    std::atomic<bool> control_binary_{false};
+    esp_timer_handle_t keep_alive_timer_ = nullptr;
+    // 保护子类的连接对象指针和 session_id_；只在取用和替换指针时持有，不跨阻塞的连接过程
+    mutable std::mutex channel_mutex_;
+    // OpenAudioChannel 的实现在开头持有，保证同一时间只有一个任务在建立或恢复通道
+    std::recursive_mutex open_mutex_;
     std::string session_id_;
     std::chrono::time_point<std::chrono::steady_clock> last_incoming_time_;
 
     virtual bool SendText(const std::string& text) = 0;
+    // 发送 TLV 控制帧，默认和文本走同一条通道
+    virtual bool SendControlFrame(const std::string& frame);
+    // 按协商结果发送 JSON 文本或 TLV 帧
+    bool SendControl(const ControlWriter& message);
+    // 开始一条带 session_id 和 type 的控制消息，调用方补充其他字段后 EndObject
+    ControlWriter BeginControl(const char* type) const;
+    // 客户端 hello 里声明支持的控制编码
+    void WriteControlEncodings(ControlWriter& hello) const;
+    // 从服务端 hello 读取选中的控制编码
+    void ParseControlEncoding(const cJSON* hello);
     virtual void SetError(const std::string& message);
     virtual bool IsTimeout() const;
+    // OpenAudioChannel 开头调用：保留的通道仍然可用时恢复并返回 true
+    bool ResumeAudioChannel();
 };
 
 #endif // PROTOCOL_H
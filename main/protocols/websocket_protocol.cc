@@ -8,6 +8,7 @@
 #include <esp_log.h>
 #include <arpa/inet.h>
 #include "assets/lang_config.h"
+#include "assets/keywords.h"
 
 #define TAG "WS"
 
@@ -25,22 +26,34 @@ WebsocketProtocol::~WebsocketProtocol() {
 void WebsocketProtocol::Start() {
 }
 
+WebSocket* WebsocketProtocol::GetWebsocket() const {
+    std::lock_guard<std::mutex> lock(channel_mutex_);
+    return websocket_;
+}
+
+// 网络拥塞时 Send 会阻塞很久，channel_mutex_ 只在取指针时持有，不挡住 IsAudioChannelOpened、
+// session_id 等读取；send_mutex_ 串行化各任务的发送，指针在持有它期间不会被 DeleteWebsocket 释放
 void WebsocketProtocol::SendAudio(const std::vector<uint8_t>& data) {
-    if (websocket_ == nullptr) {
+    std::lock_guard<std::mutex> send_lock(send_mutex_);
+    auto websocket = GetWebsocket();
+    if (websocket == nullptr) {
         return;
     }
 
     busy_sending_audio_ = true;
-    websocket_->Send(data.data(), data.size(), true);
+    websocket->Send(data.data(), data.size(), true);
     busy_sending_audio_ = false;
 }
 
 bool WebsocketProtocol::SendText(const std::string& text) {
-    if (websocket_ == nullptr) {
+    std::unique_lock<std::mutex> send_lock(send_mutex_);
+    auto websocket = GetWebsocket();
+    if (websocket == nullptr) {
         return false;
     }
 
-    if (!websocket_->Send(text)) {
+    if (!websocket->Send(text)) {
+        send_lock.unlock();
         ESP_LOGE(TAG, "Failed to send text: %s", text.c_str());
         SetError(Lang::Strings::SERVER_ERROR);
         return false;
@@ -49,49 +62,92 @@ bool WebsocketProtocol::SendText(const std::string& text) {
     return true;
 }
 
+bool WebsocketProtocol::SendControlFrame(const std::string& frame) {
+    std::unique_lock<std::mutex> send_lock(send_mutex_);
+    auto websocket = GetWebsocket();
+    if (websocket == nullptr) {
+        return false;
+    }
+
+    // TLV 控制帧和音频共用二进制帧，靠 0xFF 开头区分
+    if (!websocket->Send(frame.data(), frame.size(), true)) {
+        send_lock.unlock();
+        ESP_LOGE(TAG, "Failed to send control frame, size: %u", (unsigned)frame.size());
+        SetError(Lang::Strings::SERVER_ERROR);
+        return false;
+    }
+
+    return true;
+}
+
 bool WebsocketProtocol::IsAudioChannelOpened() const {
-    return websocket_ != nullptr && websocket_->IsConnected() && !error_occurred_ && !IsTimeout();
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (websocket_ == nullptr || !websocket_->IsConnected()) {
+            return false;
+        }
+    }
+    return !error_occurred_ && !IsTimeout();
 }
 
-void WebsocketProtocol::CloseAudioChannel() {
-    if (websocket_ != nullptr) {
-        delete websocket_;
+// 取下当前连接再释放：删除时要等接收任务退出，不能持有 channel_mutex_。
+// 取下之后新的发送拿到的是空指针，再等正在进行的发送结束
+void WebsocketProtocol::DeleteWebsocket() {
+    WebSocket* websocket;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        websocket = websocket_;
         websocket_ = nullptr;
     }
+    {
+        std::lock_guard<std::mutex> send_lock(send_mutex_);
+    }
+    delete websocket;
+}
+
+void WebsocketProtocol::CloseAudioChannel() {
+    channel_parked_ = false;
+    DeleteWebsocket();
 }
 
 bool WebsocketProtocol::OpenAudioChannel() {
-    if (websocket_ != nullptr) {
-        delete websocket_;
+    std::lock_guard<std::recursive_mutex> open_lock(open_mutex_);
+    if (ResumeAudioChannel()) {
+        return true;
     }
+    DeleteWebsocket();
 
     busy_sending_audio_ = false;
     error_occurred_ = false;
+    control_binary_ = false;
+    xEventGroupClearBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
     std::string url = CONFIG_WEBSOCKET_URL;
     std::string token = "Bearer " + std::string(CONFIG_WEBSOCKET_ACCESS_TOKEN);
-    websocket_ = Board::GetInstance().CreateWebSocket();
-    websocket_->SetHeader("Authorization", token.c_str());
-    websocket_->SetHeader("Protocol-Version", "1");
-    websocket_->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
-    websocket_->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
-
-    websocket_->OnData([this](const char* data, size_t len, bool binary) {
-        if (binary) {
+    // 新连接在 hello 交换完成后才挂到 websocket_ 上，连接期间其他任务看到的是通道未打开
+    auto websocket = Board::GetInstance().CreateWebSocket();
+    websocket->SetHeader("Authorization", token.c_str());
+    websocket->SetHeader("Protocol-Version", "1");
+    websocket->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
+    websocket->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
+
+    websocket->OnData([this](const char* data, size_t len, bool binary) {
+        if (binary && control_binary_ && IsControlFrame(data, len)) {
+            auto root = DecodeControlFrame(data, len);
+            if (cJSON_GetObjectItem(root, "type") != NULL) {
+                HandleJson(root);
+            } else {
+                ESP_LOGE(TAG, "Invalid control frame, size: %u", (unsigned)len);
+            }
+            cJSON_Delete(root);
+        } else if (binary) {
             if (on_incoming_audio_ != nullptr) {
                 on_incoming_audio_(std::vector<uint8_t>((uint8_t*)data, (uint8_t*)data + len));
             }
         } else {
             // Parse JSON data
             auto root = cJSON_Parse(data);
-            auto type = cJSON_GetObjectItem(root, "type");
-            if (type != NULL) {
-                if (strcmp(type->valuestring, "hello") == 0) {
-                    ParseServerHello(root);
-                } else {
-                    if (on_incoming_json_ != nullptr) {
-                        on_incoming_json_(root);
-                    }
-                }
+            if (cJSON_GetObjectItem(root, "type") != NULL) {
+                HandleJson(root);
             } else {
                 ESP_LOGE(TAG, "Missing message type, data: %s", data);
             }
@@ -100,29 +156,40 @@ bool WebsocketProtocol::OpenAudioChannel() {
         last_incoming_time_ = std::chrono::steady_clock::now();
     });
 
-    websocket_->OnDisconnected([this]() {
+    websocket->OnDisconnected([this]() {
         ESP_LOGI(TAG, "Websocket disconnected");
         if (on_audio_channel_closed_ != nullptr) {
             on_audio_channel_closed_();
         }
     });
 
-    if (!websocket_->Connect(url.c_str())) {
+    if (!websocket->Connect(url.c_str())) {
         ESP_LOGE(TAG, "Failed to connect to websocket server");
+        delete websocket;
         SetError(Lang::Strings::SERVER_NOT_FOUND);
         return false;
     }
 
     // Send hello message to describe the client
-    // keys: message type, version, audio_params (format, sample_rate, channels)
-    std::string message = "{";
-    message += "\"type\":\"hello\",";
-    message += "\"version\": 1,";
-    message += "\"transport\":\"websocket\",";
-    message += "\"audio_params\":{";
-    message += "\"format\":\"opus\", \"sample_rate\":16000, \"channels\":1, \"frame_duration\":" + std::to_string(OPUS_FRAME_DURATION_MS);
-    message += "}}";
-    if (!SendText(message)) {
+    // keys: message type, version, control encodings, audio_params (format, sample_rate, channels)
+    // hello 总是 JSON，服务端回复之后才知道能否使用 TLV
+    ControlWriter message(false);
+    message.BeginObject();
+    message.Key("type").String("hello");
+    message.Key("version").Int(1);
+    message.Key("transport").String("websocket");
+    WriteControlEncodings(message);
+    message.Key("audio_params").BeginObject();
+    message.Key("format").String("opus");
+    message.Key("sample_rate").Int(16000);
+    message.Key("channels").Int(1);
+    message.Key("frame_duration").Int(OPUS_FRAME_DURATION_MS);
+    message.EndObject();
+    message.EndObject();
+    if (!websocket->Send(message.data())) {
+        ESP_LOGE(TAG, "Failed to send hello");
+        delete websocket;
+        SetError(Lang::Strings::SERVER_ERROR);
         return false;
     }
 
@@ -130,10 +197,16 @@ bool WebsocketProtocol::OpenAudioChannel() {
     EventBits_t bits = xEventGroupWaitBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
     if (!(bits & WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT)) {
         ESP_LOGE(TAG, "Failed to receive server hello");
+        delete websocket;
         SetError(Lang::Strings::SERVER_TIMEOUT);
         return false;
     }
 
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        websocket_ = websocket;
+    }
+
     if (on_audio_channel_opened_ != nullptr) {
         on_audio_channel_opened_();
     }
@@ -141,6 +214,15 @@ bool WebsocketProtocol::OpenAudioChannel() {
     return true;
 }
 
+void WebsocketProtocol::HandleJson(const cJSON* root) {
+    auto type = cJSON_GetObjectItem(root, "type");
+    if (cJSON_IsString(type) && Keys::MessageType::Lookup(type->valuestring) == Keys::MessageType::kHello) {
+        ParseServerHello(root);
+    } else if (on_incoming_json_ != nullptr) {
+        on_incoming_json_(root);
+    }
+}
+
 void WebsocketProtocol::ParseServerHello(const cJSON* root) {
     auto transport = cJSON_GetObjectItem(root, "transport");
     if (transport == nullptr || strcmp(transport->valuestring, "websocket") != 0) {
@@ -159,6 +241,7 @@ void WebsocketProtocol::ParseServerHello(const cJSON* root) {
             server_frame_duration_ = frame_duration->valueint;
         }
     }
+    ParseControlEncoding(root);
 
     xEventGroupSetBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
 }
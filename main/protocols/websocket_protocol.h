@@ -24,9 +24,15 @@ public:
 private:
     EventGroupHandle_t event_group_handle_;
     WebSocket* websocket_ = nullptr;
+    // 串行化发送；发送期间不持有 channel_mutex_
+    std::mutex send_mutex_;
 
+    WebSocket* GetWebsocket() const;
     void ParseServerHello(const cJSON* root);
+    void HandleJson(const cJSON* root);
+    void DeleteWebsocket();
     bool SendText(const std::string& text) override;
+    bool SendControlFrame(const std::string& frame) override;
 };
 
 #endif
@@ -0,0 +1,136 @@
+#include "sound_bundle.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstring>
+
+#define TAG "SoundBundle"
+
+extern const char sound_bundle_start[] asm("_binary_sounds_bin_start");
+extern const char sound_bundle_end[] asm("_binary_sounds_bin_end");
+
+static constexpr char kMagic[4] = { 'P', '3', 'B', 'D' };
+static constexpr uint16_t kVersion = 1;
+static constexpr size_t kHeaderSize = 16;
+static constexpr size_t kEntrySize = 20;
+
+// 嵌入的数据不保证对齐，按小端逐字节读取
+static uint16_t ReadU16(const char* p) {
+    auto b = reinterpret_cast<const uint8_t*>(p);
+    return b[0] | (b[1] << 8);
+}
+
+static uint32_t ReadU32(const char* p) {
+    auto b = reinterpret_cast<const uint8_t*>(p);
+    return b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+uint32_t SoundBundle::HashName(std::string_view name) {
+    // FNV-1a，与 scripts/sound_bundle.py 一致
+    uint32_t hash = 0x811C9DC5;
+    for (char c : name) {
+        hash = (hash ^ (uint8_t)c) * 0x01000193;
+    }
+    return hash;
+}
+
+SoundBundle::SoundBundle() {
+    size_t size = sound_bundle_end - sound_bundle_start;
+    if (size < kHeaderSize || memcmp(sound_bundle_start, kMagic, sizeof(kMagic)) != 0) {
+        ESP_LOGE(TAG, "Invalid sound bundle");
+        return;
+    }
+    uint16_t version = ReadU16(sound_bundle_start + 4);
+    uint16_t count = ReadU16(sound_bundle_start + 6);
+    uint32_t total = ReadU32(sound_bundle_start + 12);
+    if (version != kVersion || total > size || kHeaderSize + count * kEntrySize > total) {
+        ESP_LOGE(TAG, "Unsupported sound bundle: version %u, %u entries, %u/%u bytes",
+            version, count, (unsigned)total, (unsigned)size);
+        return;
+    }
+    data_ = sound_bundle_start;
+    size_ = total;
+    count_ = count;
+    // 条目越界说明打包脚本和固件不一致，整个包都不用
+    for (size_t i = 0; i < count_; i++) {
+        auto entry = GetEntry(i);
+        if (entry.offset > size_ || entry.size > size_ - entry.offset) {
+            ESP_LOGE(TAG, "Sound entry %u out of range", (unsigned)i);
+            count_ = 0;
+            return;
+        }
+    }
+}
+
+SoundInfo SoundBundle::GetEntry(size_t index) const {
+    const char* p = data_ + kHeaderSize + index * kEntrySize;
+    SoundInfo info;
+    info.name_hash = ReadU32(p);
+    info.offset = ReadU32(p + 4);
+    info.size = ReadU32(p + 8);
+    info.duration_ms = ReadU32(p + 12);
+    info.packets = ReadU16(p + 16);
+    return info;
+}
+
+std::string_view SoundBundle::FindHash(uint32_t hash, SoundInfo* info) const {
+    size_t low = 0;
+    size_t high = count_;
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        uint32_t mid_hash = ReadU32(data_ + kHeaderSize + mid * kEntrySize);
+        if (mid_hash < hash) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == count_) {
+        return std::string_view();
+    }
+    auto entry = GetEntry(low);
+    if (entry.name_hash != hash) {
+        return std::string_view();
+    }
+    if (info != nullptr) {
+        *info = entry;
+    }
+    return std::string_view(data_ + entry.offset, entry.size);
+}
+
+std::string_view SoundBundle::Find(std::string_view name, SoundInfo* info) const {
+    return FindHash(HashName(name), info);
+}
+
+bool SoundBundle::GetInfo(const std::string_view& sound, SoundInfo& info) const {
+    if (sound.data() < data_ || sound.data() >= data_ + size_) {
+        return false;
+    }
+    uint32_t offset = sound.data() - data_;
+    for (size_t i = 0; i < count_; i++) {
+        auto entry = GetEntry(i);
+        if (entry.offset == offset && entry.size == sound.size()) {
+            info = entry;
+            return true;
+        }
+    }
+    return false;
+}
+
+void SoundBundle::LogSummary() const {
+    if (!valid()) {
+        return;
+    }
+    uint32_t index_size = ReadU32(data_ + 8);
+    uint32_t total_ms = 0;
+    int64_t start = esp_timer_get_time();
+    for (size_t i = 0; i < count_; i++) {
+        SoundInfo info;
+        FindHash(GetEntry(i).name_hash, &info);
+        total_ms += info.duration_ms;
+    }
+    int64_t elapsed = esp_timer_get_time() - start;
+    ESP_LOGI(TAG, "%u sounds, %u ms, %u bytes in flash (%u bytes index), lookup %u ns",
+        (unsigned)count_, (unsigned)total_ms, (unsigned)size_, (unsigned)index_size,
+        (unsigned)(elapsed * 1000 / count_));
+}
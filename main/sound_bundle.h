@@ -0,0 +1,57 @@
+#ifndef _SOUND_BUNDLE_H_
+#define _SOUND_BUNDLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// 音效包里一条提示音的索引
+struct SoundInfo {
+    uint32_t name_hash;
+    uint32_t offset;        // 相对包起始位置
+    uint32_t size;
+    uint32_t duration_ms;
+    uint16_t packets;
+};
+
+/*
+ * 提示音音效包（scripts/sound_bundle.py 生成，格式见脚本注释，CONFIG_USE_SOUND_BUNDLE 开启）
+ * - 当前语言和 common 目录下的所有 .p3 打包成一个 sounds.bin 嵌入 flash，内容相同的音效只存一份。
+ * - Lang::Sounds::P3_* 直接指向包内偏移，播放时不需要查找；这里的索引用于按名字查找和读取时长、包数。
+ * - 索引按名字哈希排序，按名字查找是一次二分。
+ */
+class SoundBundle {
+public:
+    static SoundBundle& GetInstance() {
+        static SoundBundle instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    SoundBundle(const SoundBundle&) = delete;
+    SoundBundle& operator=(const SoundBundle&) = delete;
+
+    static uint32_t HashName(std::string_view name);
+
+    bool valid() const { return count_ > 0; }
+    size_t count() const { return count_; }
+    size_t size() const { return size_; }
+
+    // 按名字（文件名去掉 .p3）查找，找不到返回空
+    std::string_view Find(std::string_view name, SoundInfo* info = nullptr) const;
+    // 查找 Lang::Sounds 常量对应的索引条目
+    bool GetInfo(const std::string_view& sound, SoundInfo& info) const;
+    // 打印 flash 占用和查找耗时
+    void LogSummary() const;
+
+private:
+    SoundBundle();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t count_ = 0;
+
+    SoundInfo GetEntry(size_t index) const;
+    std::string_view FindHash(uint32_t hash, SoundInfo* info) const;
+};
+
+#endif // _SOUND_BUNDLE_H_
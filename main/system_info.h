@@ -13,7 +13,7 @@ public:
     static size_t GetFreeHeapSize();
     static std::string GetMacAddress();
     static std::string GetChipModelName();
-    static esp_err_t PrintRealTimeStats(TickType_t xTicksToWait);
+    static void PrintRealTimeStats();
 };
 
 #endif // _SYSTEM_INFO_H_
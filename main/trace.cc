@@ -0,0 +1,100 @@
+#include "trace.h"
+
+#if CONFIG_USE_TRACE
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#define TAG "Trace"
+
+Trace::Trace() {
+    for (auto& ring : rings_) {
+        // 优先放在 PSRAM，避免占用内部 RAM
+        ring.events = (TraceEvent*)heap_caps_calloc(kEventsPerCore, sizeof(TraceEvent), MALLOC_CAP_SPIRAM);
+        if (ring.events == nullptr) {
+            ring.events = (TraceEvent*)heap_caps_calloc(kEventsPerCore, sizeof(TraceEvent), MALLOC_CAP_INTERNAL);
+        }
+        if (ring.events == nullptr) {
+            ESP_LOGE(TAG, "Failed to allocate trace buffer");
+            return;
+        }
+    }
+    enabled_ = true;
+    ESP_LOGI(TAG, "Trace enabled, %lu events per core, %lu ns per event", (unsigned long)kEventsPerCore,
+        (unsigned long)MeasureOverheadNs());
+}
+
+uint32_t Trace::MeasureOverheadNs(int events) {
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < events; i += 2) {
+        Record(kTraceEventBegin, "trace_benchmark");
+        Record(kTraceEventEnd, "trace_benchmark");
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start;
+    Clear();
+    return events > 0 ? (uint32_t)(elapsed_us * 1000 / events) : 0;
+}
+
+void Trace::Clear() {
+    for (auto& ring : rings_) {
+        ring.head.store(0, std::memory_order_relaxed);
+        if (ring.events != nullptr) {
+            memset(ring.events, 0, kEventsPerCore * sizeof(TraceEvent));
+        }
+    }
+}
+
+void Trace::Dump(std::function<void(const std::string& chunk, bool last)> callback, size_t max_chunk_size) {
+    bool was_enabled = enabled_;
+    enabled_ = false;
+    // 等待正在写入的事件完成
+    vTaskDelay(pdMS_TO_TICKS(1));
+
+    // 任务句柄在导出时才解析为任务名，已删除的任务显示为句柄地址
+    std::vector<TaskStatus_t> tasks(uxTaskGetNumberOfTasks() + 4);
+    tasks.resize(uxTaskGetSystemState(tasks.data(), tasks.size(), nullptr));
+    auto task_name = [&tasks](TaskHandle_t handle, char* buffer, size_t size) {
+        for (auto& task : tasks) {
+            if (task.xHandle == handle) {
+                return (const char*)task.pcTaskName;
+            }
+        }
+        snprintf(buffer, size, "%p", handle);
+        return (const char*)buffer;
+    };
+
+    std::string chunk;
+    chunk.reserve(max_chunk_size);
+    char line[96];
+    char handle_name[16];
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        auto& ring = rings_[core];
+        if (ring.events == nullptr) {
+            continue;
+        }
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+        uint32_t count = head < kEventsPerCore ? head : kEventsPerCore;
+        for (uint32_t i = head - count; i != head; i++) {
+            auto& event = ring.events[i & (kEventsPerCore - 1)];
+            if (event.name == nullptr) {
+                continue;
+            }
+            int length = snprintf(line, sizeof(line), "%lu,%d,%c,%s,%s\n", (unsigned long)event.timestamp_us, core,
+                (char)event.type, task_name(event.task, handle_name, sizeof(handle_name)), event.name);
+            if (chunk.size() + length > max_chunk_size) {
+                callback(chunk, false);
+                chunk.clear();
+            }
+            chunk.append(line, length);
+        }
+    }
+    callback(chunk, true);
+
+    Clear();
+    enabled_ = was_enabled;
+}
+
+#endif // CONFIG_USE_TRACE
@@ -0,0 +1,112 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#if CONFIG_USE_TRACE
+
+enum TraceEventType : uint8_t {
+    kTraceEventBegin = 'B',
+    kTraceEventEnd = 'E',
+    kTraceEventInstant = 'i',
+};
+
+// 16 字节，name 必须是字符串常量
+struct TraceEvent {
+    uint32_t timestamp_us;
+    const char* name;
+    TaskHandle_t task;
+    TraceEventType type;
+    uint8_t reserved[3];
+};
+
+/*
+ * 每个核心一个环形缓冲区，写入只有一次自增和一次 16 字节拷贝，不加锁。
+ * 写入期间屏蔽本核中断：取核心号到写完事件之间任务不会被抢占或迁移到另一个核，
+ * 同一个核上的中断也不会插进来写同一个槽位。屏蔽只有几十个周期。
+ * 缓冲区写满后覆盖最旧的事件。启动时测量一次每个事件的开销并输出日志。
+ *
+ * 导出为文本行，每行一个事件：
+ *   timestamp_us,core,type,task,name
+ * scripts/trace_to_chrome.py 可以把它转换为 Chrome trace JSON（chrome://tracing 或 Perfetto 打开）。
+ */
+class Trace {
+public:
+    static Trace& GetInstance() {
+        static Trace instance;
+        return instance;
+    }
+    // 删除拷贝构造函数和赋值运算符
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+
+    inline void Record(TraceEventType type, const char* name) {
+        if (!enabled_) {
+            return;
+        }
+        UBaseType_t interrupt_state = portSET_INTERRUPT_MASK_FROM_ISR();
+        auto& ring = rings_[xPortGetCoreID()];
+        uint32_t index = ring.head.fetch_add(1, std::memory_order_relaxed) & (kEventsPerCore - 1);
+        auto& event = ring.events[index];
+        event.timestamp_us = (uint32_t)esp_timer_get_time();
+        event.name = name;
+        event.task = xTaskGetCurrentTaskHandle();
+        event.type = type;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(interrupt_state);
+    }
+
+    // 导出时暂停记录，按行回调，每次回调不超过 max_chunk_size 字节
+    void Dump(std::function<void(const std::string& chunk, bool last)> callback, size_t max_chunk_size = 2048);
+    void Clear();
+    // 连续记录 events 个事件，返回每个事件的平均耗时（纳秒），之后清空缓冲区
+    uint32_t MeasureOverheadNs(int events = 10000);
+
+private:
+    Trace();
+
+    static constexpr uint32_t kEventsPerCore = CONFIG_TRACE_BUFFER_EVENTS;
+    static_assert((kEventsPerCore & (kEventsPerCore - 1)) == 0, "TRACE_BUFFER_EVENTS must be a power of two");
+
+    struct Ring {
+        std::atomic<uint32_t> head{0};
+        TraceEvent* events = nullptr;
+    };
+
+    Ring rings_[portNUM_PROCESSORS];
+    volatile bool enabled_ = false;
+};
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name_(name) {
+        Trace::GetInstance().Record(kTraceEventBegin, name_);
+    }
+    ~TraceScope() {
+        Trace::GetInstance().Record(kTraceEventEnd, name_);
+    }
+
+private:
+    const char* name_;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_BEGIN(name) Trace::GetInstance().Record(kTraceEventBegin, name)
+#define TRACE_END(name) Trace::GetInstance().Record(kTraceEventEnd, name)
+#define TRACE_INSTANT(name) Trace::GetInstance().Record(kTraceEventInstant, name)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+#else
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#define TRACE_INSTANT(name)
+#define TRACE_SCOPE(name)
+#endif
+
+#endif // _TRACE_H_
@@ -0,0 +1,99 @@
+// Host check for the startup sample rate negotiation (main/audio_codecs/audio_negotiator.cc)
+//
+// Compiles the firmware's AudioNegotiator unchanged and runs it against codec capability sets
+// like the ones ES8311 and NoAudioCodec report, comparing the chosen rates, the resampling
+// flags and the estimated CPU cost with values worked out by hand. The cost model is
+// 60 cycles per resampler input sample at 240 MHz, i.e. 1% per 40000 samples/s.
+//
+//   g++ -std=c++17 -O2 -I../main/audio_codecs -o negotiator_check audio_negotiator/negotiator_check.cc ../main/audio_codecs/audio_negotiator.cc
+//   ./negotiator_check
+//
+// (run from scripts/). Exits non-zero when a check fails.
+#include "audio_negotiator.h"
+
+#include <cmath>
+#include <cstdio>
+
+static const std::vector<int> kCodecRates = {8000, 16000, 24000, 32000, 44100, 48000};
+
+static bool Check(const char* name, const AudioPlan& actual, const AudioPlan& expected) {
+    bool ok = actual.input_sample_rate == expected.input_sample_rate &&
+        actual.output_sample_rate == expected.output_sample_rate &&
+        actual.decode_sample_rate == expected.decode_sample_rate &&
+        actual.resample_input == expected.resample_input &&
+        actual.resample_output == expected.resample_output &&
+        std::fabs(actual.estimated_cpu_percent - expected.estimated_cpu_percent) < 1e-4f;
+    printf("%-48s %s (in %d%s, out %d, decode %d%s, %.3f%%)\n", name, ok ? "ok" : "FAIL",
+        actual.input_sample_rate, actual.resample_input ? " resampled" : "",
+        actual.output_sample_rate, actual.decode_sample_rate, actual.resample_output ? " resampled" : "",
+        actual.estimated_cpu_percent);
+    if (!ok) {
+        printf("  expected in %d%s, out %d, decode %d%s, %.3f%%\n",
+            expected.input_sample_rate, expected.resample_input ? " resampled" : "",
+            expected.output_sample_rate, expected.decode_sample_rate, expected.resample_output ? " resampled" : "",
+            expected.estimated_cpu_percent);
+    }
+    return ok;
+}
+
+static AudioPlan Plan(int input, int output, int decode, bool resample_input, bool resample_output, float cpu) {
+    AudioPlan plan;
+    plan.input_sample_rate = input;
+    plan.output_sample_rate = output;
+    plan.decode_sample_rate = decode;
+    plan.resample_input = resample_input;
+    plan.resample_output = resample_output;
+    plan.estimated_cpu_percent = cpu;
+    return plan;
+}
+
+static AudioCodecCaps Caps(const std::vector<int>& rates, bool shared_clock, int mics, int refs, int input, int output) {
+    AudioCodecCaps caps;
+    caps.sample_rates = rates;
+    caps.shared_clock = shared_clock;
+    caps.mic_channels = mics;
+    caps.reference_channels = refs;
+    caps.input_sample_rate = input;
+    caps.output_sample_rate = output;
+    return caps;
+}
+
+int main() {
+    bool ok = true;
+
+    // 共用时钟：24 kHz 只需把一路 24 kHz 输入降到 16 kHz，0.6%，比 32/44.1/48 kHz 都便宜
+    auto es8311 = Caps(kCodecRates, true, 1, 0, 24000, 24000);
+    ok &= Check("shared clock, min 24 kHz", AudioNegotiator::Negotiate(es8311, 16000, 24000, 24000),
+        Plan(24000, 24000, 24000, true, false, 0.6f));
+    ok &= Check("shared clock, min 16 kHz: no resampling", AudioNegotiator::Negotiate(es8311, 16000, 24000, 16000),
+        Plan(16000, 16000, 16000, false, false, 0));
+
+    // 收发分开：输入 16 kHz、输出 24/48 kHz 都不用重采样，选接近 stream_rate 的 24 kHz
+    auto simplex = Caps(kCodecRates, false, 1, 0, 16000, 24000);
+    ok &= Check("separate clocks: 16 kHz in, 24 kHz out", AudioNegotiator::Negotiate(simplex, 16000, 24000, 24000),
+        Plan(16000, 24000, 24000, false, false, 0));
+
+    // 输入重采样按输入采样率乘声道数计：3 路 32 kHz 为 2.4%，3 路 48 kHz 为 3.6%
+    auto array = Caps({32000, 48000}, false, 2, 1, 48000, 48000);
+    ok &= Check("three channels at 32 kHz in, 48 kHz out", AudioNegotiator::Negotiate(array, 16000, 24000, 24000),
+        Plan(32000, 48000, 48000, true, false, 2.4f));
+    // 共用 32 kHz：输入 2.4%，输出不是 Opus 采样率，24 kHz 解码后再重采样 0.6%
+    auto array_shared = Caps({32000, 44100}, true, 2, 1, 32000, 32000);
+    ok &= Check("three channels, shared 32 kHz", AudioNegotiator::Negotiate(array_shared, 16000, 24000, 24000),
+        Plan(32000, 32000, 24000, true, true, 3.0f));
+
+    // 没有满足最低输出采样率的候选时保持当前配置
+    auto low = Caps({8000, 16000}, false, 1, 0, 16000, 22050);
+    ok &= Check("no candidate: keep current 16/22.05 kHz", AudioNegotiator::Negotiate(low, 16000, 24000, 24000),
+        Plan(16000, 22050, 24000, false, true, 0.6f));
+    auto fixed = Caps({16000}, true, 1, 1, 16000, 16000);
+    ok &= Check("no candidate: keep current 16 kHz", AudioNegotiator::Negotiate(fixed, 16000, 24000, 24000),
+        Plan(16000, 16000, 16000, false, false, 0));
+
+    // 设置采样率失败时按编解码器保留的 48/48 kHz 重新计算：3 路 48 kHz 输入 3.6%，输出可直接解码
+    ok &= Check("set rates failed: plan for the kept 48 kHz", AudioNegotiator::MakePlan(array, 48000, 48000, 16000, 24000),
+        Plan(48000, 48000, 48000, true, false, 3.6f));
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+# host evaluation of the delay-and-sum beamformer in main/audio_processing/mic_array.cc
+#
+# The samples go through the firmware's own MicArray, compiled for the host by
+# mic_array/mic_array_check.cc (which also checks it against known outputs):
+#
+#   g++ -std=c++17 -O2 -I../main/audio_processing -o mic_array_check mic_array/mic_array_check.cc ../main/audio_processing/mic_array.cc
+#
+# The beamformer is linear, so the target and the noise can be processed separately and the SNR
+# before (first mic) and after beamforming computed exactly. Fixtures are two multichannel 16 kHz
+# WAV files with the same layout as the device input (mics first, then reference channels):
+#
+#   python beamform_eval.py --synth fixtures/ --mics 4 --spacing 40 --source 0   # write fixtures
+#   python beamform_eval.py --mic-array ./mic_array_check --speech fixtures/speech.wav --noise fixtures/noise.wav --spacing 40 --steer 0
+#
+# The on-device CPU cost is reported by the beamform_us histogram (scripts/decode_metrics.py);
+# the cost printed here is the per-sample operation count of the same loop.
+import argparse
+import array
+import math
+import os
+import random
+import subprocess
+import sys
+import time
+import wave
+
+SPEED_OF_SOUND_MM_PER_S = 343000
+SAMPLE_RATE = 16000
+
+
+def read_wav(path):
+    with wave.open(path, "rb") as f:
+        if f.getsampwidth() != 2:
+            sys.exit(f"{path}: only 16-bit PCM is supported")
+        channels = f.getnchannels()
+        samples = array.array("h", f.readframes(f.getnframes()))
+        return channels, f.getframerate(), samples
+
+
+def write_wav(path, channels, samples):
+    with wave.open(path, "wb") as f:
+        f.setnchannels(channels)
+        f.setsampwidth(2)
+        f.setframerate(SAMPLE_RATE)
+        f.writeframes(array.array("h", samples).tobytes())
+
+
+def beamform(binary, samples, channels, ref_channels, spacing_mm, steer_degrees):
+    """Run the firmware's MicArray (mic_array_check --process) over the interleaved samples."""
+    result = subprocess.run([binary, "--process", str(channels), str(ref_channels), str(spacing_mm), str(steer_degrees)],
+                            input=samples.tobytes(), stdout=subprocess.PIPE, check=True)
+    return array.array("h", result.stdout)
+
+
+def power(values):
+    return sum(v * v for v in values) / max(len(values), 1)
+
+
+def synth(directory, mics, spacing_mm, source_degrees, seconds, seed):
+    random.seed(seed)
+    frames = int(seconds * SAMPLE_RATE)
+    # speech-like target: a few harmonics with a slow amplitude envelope
+    target = [int(6000 * (0.5 + 0.5 * math.sin(2 * math.pi * 3 * t / SAMPLE_RATE)) *
+                  sum(math.sin(2 * math.pi * f * t / SAMPLE_RATE) / (k + 1)
+                      for k, f in enumerate((220, 440, 660, 880))))
+              for t in range(frames)]
+    # arrival offsets in samples, fractional delays approximated by nearest sample
+    sin_theta = math.sin(math.radians(source_degrees))
+    offsets = [int(round(m * spacing_mm * sin_theta / SPEED_OF_SOUND_MM_PER_S * SAMPLE_RATE)) for m in range(mics)]
+    speech = []
+    noise = []
+    for t in range(frames):
+        for m in range(mics):
+            index = t - offsets[m]
+            speech.append(target[index] if index >= 0 else 0)
+            noise.append(int(random.gauss(0, 2000)))
+    os.makedirs(directory, exist_ok=True)
+    write_wav(os.path.join(directory, "speech.wav"), mics, speech)
+    write_wav(os.path.join(directory, "noise.wav"), mics, noise)
+    print(f"wrote {directory}/speech.wav and noise.wav: {mics} mics, {spacing_mm} mm, source at {source_degrees} degrees")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure delay-and-sum SNR gain on multichannel WAV fixtures")
+    parser.add_argument("--mic-array", default="./mic_array_check", help="mic_array_check binary built from the firmware sources")
+    parser.add_argument("--speech", help="target-only multichannel WAV")
+    parser.add_argument("--noise", help="noise-only multichannel WAV, same layout")
+    parser.add_argument("--refs", type=int, default=0, help="number of trailing reference channels")
+    parser.add_argument("--spacing", type=int, default=40, help="mic spacing in mm")
+    parser.add_argument("--steer", type=int, default=0, help="steering angle in degrees, 0 = broadside")
+    parser.add_argument("--synth", metavar="DIR", help="write synthetic fixtures to DIR and exit")
+    parser.add_argument("--mics", type=int, default=4)
+    parser.add_argument("--source", type=int, default=0, help="synthetic source angle in degrees")
+    parser.add_argument("--seconds", type=float, default=2.0)
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    if args.synth:
+        synth(args.synth, args.mics, args.spacing, args.source, args.seconds, args.seed)
+        return
+    if not args.speech or not args.noise:
+        parser.error("--speech and --noise are required unless --synth is given")
+
+    channels, rate, speech = read_wav(args.speech)
+    noise_channels, noise_rate, noise = read_wav(args.noise)
+    if (channels, rate) != (noise_channels, noise_rate):
+        sys.exit("speech and noise fixtures must have the same channel count and sample rate")
+    if rate != SAMPLE_RATE:
+        sys.exit(f"fixtures must be {SAMPLE_RATE} Hz like the device input")
+    mics = channels - args.refs
+
+    start = time.perf_counter()
+    speech_out = beamform(args.mic_array, speech, channels, args.refs, args.spacing, args.steer)
+    elapsed = time.perf_counter() - start
+    noise_out = beamform(args.mic_array, noise, channels, args.refs, args.spacing, args.steer)
+    out_channels = 1 + args.refs
+
+    snr_in = 10 * math.log10(power(speech[::channels]) / max(power(noise[::channels]), 1e-9))
+    snr_out = 10 * math.log10(power(speech_out[::out_channels]) / max(power(noise_out[::out_channels]), 1e-9))
+    frames = len(speech) // channels
+    print(f"mics {mics}, spacing {args.spacing} mm, steer {args.steer} degrees")
+    print(f"SNR mic 0 {snr_in:6.2f} dB, beamformed {snr_out:6.2f} dB, gain {snr_out - snr_in:+.2f} dB "
+          f"(ideal for uncorrelated noise {10 * math.log10(mics):+.2f} dB)")
+    print(f"cost: {mics} loads + {mics} adds + 1 multiply per output sample, "
+          f"{mics * rate // 1000} loads per ms of audio; host {elapsed * 1000:.0f} ms for {frames / rate:.1f} s")
+
+
+if __name__ == "__main__":
+    main()
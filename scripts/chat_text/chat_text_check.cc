@@ -0,0 +1,148 @@
+// Host check for the streaming chat text view (main/display/chat_text_view.cc)
+//
+// Compiles the firmware's ChatTextView unchanged against the LVGL stand-in in this directory
+// (80 px wide, 3 lines, 8 px ASCII and 16 px CJK glyphs) and drives it like the protocol task
+// and the LVGL timer do on the device:
+// - every line is centered;
+// - sentences appended one after another are separated by a space, except after whitespace or
+//   full-width punctuation, and a space that falls on a line break is not shown;
+// - text appended between two frames is merged into one insert per line, later text only
+//   redraws the last line, and a frame without new text redraws nothing;
+// - when the view is full the oldest line is recycled at the bottom, so the last 3 lines stay
+//   visible in order;
+// - a new role or Set clears the view.
+//
+//   g++ -std=c++17 -O2 -Ichat_text -I../main/display -o chat_text_check chat_text/chat_text_check.cc ../main/display/chat_text_view.cc
+//   ./chat_text_check
+//
+// (run from scripts/). Exits non-zero when a check fails.
+#include "chat_text_view.h"
+#include "frame_rate_governor.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// 只用到 GetMinFrameIntervalMs，其余成员不需要初始化
+FrameRateGovernor::FrameRateGovernor() {}
+
+static const lv_font_t kFont = {20};
+
+static bool Check(const char* name, bool ok) {
+    printf("%-60s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 按显示顺序取出每行文字
+static std::vector<std::string> Lines(lv_obj_t* screen) {
+    std::vector<std::string> lines;
+    for (auto label : screen->children[0]->children) {
+        lines.push_back(label->text);
+    }
+    return lines;
+}
+
+static std::vector<int> Redraws(lv_obj_t* screen) {
+    std::vector<int> redraws;
+    for (auto label : screen->children[0]->children) {
+        redraws.push_back(label->redraws);
+    }
+    return redraws;
+}
+
+static bool CheckLines(const char* name, lv_obj_t* screen, const std::vector<std::string>& expected) {
+    auto lines = Lines(screen);
+    bool ok = Check(name, lines == expected);
+    if (!ok) {
+        for (size_t i = 0; i < lines.size(); i++) {
+            printf("  line %zu: \"%s\", expected \"%s\"\n", i, lines[i].c_str(),
+                i < expected.size() ? expected[i].c_str() : "");
+        }
+    }
+    return ok;
+}
+
+int main() {
+    bool ok = true;
+    auto screen = lv_obj_create(nullptr);
+    auto view = new ChatTextView(screen, &kFont, 80, 3);
+
+    bool centered = screen->children[0]->children.size() == 3;
+    for (auto label : screen->children[0]->children) {
+        centered &= label->text_align == LV_TEXT_ALIGN_CENTER;
+    }
+    ok &= Check("three centered lines", centered);
+
+    view->Set("assistant", "");
+    lv_timer_handler();
+    // 两句在同一帧内到达，合并成每行一次插入
+    view->Append("assistant", "Hello.");
+    view->Append("assistant", "How are you?");
+    auto before = Redraws(screen);
+    lv_timer_handler();
+    auto after = Redraws(screen);
+    ok &= CheckLines("english sentences separated, space at the break dropped", screen,
+        {"Hello. How", "are you?", ""});
+    ok &= Check("one insert per line for text merged in one frame",
+        after[0] - before[0] == 1 && after[1] - before[1] == 1 && after[2] == before[2]);
+
+    before = Redraws(screen);
+    lv_timer_handler();
+    ok &= Check("frame without new text redraws nothing", Redraws(screen) == before);
+
+    view->Append("assistant", "Ok");
+    before = Redraws(screen);
+    lv_timer_handler();
+    after = Redraws(screen);
+    ok &= CheckLines("next sentence continues the last line", screen, {"Hello. How", "are you? O", "k"});
+    ok &= Check("only the lines that got text are redrawn",
+        after[0] == before[0] && after[1] - before[1] == 1 && after[2] - before[2] == 1);
+
+    view->Append("user", "Hi");
+    lv_timer_handler();
+    ok &= CheckLines("new role clears the view", screen, {"Hi", "", ""});
+    view->Append("assistant", "");
+    lv_timer_handler();
+    ok &= CheckLines("empty text from a new role clears too", screen, {"", "", ""});
+
+    view->Append("assistant", "你好。");
+    view->Append("assistant", "天气不错。");
+    lv_timer_handler();
+    ok &= CheckLines("no space after full-width punctuation", screen, {"你好。天气", "不错。", ""});
+
+    view->Set("assistant", "你好");
+    view->Append("assistant", "世界");
+    lv_timer_handler();
+    ok &= CheckLines("space between sentences without punctuation", screen, {"你好 世界", "", ""});
+
+    view->Set("assistant", "a\nb");
+    view->Append("assistant", " c");
+    lv_timer_handler();
+    ok &= CheckLines("newline and leading space kept", screen, {"a", "b c", ""});
+
+    // 每句一行，一句一帧：5 行滚动后只剩最后 3 行
+    view->Set("assistant", "");
+    const char* sentences[] = {"0123456789", "abcdefghij", "ABCDEFGHIJ", "klmnopqrst", "KLMNOPQRST"};
+    for (auto sentence : sentences) {
+        view->Append("assistant", sentence);
+        lv_timer_handler();
+    }
+    ok &= CheckLines("scrolls to keep the last three lines", screen, {"ABCDEFGHIJ", "klmnopqrst", "KLMNOPQRST"});
+    view->Append("assistant", "xy");
+    lv_timer_handler();
+    ok &= CheckLines("recycled line continues after scrolling", screen, {"klmnopqrst", "KLMNOPQRST", "xy"});
+
+    view->Set("user", "");
+    lv_timer_handler();
+    ok &= CheckLines("set with empty text clears after scrolling", screen, {"", "", ""});
+    view->Append("user", "0123456789abc");
+    lv_timer_handler();
+    ok &= CheckLines("long word breaks at the width", screen, {"0123456789", "abc", ""});
+
+    delete view;
+    ok &= Check("destructor removes the timer", lv_test_timers().empty());
+    lv_obj_delete(screen);
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// LVGL stand-in for the host check of main/display/chat_text_view.cc
+//
+// Implements only what ChatTextView and frame_rate_governor.h use. Objects keep their children
+// in order, labels keep their text, alignment and how often they were redrawn, and timers run
+// when the check calls lv_timer_handler(). Glyphs are 8 px wide for ASCII and 16 px otherwise.
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef int32_t lv_coord_t;
+typedef uint32_t lv_style_selector_t;
+
+struct lv_display_t;
+struct lv_color_t {
+    uint32_t full;
+};
+struct lv_font_t {
+    lv_coord_t line_height;
+};
+
+struct lv_obj_t {
+    lv_obj_t* parent = nullptr;
+    std::vector<lv_obj_t*> children;
+    std::string text;
+    lv_coord_t width = 0;
+    lv_coord_t height = 0;
+    int text_align = 0;
+    int redraws = 0;
+};
+
+struct lv_timer_t;
+typedef void (*lv_timer_cb_t)(lv_timer_t* timer);
+struct lv_timer_t {
+    lv_timer_cb_t callback;
+    uint32_t period;
+    void* user_data;
+};
+
+enum { LV_LABEL_LONG_CLIP = 4 };
+enum { LV_TEXT_ALIGN_AUTO, LV_TEXT_ALIGN_LEFT, LV_TEXT_ALIGN_CENTER, LV_TEXT_ALIGN_RIGHT };
+enum { LV_OPA_TRANSP = 0 };
+enum { LV_SCROLLBAR_MODE_OFF = 0 };
+enum { LV_OBJ_FLAG_SCROLLABLE = 1 << 4 };
+enum { LV_FLEX_FLOW_COLUMN = 1 };
+static constexpr uint32_t LV_LABEL_POS_LAST = 0xFFFF;
+
+inline std::vector<lv_timer_t*>& lv_test_timers() {
+    static std::vector<lv_timer_t*> timers;
+    return timers;
+}
+
+inline lv_obj_t* lv_obj_create(lv_obj_t* parent) {
+    auto obj = new lv_obj_t;
+    obj->parent = parent;
+    if (parent != nullptr) {
+        parent->children.push_back(obj);
+    }
+    return obj;
+}
+
+inline lv_obj_t* lv_label_create(lv_obj_t* parent) {
+    return lv_obj_create(parent);
+}
+
+inline void lv_obj_delete(lv_obj_t* obj) {
+    while (!obj->children.empty()) {
+        lv_obj_delete(obj->children.back());
+    }
+    if (obj->parent != nullptr) {
+        auto& siblings = obj->parent->children;
+        siblings.erase(std::find(siblings.begin(), siblings.end(), obj));
+    }
+    delete obj;
+}
+
+inline void lv_obj_set_size(lv_obj_t* obj, lv_coord_t width, lv_coord_t height) {
+    obj->width = width;
+    obj->height = height;
+}
+
+inline void lv_obj_move_to_index(lv_obj_t* obj, int32_t index) {
+    auto& siblings = obj->parent->children;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), obj));
+    siblings.insert(index < 0 ? siblings.end() + index + 1 : siblings.begin() + index, obj);
+}
+
+inline void lv_obj_set_style_text_align(lv_obj_t* obj, int align, lv_style_selector_t) {
+    obj->text_align = align;
+}
+
+inline void lv_obj_set_style_pad_all(lv_obj_t*, lv_coord_t, lv_style_selector_t) {}
+inline void lv_obj_set_style_pad_row(lv_obj_t*, lv_coord_t, lv_style_selector_t) {}
+inline void lv_obj_set_style_border_width(lv_obj_t*, lv_coord_t, lv_style_selector_t) {}
+inline void lv_obj_set_style_bg_opa(lv_obj_t*, int, lv_style_selector_t) {}
+inline void lv_obj_set_style_text_font(lv_obj_t*, const lv_font_t*, lv_style_selector_t) {}
+inline void lv_obj_set_style_text_color(lv_obj_t*, lv_color_t, lv_style_selector_t) {}
+inline void lv_obj_set_scrollbar_mode(lv_obj_t*, int) {}
+inline void lv_obj_clear_flag(lv_obj_t*, int) {}
+inline void lv_obj_set_flex_flow(lv_obj_t*, int) {}
+inline void lv_label_set_long_mode(lv_obj_t*, int) {}
+
+inline void lv_label_set_text(lv_obj_t* obj, const char* text) {
+    obj->text = text;
+    obj->redraws++;
+}
+
+inline void lv_label_ins_text(lv_obj_t* obj, uint32_t pos, const char* text) {
+    // the view only appends
+    if (pos == LV_LABEL_POS_LAST) {
+        obj->text += text;
+        obj->redraws++;
+    }
+}
+
+inline uint32_t lv_font_get_glyph_width(const lv_font_t*, uint32_t letter, uint32_t) {
+    return letter < 0x80 ? 8 : 16;
+}
+
+inline lv_timer_t* lv_timer_create(lv_timer_cb_t callback, uint32_t period, void* user_data) {
+    auto timer = new lv_timer_t{callback, period, user_data};
+    lv_test_timers().push_back(timer);
+    return timer;
+}
+
+inline void lv_timer_delete(lv_timer_t* timer) {
+    auto& timers = lv_test_timers();
+    timers.erase(std::find(timers.begin(), timers.end(), timer));
+    delete timer;
+}
+
+inline void lv_timer_set_period(lv_timer_t* timer, uint32_t period) {
+    timer->period = period;
+}
+
+inline void* lv_timer_get_user_data(lv_timer_t* timer) {
+    return timer->user_data;
+}
+
+// runs every timer once, as one pass of the LVGL task would when all of them are due
+inline void lv_timer_handler() {
+    auto timers = lv_test_timers();
+    for (auto timer : timers) {
+        timer->callback(timer);
+    }
+}
@@ -0,0 +1,180 @@
+// Host benchmark for the control message encodings in main/protocols/control_codec.h
+//
+// Builds typical control messages with ControlWriter in JSON and TLV mode, decodes them with
+// cJSON_Parse and DecodeControlFrame, checks that both decode to the same tree and prints the
+// encode/decode time and size of each message:
+//
+//   python -c "import gen_lang; gen_lang.generate_keywords('../main/assets/keywords.json', 'control/assets/keywords.h')"
+//   CJSON=$IDF_PATH/components/json/cJSON
+//   g++ -std=c++17 -O2 -Icontrol -I../main/protocols -I$CJSON -o control_bench control/control_bench.cc ../main/protocols/control_codec.cc $CJSON/cJSON.c
+//   ./control_bench
+//
+// (run from scripts/). Exits non-zero when a frame does not round trip. Sizes for a whole session,
+// including the server side messages, come from `python control_codec.py sizes`.
+#include "control_codec.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static const char* kSessionId = "a3f0c29e-5b1d-4c7e-9f2a-61d8e4b07c15";
+
+static void Hello(ControlWriter& w) {
+    w.BeginObject();
+    w.Key("type").String("hello");
+    w.Key("version").Int(1);
+    w.Key("transport").String("websocket");
+    w.Key("control").BeginArray().String(kControlEncodingTlv).EndArray();
+    w.Key("audio_params").BeginObject();
+    w.Key("format").String("opus");
+    w.Key("sample_rate").Int(16000);
+    w.Key("channels").Int(1);
+    w.Key("frame_duration").Int(60);
+    w.EndObject();
+    w.EndObject();
+}
+
+static void ListenStart(ControlWriter& w) {
+    w.BeginObject();
+    w.Key("session_id").String(kSessionId);
+    w.Key("type").String("listen");
+    w.Key("state").String("start");
+    w.Key("mode").String("auto");
+    w.EndObject();
+}
+
+static void IotStates(ControlWriter& w) {
+    w.BeginObject();
+    w.Key("session_id").String(kSessionId);
+    w.Key("type").String("iot");
+    w.Key("update").Bool(true);
+    w.Key("states");
+    w.Json("[{\"name\":\"Speaker\",\"state\":{\"volume\":70}},"
+           "{\"name\":\"Screen\",\"state\":{\"theme\":\"light\",\"brightness\":80}},"
+           "{\"name\":\"Battery\",\"state\":{\"level\":86,\"charging\":false}}]");
+    w.EndObject();
+}
+
+static void IotDescriptor(ControlWriter& w) {
+    static const char* descriptor =
+        "{\"name\":\"Speaker\",\"description\":\"扬声器\","
+        "\"properties\":{\"volume\":{\"description\":\"当前音量值\",\"type\":\"number\"}},"
+        "\"methods\":{\"SetVolume\":{\"description\":\"设置音量\","
+        "\"parameters\":{\"volume\":{\"description\":\"0到100之间的整数\",\"type\":\"number\"}}}}}";
+    w.BeginObject();
+    w.Key("session_id").String(kSessionId);
+    w.Key("type").String("iot");
+    w.Key("update").Bool(true);
+    w.Key("descriptors").BeginArray();
+    w.Json(descriptor);
+    w.EndArray();
+    w.EndObject();
+}
+
+static void IotResult(ControlWriter& w) {
+    w.BeginObject();
+    w.Key("session_id").String(kSessionId);
+    w.Key("type").String("iot");
+    w.Key("result").BeginObject();
+    w.Key("name").String("Speaker");
+    w.Key("method").String("SetVolume");
+    w.Key("status").String("ok");
+    w.Key("queued_ms").Int(2);
+    w.Key("duration_ms").Int(14);
+    w.EndObject();
+    w.EndObject();
+}
+
+static void TtsSentence(ControlWriter& w) {
+    w.BeginObject();
+    w.Key("session_id").String(kSessionId);
+    w.Key("type").String("tts");
+    w.Key("state").String("sentence_start");
+    w.Key("text").String("今天天气晴，最高气温二十六度。");
+    w.EndObject();
+}
+
+static void Abort(ControlWriter& w) {
+    w.BeginObject();
+    w.Key("session_id").String(kSessionId);
+    w.Key("type").String("abort");
+    w.Key("reason").String("wake_word_detected");
+    w.EndObject();
+}
+
+struct Message {
+    const char* name;
+    void (*build)(ControlWriter&);
+};
+
+template <typename F>
+static double NsPerCall(F f) {
+    const int rounds = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        f();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / rounds;
+}
+
+static std::string Print(const cJSON* root) {
+    char* text = cJSON_PrintUnformatted(root);
+    std::string result = text != nullptr ? text : "";
+    cJSON_free(text);
+    return result;
+}
+
+int main() {
+    const std::vector<Message> messages = {
+        { "hello", Hello },
+        { "listen start", ListenStart },
+        { "iot states", IotStates },
+        { "iot descriptor", IotDescriptor },
+        { "iot result", IotResult },
+        { "tts sentence", TtsSentence },
+        { "abort", Abort },
+    };
+
+    bool ok = true;
+    size_t json_total = 0, tlv_total = 0;
+    double json_encode_total = 0, tlv_encode_total = 0, json_decode_total = 0, tlv_decode_total = 0;
+    printf("%-15s %5s %5s | %9s %9s | %9s %9s\n", "message", "json", "tlv",
+           "enc json", "enc tlv", "dec json", "dec tlv");
+    for (const auto& message : messages) {
+        ControlWriter json(false), tlv(true);
+        message.build(json);
+        message.build(tlv);
+        const std::string& text = json.data();
+        const std::string& frame = tlv.data();
+
+        // 两种编码必须解出同一棵树
+        cJSON* from_json = cJSON_Parse(text.c_str());
+        cJSON* from_tlv = DecodeControlFrame(frame.data(), frame.size());
+        if (from_json == nullptr || from_tlv == nullptr || Print(from_json) != Print(from_tlv)) {
+            printf("%s: round trip mismatch\n  json %s\n  tlv  %s\n", message.name, text.c_str(),
+                   from_tlv != nullptr ? Print(from_tlv).c_str() : "(decode failed)");
+            ok = false;
+        }
+        cJSON_Delete(from_json);
+        cJSON_Delete(from_tlv);
+
+        double json_encode = NsPerCall([&]() { ControlWriter w(false); message.build(w); });
+        double tlv_encode = NsPerCall([&]() { ControlWriter w(true); message.build(w); });
+        double json_decode = NsPerCall([&]() { cJSON_Delete(cJSON_Parse(text.c_str())); });
+        double tlv_decode = NsPerCall([&]() { cJSON_Delete(DecodeControlFrame(frame.data(), frame.size())); });
+        printf("%-15s %5zu %5zu | %7.0f ns %7.0f ns | %7.0f ns %7.0f ns\n", message.name, text.size(), frame.size(),
+               json_encode, tlv_encode, json_decode, tlv_decode);
+        json_total += text.size();
+        tlv_total += frame.size();
+        json_encode_total += json_encode;
+        tlv_encode_total += tlv_encode;
+        json_decode_total += json_decode;
+        tlv_decode_total += tlv_decode;
+    }
+    printf("%-15s %5zu %5zu | %7.0f ns %7.0f ns | %7.0f ns %7.0f ns\n", "total", json_total, tlv_total,
+           json_encode_total, tlv_encode_total, json_decode_total, tlv_decode_total);
+    return ok ? 0 : 1;
+}
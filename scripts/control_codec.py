@@ -0,0 +1,286 @@
+# reference implementation of the "tlv1" binary control encoding (see main/protocols/control_codec.h)
+#
+# A control frame is 0xFF, version 1, then one value. Values are a tag byte plus data:
+#   0x00 end of object/array   0x01 false   0x02 true   0x03 null
+#   0x04 integer, zigzag varint           0x05 double, 8 bytes little-endian
+#   0x06 string, varint length + UTF-8    0x08 object, key/value pairs until 0x00
+#   0x09 array, values until 0x00         0x80 | id  dictionary word (key or value)
+# The dictionary is the ControlWord group of main/assets/keywords.json; word ids are its
+# 1-based positions, so the list is append-only.
+#
+#   python control_codec.py sizes      # JSON vs TLV bytes for a typical session
+#   python control_codec.py check      # round trip every message of the typical session
+import argparse
+import json
+import os
+import struct
+import sys
+
+MAGIC = 0xFF
+VERSION = 1
+KEYWORDS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "main", "assets", "keywords.json")
+
+
+def load_words(path=KEYWORDS):
+    with open(path, "r", encoding="utf-8") as f:
+        words = json.load(f)["ControlWord"]
+    if len(words) > 127:
+        raise ValueError("ControlWord must have at most 127 entries")
+    return words
+
+
+WORDS = load_words()
+WORD_IDS = {word: i + 1 for i, word in enumerate(WORDS)}
+
+
+def is_control_frame(data):
+    return len(data) >= 3 and data[0] == MAGIC and data[1] == VERSION
+
+
+def _varint(value, out):
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+
+
+def _text(text, out):
+    word = WORD_IDS.get(text)
+    if word is not None:
+        out.append(0x80 | word)
+        return
+    data = text.encode("utf-8")
+    out.append(0x06)
+    _varint(len(data), out)
+    out += data
+
+
+def _value(value, out):
+    if value is None:
+        out.append(0x03)
+    elif value is True:
+        out.append(0x02)
+    elif value is False:
+        out.append(0x01)
+    elif isinstance(value, int) or (isinstance(value, float) and value.is_integer() and abs(value) < 9e15):
+        value = int(value)
+        out.append(0x04)
+        _varint((value << 1) ^ (value >> 63) if value < 0 else value << 1, out)
+    elif isinstance(value, float):
+        out.append(0x05)
+        out += struct.pack("<d", value)
+    elif isinstance(value, str):
+        _text(value, out)
+    elif isinstance(value, dict):
+        out.append(0x08)
+        for key, item in value.items():
+            _text(key, out)
+            _value(item, out)
+        out.append(0x00)
+    elif isinstance(value, (list, tuple)):
+        out.append(0x09)
+        for item in value:
+            _value(item, out)
+        out.append(0x00)
+    else:
+        raise TypeError(f"cannot encode {type(value).__name__}")
+
+
+def encode(message):
+    out = bytearray([MAGIC, VERSION])
+    _value(message, out)
+    return bytes(out)
+
+
+class _Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise ValueError("truncated control frame")
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7F) << shift
+            if not b & 0x80:
+                return value
+            shift += 7
+            if shift >= 64:
+                raise ValueError("varint too long")
+
+    def text(self, tag):
+        if tag & 0x80:
+            word = tag & 0x7F
+            if not 1 <= word <= len(WORDS):
+                raise ValueError(f"unknown word {word}")
+            return WORDS[word - 1]
+        if tag != 0x06:
+            raise ValueError(f"expected a string, got tag {tag:#x}")
+        size = self.varint()
+        if self.pos + size > len(self.data):
+            raise ValueError("truncated string")
+        self.pos += size
+        return self.data[self.pos - size:self.pos].decode("utf-8")
+
+    def value(self, tag, depth=0):
+        if depth > 16:
+            raise ValueError("nested too deeply")
+        if tag == 0x01:
+            return False
+        if tag == 0x02:
+            return True
+        if tag == 0x03:
+            return None
+        if tag == 0x04:
+            zigzag = self.varint()
+            return (zigzag >> 1) ^ -(zigzag & 1)
+        if tag == 0x05:
+            if self.pos + 8 > len(self.data):
+                raise ValueError("truncated double")
+            self.pos += 8
+            return struct.unpack_from("<d", self.data, self.pos - 8)[0]
+        if tag == 0x08:
+            result = {}
+            while True:
+                tag = self.byte()
+                if tag == 0x00:
+                    return result
+                key = self.text(tag)
+                result[key] = self.value(self.byte(), depth + 1)
+        if tag == 0x09:
+            result = []
+            while True:
+                tag = self.byte()
+                if tag == 0x00:
+                    return result
+                result.append(self.value(tag, depth + 1))
+        return self.text(tag)
+
+
+def decode(data):
+    if not is_control_frame(data):
+        raise ValueError("not a control frame")
+    reader = _Reader(data)
+    reader.pos = 2
+    message = reader.value(reader.byte())
+    if reader.pos != len(data):
+        raise ValueError("trailing bytes after control frame")
+    return message
+
+
+def to_json(message):
+    return json.dumps(message, ensure_ascii=False, separators=(",", ":")).encode("utf-8")
+
+
+SPEAKER = {
+    "name": "Speaker", "description": "扬声器",
+    "properties": {"volume": {"description": "当前音量值", "type": "number"}},
+    "methods": {"SetVolume": {"description": "设置音量",
+                              "parameters": {"volume": {"description": "0到100之间的整数", "type": "number"}}}},
+}
+SCREEN = {
+    "name": "Screen", "description": "屏幕",
+    "properties": {"theme": {"description": "主题", "type": "string"},
+                   "brightness": {"description": "当前亮度百分比", "type": "number"}},
+    "methods": {"SetTheme": {"description": "设置屏幕主题",
+                             "parameters": {"theme_name": {"description": "主题模式, light 或 dark", "type": "string"}}},
+                "SetBrightness": {"description": "设置亮度",
+                                  "parameters": {"brightness": {"description": "0到100之间的整数", "type": "number"}}}},
+}
+STATES = [{"name": "Speaker", "state": {"volume": 70}},
+          {"name": "Screen", "state": {"theme": "light", "brightness": 80}},
+          {"name": "Battery", "state": {"level": 86, "charging": False}}]
+
+
+def typical_session(session_id="a3f0c29e-5b1d-4c7e-9f2a-61d8e4b07c15"):
+    """(direction, name, message) for one wake word conversation with two replies."""
+    s = session_id
+    sentences = ["你好，我在呢。", "今天天气晴，最高气温二十六度。", "出门记得带上水杯哦。"]
+    messages = [
+        ("up", "hello", {"type": "hello", "version": 1, "transport": "websocket", "control": ["tlv1"],
+                         "audio_params": {"format": "opus", "sample_rate": 16000, "channels": 1,
+                                          "frame_duration": 60}}),
+        ("down", "hello", {"type": "hello", "transport": "websocket", "session_id": s, "control": "tlv1",
+                           "audio_params": {"sample_rate": 24000, "frame_duration": 60}}),
+        ("up", "iot descriptors", {"session_id": s, "type": "iot", "update": True, "descriptors": [SPEAKER]}),
+        ("up", "iot descriptors", {"session_id": s, "type": "iot", "update": True, "descriptors": [SCREEN]}),
+        ("up", "iot states", {"session_id": s, "type": "iot", "update": True, "states": STATES}),
+        ("up", "listen detect", {"session_id": s, "type": "listen", "state": "detect", "text": "你好小鱼"}),
+        ("up", "listen start", {"session_id": s, "type": "listen", "state": "start", "mode": "auto"}),
+        ("down", "stt", {"session_id": s, "type": "stt", "text": "今天天气怎么样"}),
+        ("down", "llm", {"session_id": s, "type": "llm", "text": "😊", "emotion": "happy"}),
+        ("down", "tts start", {"session_id": s, "type": "tts", "state": "start"}),
+    ]
+    for text in sentences:
+        messages.append(("down", "tts sentence", {"session_id": s, "type": "tts", "state": "sentence_start",
+                                                  "text": text}))
+    messages += [
+        ("down", "tts stop", {"session_id": s, "type": "tts", "state": "stop"}),
+        ("up", "iot states", {"session_id": s, "type": "iot", "update": True,
+                              "states": [{"name": "Speaker", "state": {"volume": 80}}]}),
+        ("up", "listen start", {"session_id": s, "type": "listen", "state": "start", "mode": "auto"}),
+        ("down", "stt", {"session_id": s, "type": "stt", "text": "把音量调到八十"}),
+        ("down", "iot command", {"session_id": s, "type": "iot", "commands": [
+            {"name": "Speaker", "method": "SetVolume", "parameters": {"volume": 80}}]}),
+        ("up", "iot result", {"session_id": s, "type": "iot", "result": {
+            "name": "Speaker", "method": "SetVolume", "status": "ok", "queued_ms": 2, "duration_ms": 14}}),
+        ("down", "tts start", {"session_id": s, "type": "tts", "state": "start"}),
+        ("down", "tts sentence", {"session_id": s, "type": "tts", "state": "sentence_start",
+                                  "text": "好的，音量已经调到八十。"}),
+        ("up", "abort", {"session_id": s, "type": "abort", "reason": "wake_word_detected"}),
+        ("up", "listen stop", {"session_id": s, "type": "listen", "state": "stop"}),
+        ("up", "text2speech", {"session_id": s, "type": "text2speech", "text": "血压计蓝牙已连接"}),
+        ("up", "goodbye", {"session_id": s, "type": "goodbye"}),
+    ]
+    return messages
+
+
+def sizes():
+    totals = {"up": [0, 0], "down": [0, 0]}
+    print(f"{'dir':4s} {'message':16s} {'json':>6s} {'tlv':>6s} {'ratio':>6s}")
+    for direction, name, message in typical_session():
+        json_size = len(to_json(message))
+        tlv_size = len(encode(message))
+        totals[direction][0] += json_size
+        totals[direction][1] += tlv_size
+        print(f"{direction:4s} {name:16s} {json_size:6d} {tlv_size:6d} {tlv_size / json_size:6.0%}")
+    for direction, (json_size, tlv_size) in totals.items():
+        print(f"{direction:4s} {'total':16s} {json_size:6d} {tlv_size:6d} {tlv_size / json_size:6.0%}")
+
+
+def check():
+    failures = 0
+    for _, name, message in typical_session():
+        if decode(encode(message)) != message:
+            print(f"round trip mismatch: {name}")
+            failures += 1
+    for bad in (b"\xff\x01", b"\xff\x01\x08\x81", b"\xff\x01\x06\x05ab", b"\xff\x01\xff", b"\xff\x01\x02\x02"):
+        try:
+            decode(bad)
+            print(f"accepted malformed frame {bad.hex()}")
+            failures += 1
+        except ValueError:
+            pass
+    print("ok" if failures == 0 else f"{failures} failures")
+    return failures == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="tlv1 control encoding reference codec")
+    parser.add_argument("command", choices=["sizes", "check"])
+    args = parser.parse_args()
+    if args.command == "sizes":
+        sizes()
+    elif not check():
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,64 @@
+# decode the metrics snapshot reported by the device ({"type":"metrics","format":"bin","data":"..."})
+import argparse
+import base64
+import json
+import struct
+import sys
+
+COUNTERS = ["audio_packets_sent", "audio_packets_received", "audio_packets_dropped", "opus_decode_errors",
+            "tls_handshakes", "tls_resumed"]
+GAUGES = ["decode_queue_depth", "background_tasks", "free_internal_heap", "min_free_internal_heap",
+          "largest_internal_block", "free_spiram_heap"]
+HISTOGRAMS = ["opus_encode_us", "opus_decode_us", "send_audio_us", "afe_fetch_wait_us", "lvgl_frame_us",
+              "wake_to_listen_us", "tls_handshake_us", "capture_to_feed_us", "beamform_us",
+              "wake_connect_us", "wake_upload_us", "wake_handoff_gap_us", "tts_tail_us",
+              "turnaround_us"]
+BUCKET_BOUNDS = [500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000]
+
+
+def decode_snapshot(data):
+    magic, version, n_counters, n_gauges, n_histograms, n_buckets, _ = struct.unpack_from("<BBBBBBH", data, 0)
+    # version 1 had a 32-bit sum_us, version 2 widened it to 64 bits
+    if magic != ord("M") or version not in (1, 2):
+        raise ValueError(f"unsupported snapshot magic={magic} version={version}")
+    offset = 8
+    (uptime,) = struct.unpack_from("<I", data, offset)
+    offset += 4
+
+    counters = struct.unpack_from(f"<{n_counters}I", data, offset)
+    offset += n_counters * 4
+    gauges = struct.unpack_from(f"<{n_gauges}i", data, offset)
+    offset += n_gauges * 4
+
+    result = {"uptime_s": uptime, "counters": {}, "gauges": {}, "histograms": {}}
+    for i, value in enumerate(counters):
+        result["counters"][COUNTERS[i] if i < len(COUNTERS) else f"counter_{i}"] = value
+    for i, value in enumerate(gauges):
+        result["gauges"][GAUGES[i] if i < len(GAUGES) else f"gauge_{i}"] = value
+    for i in range(n_histograms):
+        header = "<3I" if version == 1 else "<IQI"
+        count, sum_us, max_us = struct.unpack_from(header, data, offset)
+        offset += struct.calcsize(header)
+        buckets = struct.unpack_from(f"<{n_buckets}I", data, offset)
+        offset += n_buckets * 4
+        name = HISTOGRAMS[i] if i < len(HISTOGRAMS) else f"histogram_{i}"
+        labels = [f"<={b}" for b in BUCKET_BOUNDS] + [">" + str(BUCKET_BOUNDS[-1])]
+        result["histograms"][name] = {
+            "count": count,
+            "avg_us": sum_us // count if count else 0,
+            "max_us": max_us,
+            "buckets": dict(zip(labels, buckets)),
+        }
+    return result
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Decode device metrics snapshot")
+    parser.add_argument("input", nargs="?", help="JSON message or base64 data, read from stdin if omitted")
+    args = parser.parse_args()
+
+    text = args.input if args.input else sys.stdin.read()
+    text = text.strip()
+    if text.startswith("{"):
+        text = json.loads(text)["data"]
+    print(json.dumps(decode_snapshot(base64.b64decode(text)), indent=2))
@@ -3,6 +3,8 @@ import argparse
 import json
 import os
 
+import sound_bundle
+
 HEADER_TEMPLATE = """// Auto-generated language config
 #pragma once
 
@@ -28,7 +30,7 @@ namespace Lang {{
 }}
 """
 
-def generate_header(input_path, output_path):
+def generate_header(input_path, output_path, bundle_path=None):
     with open(input_path, 'r', encoding='utf-8') as f:
         data = json.load(f)
 
@@ -46,22 +48,25 @@ def generate_header(input_path, output_path):
         strings.append(f'        constexpr const char* {key.upper()} = "{value}";')
 
     # 生成音效常量
-    for file in os.listdir(os.path.dirname(input_path)):
-        if file.endswith('.p3'):
-            base_name = os.path.splitext(file)[0]
-            sounds.append(f'''
-        extern const char p3_{base_name}_start[] asm("_binary_{base_name}_p3_start");
-        extern const char p3_{base_name}_end[] asm("_binary_{base_name}_p3_end");
-        static const std::string_view P3_{base_name.upper()} {{
-        static_cast<const char*>(p3_{base_name}_start),
-        static_cast<size_t>(p3_{base_name}_end - p3_{base_name}_start)
-        }};''')
-    
-    # 生成公共音效
-    for file in os.listdir(os.path.join(os.path.dirname(output_path), 'common')):
-        if file.endswith('.p3'):
-            base_name = os.path.splitext(file)[0]
-            sounds.append(f'''
+    sound_dirs = [os.path.dirname(input_path), os.path.join(os.path.dirname(output_path), 'common')]
+    if bundle_path:
+        # 所有音效打包成一个带索引的 sounds.bin，常量直接指向包内偏移，内容相同的音效只存一份
+        bundle, index, stats = sound_bundle.build(sound_bundle.collect(sound_dirs))
+        os.makedirs(os.path.dirname(bundle_path), exist_ok=True)
+        with open(bundle_path, 'wb') as f:
+            f.write(bundle)
+        print(f"Sound bundle: {sound_bundle.format_stats(stats)}")
+        symbol = os.path.basename(bundle_path).replace('.', '_').replace('-', '_')
+        sounds.append(f'        extern const char p3_bundle_start[] asm("_binary_{symbol}_start");')
+        for name, (offset, size, duration, packets) in index.items():
+            sounds.append(f'        static const std::string_view P3_{name.upper()} {{ p3_bundle_start + {offset}, {size} }};'
+                          f'  // {duration} ms, {packets} packets')
+    else:
+        for sound_dir in sound_dirs:
+            for file in os.listdir(sound_dir):
+                if file.endswith('.p3'):
+                    base_name = os.path.splitext(file)[0]
+                    sounds.append(f'''
         extern const char p3_{base_name}_start[] asm("_binary_{base_name}_p3_start");
         extern const char p3_{base_name}_end[] asm("_binary_{base_name}_p3_end");
         static const std::string_view P3_{base_name.upper()} {{
@@ -82,10 +87,114 @@ def generate_header(input_path, output_path):
     with open(output_path, 'w', encoding='utf-8') as f:
         f.write(content)
 
+KEYWORDS_TEMPLATE = """// Auto-generated keyword tables
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+// 协议消息类型、状态、表情名和 IoT 方法名的完美哈希表，查找只需一次哈希和一次比较
+namespace Keys {{
+    // FNV-1a，seed 异或进初值，与 scripts/gen_lang.py 一致；乘法只向高位扩散，所以槽号取高位
+    constexpr uint32_t Hash(std::string_view text, uint32_t seed) {{
+        uint32_t hash = 0x811C9DC5u ^ seed;
+        for (char c : text) {{
+            hash = (hash ^ static_cast<uint8_t>(c)) * 0x01000193u;
+        }}
+        return hash;
+    }}
+{groups}
+}}
+"""
+
+GROUP_TEMPLATE = """
+    namespace {group} {{
+        enum Id : uint8_t {{
+            kUnknown,
+{ids}
+            kCount
+        }};
+        constexpr std::string_view kNames[] = {{
+            "",
+{names}
+        }};
+        constexpr uint32_t kSeed = {seed};
+        constexpr uint8_t kSlots[{table_size}] = {{ {slots} }};
+        constexpr Id Lookup(std::string_view text) {{
+            Id id = static_cast<Id>(kSlots[Hash(text, kSeed) >> {shift}]);
+            return kNames[id] == text ? id : kUnknown;
+        }}
+        constexpr std::string_view Name(Id id) {{
+            return id < kCount ? kNames[id] : kNames[kUnknown];
+        }}
+    }}"""
+
+
+def keyword_hash(text, seed):
+    h = 0x811C9DC5 ^ seed
+    for b in text.encode('utf-8'):
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def find_perfect_hash(names):
+    # 找一个 seed 让所有名字落在不同的槽里（槽号取哈希高位），找不到就把表扩大一倍
+    # 表太小时几乎不可能无冲突（概率约 exp(-n^2/2m)），直接从有希望的大小开始，避免白白搜索 65536 个 seed
+    bits = 1
+    while (1 << bits) < len(names) or len(names) * len(names) > 22 * (1 << bits):
+        bits += 1
+    while True:
+        for seed in range(1 << 16):
+            slots = {keyword_hash(name, seed) >> (32 - bits) for name in names}
+            if len(slots) == len(names):
+                return seed, bits
+        bits += 1
+
+
+def keyword_id(name):
+    return 'k' + ''.join(part[:1].upper() + part[1:] for part in name.split('_'))
+
+
+def generate_keywords(input_path, output_path):
+    with open(input_path, 'r', encoding='utf-8') as f:
+        data = json.load(f)
+
+    groups = []
+    for group, names in data.items():
+        if len(set(names)) != len(names) or len(names) >= 255:
+            raise ValueError(f"Invalid keyword group {group}")
+        ids = [keyword_id(name) for name in names]
+        if len(set(ids)) != len(ids):
+            raise ValueError(f"Keyword identifiers collide in {group}")
+        seed, bits = find_perfect_hash(names)
+        table_size = 1 << bits
+        slots = [0] * table_size
+        for index, name in enumerate(names):
+            slots[keyword_hash(name, seed) >> (32 - bits)] = index + 1
+        groups.append(GROUP_TEMPLATE.format(
+            group=group,
+            ids="\n".join(f'            {i},' for i in ids),
+            names="\n".join(f'            "{name}",' for name in names),
+            seed=seed,
+            table_size=table_size,
+            slots=", ".join(str(slot) for slot in slots),
+            shift=32 - bits,
+        ))
+
+    os.makedirs(os.path.dirname(output_path), exist_ok=True)
+    with open(output_path, 'w', encoding='utf-8') as f:
+        f.write(KEYWORDS_TEMPLATE.format(groups="\n".join(groups)))
+
+
 if __name__ == "__main__":
     parser = argparse.ArgumentParser()
     parser.add_argument("--input", required=True, help="输入JSON文件路径")
     parser.add_argument("--output", required=True, help="输出头文件路径")
+    parser.add_argument("--bundle", help="输出音效包路径，不指定时每个音效单独嵌入")
+    parser.add_argument("--keywords", help="关键字 JSON 文件路径")
+    parser.add_argument("--keywords-output", help="输出关键字哈希表头文件路径")
     args = parser.parse_args()
 
-    generate_header(args.input, args.output)
\ No newline at end of file
+    generate_header(args.input, args.output, args.bundle)
+    if args.keywords and args.keywords_output:
+        generate_keywords(args.keywords, args.keywords_output)
\ No newline at end of file
@@ -0,0 +1,72 @@
+// malloc interposer for the host build of main/heap_tracker.cc
+//
+// Linked into a host program, these definitions replace the C library's malloc family (glibc
+// only, they forward to the __libc_* entry points) and report every allocation and free to the
+// same esp_heap_trace_alloc_hook / esp_heap_trace_free_hook that the IDF heap calls on the
+// device, so HeapTracker counts per-tag allocations on the host exactly as it does there.
+// operator new/delete in libstdc++ go through malloc/free and are counted as well.
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+
+void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps);
+void esp_heap_trace_free_hook(void* ptr);
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    esp_heap_trace_alloc_hook(ptr, size, 0);
+    return ptr;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    esp_heap_trace_alloc_hook(ptr, count * size, 0);
+    return ptr;
+}
+
+// like heap_caps_realloc on the device: a move counts as a free plus an allocation
+void* realloc(void* ptr, size_t size) {
+    void* result = __libc_realloc(ptr, size);
+    if (ptr == nullptr) {
+        esp_heap_trace_alloc_hook(result, size, 0);
+    } else if (size == 0) {
+        esp_heap_trace_free_hook(ptr);
+    } else if (result != nullptr && result != ptr) {
+        esp_heap_trace_free_hook(ptr);
+        esp_heap_trace_alloc_hook(result, size, 0);
+    }
+    return result;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    void* ptr = __libc_memalign(alignment, size);
+    esp_heap_trace_alloc_hook(ptr, size, 0);
+    return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+    void* ptr = memalign(alignment, size);
+    if (ptr == nullptr) {
+        return ENOMEM;
+    }
+    *result = ptr;
+    return 0;
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+    // same order as the IDF hook: the block is already gone
+    esp_heap_trace_free_hook(ptr);
+}
+}
@@ -0,0 +1,142 @@
+// Host check for the heap tracker (main/heap_tracker.cc) through the malloc interposer
+//
+// Compiles the firmware's HeapTracker without IDF and links heap_interposer.cc, which routes
+// malloc/free into the same hooks the IDF heap calls on the device:
+// - allocations and frees land on the tag of the calling thread, HeapTagScope nests and restores;
+// - threads keep their own tag, like FreeRTOS tasks;
+// - realloc that moves a block counts as a free plus an allocation;
+// - more than 2000 allocations between two ticks is reported as a storm;
+// - Tick records one history sample per interval into the ring.
+//
+//   g++ -std=c++17 -O2 -pthread -I../main -o heap_tracker_check heap_tracker/heap_tracker_check.cc heap_tracker/heap_interposer.cc ../main/heap_tracker.cc
+//   ./heap_tracker_check
+//
+// (run from scripts/). Exits non-zero when a check fails.
+#include "heap_tracker.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// volatile so the compiler cannot pair up and drop the malloc/free calls
+static void* volatile blocks[4096];
+
+static bool Check(const char* name, bool ok) {
+    printf("%-52s %s\n", name, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// 从 GetJson 的输出里取某个标签的计数
+static long Field(const std::string& json, const char* tag, const char* field) {
+    auto pos = json.find("\"" + std::string(tag) + "\":{");
+    if (pos == std::string::npos) {
+        return -1;
+    }
+    pos = json.find("\"" + std::string(field) + "\":", pos);
+    return pos == std::string::npos ? -1 : atol(json.c_str() + pos + strlen(field) + 3);
+}
+
+static long Storms(const std::string& json) {
+    auto pos = json.find("\"storms\":");
+    return pos == std::string::npos ? -1 : atol(json.c_str() + pos + 9);
+}
+
+static void AllocateAndFree(int count, size_t size) {
+    for (int i = 0; i < count; i++) {
+        blocks[i] = malloc(size);
+    }
+    for (int i = 0; i < count; i++) {
+        free(blocks[i]);
+    }
+}
+
+int main() {
+    auto& tracker = HeapTracker::GetInstance();
+    bool ok = true;
+    tracker.Tick();
+
+    ok &= Check("default tag is other", HeapTracker::GetTaskTag() == kHeapTagOther);
+
+    auto before = tracker.GetJson();
+    {
+        HeapTagScope audio(kHeapTagAudio);
+        AllocateAndFree(100, 64);
+    }
+    auto after = tracker.GetJson();
+    ok &= Check("100 x 64 bytes counted on audio",
+        Field(after, "audio", "allocs") - Field(before, "audio", "allocs") == 100 &&
+        Field(after, "audio", "alloc_bytes") - Field(before, "audio", "alloc_bytes") == 6400 &&
+        Field(after, "audio", "frees") - Field(before, "audio", "frees") == 100);
+    ok &= Check("scope restores the previous tag", HeapTracker::GetTaskTag() == kHeapTagOther);
+
+    {
+        HeapTagScope display(kHeapTagDisplay);
+        {
+            HeapTagScope iot(kHeapTagIot);
+            ok &= Check("nested scope", HeapTracker::GetTaskTag() == kHeapTagIot);
+        }
+        ok &= Check("inner scope restores the outer tag", HeapTracker::GetTaskTag() == kHeapTagDisplay);
+    }
+
+    before = tracker.GetJson();
+    HeapTag main_tag_during_thread = kHeapTagCount;
+    {
+        HeapTagScope ota(kHeapTagOta);
+        std::thread worker([] {
+            HeapTracker::SetTaskTag(kHeapTagProtocol);
+            AllocateAndFree(10, 16);
+        });
+        worker.join();
+        main_tag_during_thread = HeapTracker::GetTaskTag();
+    }
+    after = tracker.GetJson();
+    // libstdc++ 在线程里释放自己的启动状态，释放次数可能多一次
+    ok &= Check("thread allocations go to the thread's tag",
+        Field(after, "protocol", "allocs") - Field(before, "protocol", "allocs") == 10 &&
+        Field(after, "protocol", "frees") - Field(before, "protocol", "frees") >= 10 &&
+        main_tag_during_thread == kHeapTagOta);
+
+    before = tracker.GetJson();
+    {
+        HeapTagScope iot(kHeapTagIot);
+        // 中间留一个块，让 realloc 只能搬走
+        blocks[0] = malloc(16);
+        blocks[1] = malloc(16);
+        blocks[0] = realloc(blocks[0], 1 << 20);
+        free(blocks[0]);
+        free(blocks[1]);
+    }
+    after = tracker.GetJson();
+    ok &= Check("moving realloc counts a free and an allocation",
+        Field(after, "iot", "allocs") - Field(before, "iot", "allocs") == 3 &&
+        Field(after, "iot", "frees") - Field(before, "iot", "frees") == 3);
+
+    tracker.Tick();
+    long storms = Storms(tracker.GetJson());
+    tracker.Tick();
+    ok &= Check("quiet second is not a storm", Storms(tracker.GetJson()) == storms);
+    {
+        HeapTagScope display(kHeapTagDisplay);
+        AllocateAndFree(2500, 32);
+    }
+    tracker.Tick();
+    ok &= Check("2500 allocations in one tick is a storm", Storms(tracker.GetJson()) == storms + 1);
+
+    for (int i = 0; i < 3; i++) {
+        tracker.Tick(1);
+    }
+    auto json = tracker.GetJson();
+    auto history = json.substr(json.find("\"history\":[") + 11);
+    int samples = 0;
+    for (char c : history) {
+        samples += c == '[';
+    }
+    auto sample = tracker.TakeSample();
+    ok &= Check("one history sample per interval",
+        samples == 3 && sample.frag_internal <= 1000 && sample.free_internal > 0);
+
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+// Host replay of scripted input timelines through main/boards/common/gesture_recognizer.cc
+//
+//   g++ -std=c++17 -O2 -I ../../main/boards/common input_replay.cc
+//       ../../main/boards/common/gesture_recognizer.cc -o input_replay
+//   ./input_replay timelines/*.txt
+//
+// Timeline format, one item per line, times in milliseconds, '#' starts a comment:
+//
+//   multiclick <source>                  enable double/multi click for a button (as OnGesture does)
+//   <t> down <source>                    button pressed
+//   <t> up <source>                      button released
+//   <t> rotate <source> <+1|-1>          knob step
+//   expect <t> <gesture...>              gesture expected at logical time t, in order
+//   mainloop <t>                         Application's main loop starts at t; every gesture
+//                                        recognized before t must also be dispatched before t
+//
+// Events are delivered like the input_events task of InputEventBus does on the device: the task
+// wakes for the next event or the next recognizer deadline, whichever comes first, and runs the
+// handlers itself. Nothing waits for the main loop, so buttons work while Application::Start is
+// still connecting, activating or checking for a new version.
+//
+// Gestures are printed as "click 0", "double_click 0", "multi_click 0 x3", "long_press 2",
+// "hold_rotate 0 knob 5 +1", "rotate 5 -1" and "chord 0 1". A timeline without expect lines
+// just prints what was recognized, which is how new timelines are written.
+#include "gesture_recognizer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Recognized {
+    int64_t time_ms;
+    std::string text;
+    int64_t dispatch_ms = 0;    // 处理函数被调用的时刻
+};
+
+static std::string Describe(const InputGesture& gesture) {
+    char text[64];
+    switch (gesture.type) {
+        case kGestureClick:
+            snprintf(text, sizeof(text), "click %d", gesture.source);
+            break;
+        case kGestureDoubleClick:
+            snprintf(text, sizeof(text), "double_click %d", gesture.source);
+            break;
+        case kGestureMultiClick:
+            snprintf(text, sizeof(text), "multi_click %d x%d", gesture.source, gesture.count);
+            break;
+        case kGestureLongPress:
+            snprintf(text, sizeof(text), "long_press %d", gesture.source);
+            break;
+        case kGestureHoldRotate:
+            snprintf(text, sizeof(text), "hold_rotate %d knob %d %+d", gesture.source, gesture.other, gesture.direction);
+            break;
+        case kGestureRotate:
+            snprintf(text, sizeof(text), "rotate %d %+d", gesture.source, gesture.direction);
+            break;
+        case kGestureChord:
+            snprintf(text, sizeof(text), "chord %d %d", gesture.source, gesture.other);
+            break;
+    }
+    return text;
+}
+
+static bool Replay(const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    GestureRecognizer recognizer;
+    std::vector<Recognized> recognized;
+    std::vector<Recognized> expected;
+    int64_t now_us = 0;
+    int64_t main_loop_ms = -1;
+    auto emit = [&](const InputGesture& gesture) {
+        recognized.push_back({gesture.timestamp_us / 1000, Describe(gesture), now_us / 1000});
+    };
+    // 与 InputEventBus::EventLoop 相同：到了截止时间就醒来 Poll，不等下一个事件
+    auto run_until = [&](int64_t until_us) {
+        int64_t deadline;
+        while ((deadline = recognizer.NextDeadline()) >= 0 && deadline <= until_us) {
+            now_us = std::max(now_us, deadline);
+            recognizer.Poll(now_us, emit);
+        }
+        now_us = std::max(now_us, until_us);
+    };
+
+    std::string line;
+    int line_number = 0;
+    int64_t last_ms = 0;
+    while (std::getline(file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+        std::istringstream in(line);
+        std::string first;
+        if (!(in >> first)) {
+            continue;
+        }
+        if (first == "multiclick") {
+            int source;
+            in >> source;
+            recognizer.SetMultiClick(source, true);
+            continue;
+        }
+        if (first == "mainloop") {
+            in >> main_loop_ms;
+            continue;
+        }
+        if (first == "expect") {
+            int64_t time_ms;
+            std::string rest;
+            in >> time_ms;
+            std::getline(in >> std::ws, rest);
+            expected.push_back({time_ms, rest});
+            continue;
+        }
+
+        InputEvent event;
+        std::string kind;
+        int source = 0;
+        int64_t time_ms = std::stoll(first);
+        in >> kind >> source;
+        if (kind == "down") {
+            event.type = kInputPressDown;
+        } else if (kind == "up") {
+            event.type = kInputPressUp;
+        } else if (kind == "rotate") {
+            int direction = 0;
+            in >> direction;
+            event.type = kInputRotate;
+            event.direction = direction;
+        } else {
+            fprintf(stderr, "%s:%d: unknown event '%s'\n", path, line_number, kind.c_str());
+            return false;
+        }
+        if (time_ms < last_ms) {
+            fprintf(stderr, "%s:%d: events must be in time order\n", path, line_number);
+            return false;
+        }
+        event.source = source;
+        event.timestamp_us = time_ms * 1000;
+        run_until(event.timestamp_us);
+        recognizer.Feed(event, emit);
+        last_ms = time_ms;
+    }
+    // let pending multi-click windows and long presses expire
+    run_until((last_ms + 60 * 1000) * 1000);
+
+    if (expected.empty()) {
+        printf("%s:\n", path);
+        for (const auto& r : recognized) {
+            printf("expect %lld %s\n", (long long)r.time_ms, r.text.c_str());
+        }
+        return true;
+    }
+
+    bool ok = recognized.size() == expected.size();
+    for (size_t i = 0; ok && i < expected.size(); i++) {
+        ok = recognized[i].time_ms == expected[i].time_ms && recognized[i].text == expected[i].text;
+    }
+    for (const auto& r : recognized) {
+        if (main_loop_ms >= 0 && r.time_ms < main_loop_ms && r.dispatch_ms >= main_loop_ms) {
+            printf("  %s at %lld ms dispatched at %lld ms, after the main loop started\n", r.text.c_str(),
+                (long long)r.time_ms, (long long)r.dispatch_ms);
+            ok = false;
+        }
+    }
+    printf("%-40s %s\n", path, ok ? "ok" : "FAIL");
+    if (!ok) {
+        for (size_t i = 0; i < std::max(recognized.size(), expected.size()); i++) {
+            printf("  expected: %-32s got: %s\n",
+                i < expected.size() ? (std::to_string(expected[i].time_ms) + " " + expected[i].text).c_str() : "-",
+                i < recognized.size() ? (std::to_string(recognized[i].time_ms) + " " + recognized[i].text).c_str() : "-");
+        }
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s timeline.txt...\n", argv[0]);
+        return 2;
+    }
+    bool ok = true;
+    for (int i = 1; i < argc; i++) {
+        ok &= Replay(argv[i]);
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+// Host check for the keyword tables generated by scripts/gen_lang.py (main/assets/keywords.json)
+//
+// Verifies that every keyword maps to its own id and that other strings map to kUnknown, then
+// compares a lookup against the strcmp chains and std::map lookups the firmware used before:
+//
+//   python -c "import gen_lang; gen_lang.generate_keywords('../main/assets/keywords.json', 'keywords/keywords.h')"
+//   g++ -std=c++17 -O2 keywords/keyword_bench.cc -o keyword_bench
+//   ./keyword_bench
+//
+// (run from scripts/). Exits non-zero on a wrong lookup.
+#include "keywords.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+static_assert(Keys::MessageType::Lookup("tts") == Keys::MessageType::kTts, "lookup is constexpr");
+static_assert(Keys::MessageType::Lookup("ttsx") == Keys::MessageType::kUnknown, "unknown strings miss");
+
+template <typename Id, size_t N>
+static bool CheckGroup(const char* group, const std::string_view (&names)[N], Id (*lookup)(std::string_view)) {
+    bool ok = true;
+    for (size_t i = 1; i < N; i++) {
+        if (lookup(names[i]) != static_cast<Id>(i)) {
+            printf("%s: '%.*s' maps to %d\n", group, (int)names[i].size(), names[i].data(), (int)lookup(names[i]));
+            ok = false;
+        }
+        // a prefix, an extra character or a different case must not match, unless that is a keyword too
+        std::string name(names[i]);
+        for (const std::string& other : { name.substr(0, name.size() - 1), name + "x", std::string(1, name[0] ^ 0x20) + name.substr(1) }) {
+            size_t expected = 0;
+            for (size_t j = 1; j < N; j++) {
+                if (names[j] == other) {
+                    expected = j;
+                }
+            }
+            if (lookup(other) != static_cast<Id>(expected)) {
+                printf("%s: '%s' maps to %d\n", group, other.c_str(), (int)lookup(other));
+                ok = false;
+            }
+        }
+    }
+    printf("%-14s %2zu keywords %s\n", group, N - 1, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static int StrcmpChain(const char* type) {
+    // OnIncomingJson before the tables
+    if (strcmp(type, "tts") == 0) return 1;
+    if (strcmp(type, "stt") == 0) return 2;
+    if (strcmp(type, "llm") == 0) return 3;
+    if (strcmp(type, "iot") == 0) return 4;
+    if (strcmp(type, "system") == 0) return 5;
+    if (strcmp(type, "alert") == 0) return 6;
+    return 0;
+}
+
+template <typename F>
+static double NsPerCall(const std::vector<std::string>& inputs, F f) {
+    const int rounds = 200000;
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& input : inputs) {
+            sink = sink + f(input);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / rounds / inputs.size();
+}
+
+int main() {
+    bool ok = true;
+    ok &= CheckGroup("MessageType", Keys::MessageType::kNames, Keys::MessageType::Lookup);
+    ok &= CheckGroup("TtsState", Keys::TtsState::kNames, Keys::TtsState::Lookup);
+    ok &= CheckGroup("SystemCommand", Keys::SystemCommand::kNames, Keys::SystemCommand::Lookup);
+    ok &= CheckGroup("Emotion", Keys::Emotion::kNames, Keys::Emotion::Lookup);
+    ok &= CheckGroup("IotMethod", Keys::IotMethod::kNames, Keys::IotMethod::Lookup);
+    ok &= CheckGroup("ControlWord", Keys::ControlWord::kNames, Keys::ControlWord::Lookup);
+
+    std::vector<std::string> types = { "tts", "tts", "tts", "stt", "llm", "iot", "alert", "system" };
+    double chain = NsPerCall(types, [](const std::string& s) { return StrcmpChain(s.c_str()); });
+    double table = NsPerCall(types, [](const std::string& s) { return (int)Keys::MessageType::Lookup(s); });
+    printf("message type   strcmp chain %6.1f ns, table %6.1f ns\n", chain, table);
+
+    std::map<std::string, int> emotion_map;
+    std::vector<std::string> emotions;
+    for (size_t i = 1; i < Keys::Emotion::kCount; i++) {
+        emotion_map.emplace(std::string(Keys::Emotion::kNames[i]), (int)i);
+        emotions.emplace_back(Keys::Emotion::kNames[i]);
+    }
+    double map = NsPerCall(emotions, [&](const std::string& s) {
+        auto it = emotion_map.find(s);
+        return it == emotion_map.end() ? 0 : it->second;
+    });
+    table = NsPerCall(emotions, [](const std::string& s) { return (int)Keys::Emotion::Lookup(s); });
+    printf("emotion        std::map     %6.1f ns, table %6.1f ns\n", map, table);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,68 @@
+# diff the LED effect frames against the stored dumps in golden/
+#
+# Every case is the effect a device state plays in CircularStrip::OnStateChanged (12 LEDs, default
+# brightness 32/4), plus breathe and rainbow. Run from scripts/led_effects after building the dump:
+#
+#   g++ -std=c++17 -O2 -I ../../main/led led_effect_dump.cc ../../main/led/led_effect.cc -o led_effect_dump
+#   python check_golden.py               # exits non-zero and prints a diff when a frame changed
+#   python check_golden.py --update      # rewrite golden/ after an intended change, then review git diff
+import argparse
+import difflib
+import os
+import subprocess
+import sys
+
+CASES = {
+    # kDeviceStateStarting: Scroll(low, high, 3, 100)
+    "scroll": ["--effect", "scroll", "--low", "000000", "--high", "040420", "--length", "3", "--period", "1200"],
+    # kDeviceStateWifiConfiguring / kDeviceStateActivating: Blink(color, 500)
+    "blink": ["--effect", "blink", "--high", "040420", "--period", "1000"],
+    # kDeviceStateUpgrading: Blink(color, 100)
+    "blink_fast": ["--effect", "blink", "--high", "042004", "--period", "200"],
+    # kDeviceStateIdle: FadeOut(50) from the connecting color
+    "fadeout": ["--effect", "fadeout", "--start", "040420", "--period", "50"],
+    # kDeviceStateConnecting: SetAllColor(color)
+    "solid": ["--effect", "solid", "--high", "040420", "--frames", "3"],
+    # kDeviceStateListening: ShowLevel at half level
+    "level": ["--effect", "level", "--low", "040000", "--high", "200404", "--level", "128", "--frames", "5"],
+    "breathe": ["--effect", "breathe", "--low", "000000", "--high", "202020", "--period", "1280"],
+    "rainbow": ["--effect", "rainbow", "--low", "000000", "--high", "202020", "--period", "2560", "--leds", "8"],
+}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare LED effect frame dumps with golden/")
+    parser.add_argument("--dump", default="./led_effect_dump", help="led_effect_dump binary")
+    parser.add_argument("--golden", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "golden"))
+    parser.add_argument("--update", action="store_true", help="rewrite the golden files")
+    args = parser.parse_args()
+
+    failed = 0
+    for name, case_args in CASES.items():
+        output = subprocess.run([args.dump] + case_args, stdout=subprocess.PIPE, text=True, check=True).stdout
+        path = os.path.join(args.golden, name + ".txt")
+        if args.update:
+            os.makedirs(args.golden, exist_ok=True)
+            with open(path, "w") as f:
+                f.write(output)
+            print(f"{name:12s} written")
+            continue
+        if not os.path.exists(path):
+            print(f"{name:12s} missing {path}")
+            failed += 1
+            continue
+        with open(path) as f:
+            golden = f.read()
+        if output == golden:
+            print(f"{name:12s} ok")
+            continue
+        failed += 1
+        print(f"{name:12s} DIFFERS")
+        sys.stdout.writelines(difflib.unified_diff(golden.splitlines(True), output.splitlines(True),
+                                                   f"golden/{name}.txt", name, n=1))
+    if failed:
+        sys.exit(f"{failed} effect(s) differ from golden/")
+
+
+if __name__ == "__main__":
+    main()
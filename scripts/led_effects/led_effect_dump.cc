@@ -0,0 +1,138 @@
+// Host frame dump for main/led/led_effect.cc
+//
+// Runs the same LedEffectEngine the device uses and prints every frame, so effect changes can be
+// reviewed and diffed against the stored dumps in golden/ (check_golden.py runs all of them):
+//
+//   g++ -std=c++17 -O2 -I ../../main/led led_effect_dump.cc ../../main/led/led_effect.cc -o led_effect_dump
+//   ./led_effect_dump --effect breathe --leds 12 --low 000000 --high 202020 --period 1000 --frames 60
+//   ./led_effect_dump --effect scroll --low 000000 --high 040420 --length 3 --period 1200 > scroll.txt
+//   diff scroll.txt golden/scroll.txt
+//   python check_golden.py
+//
+// Each line is "<frame> <time_ms> <refresh|skip> RRGGBB RRGGBB ...". "skip" marks frames the strip
+// does not transmit because nothing changed. The summary line counts refreshes.
+#include "led_effect.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static bool ParseColor(const char* text, StripColor& color) {
+    if (strlen(text) != 6) {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long value = strtoul(text, &end, 16);
+    if (*end != '\0') {
+        return false;
+    }
+    color.red = (value >> 16) & 0xFF;
+    color.green = (value >> 8) & 0xFF;
+    color.blue = value & 0xFF;
+    return true;
+}
+
+static bool ParseEffect(const char* text, LedEffectType& type) {
+    static const struct {
+        const char* name;
+        LedEffectType type;
+    } kEffects[] = {
+        {"solid", kLedEffectSolid},
+        {"blink", kLedEffectBlink},
+        {"breathe", kLedEffectBreathe},
+        {"scroll", kLedEffectScroll},
+        {"rainbow", kLedEffectRainbow},
+        {"fadeout", kLedEffectFadeOut},
+        {"level", kLedEffectLevel},
+    };
+    for (const auto& effect : kEffects) {
+        if (strcmp(text, effect.name) == 0) {
+            type = effect.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void Usage(const char* program) {
+    fprintf(stderr,
+        "usage: %s --effect solid|blink|breathe|scroll|rainbow|fadeout|level [--leds N] [--low RRGGBB]\n"
+        "          [--high RRGGBB] [--start RRGGBB] [--period MS] [--length N] [--frames N]\n"
+        "          [--level 0-255]\n"
+        "--start is the color shown before the effect begins (used by fadeout)\n", program);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    LedEffect effect;
+    StripColor start;
+    int leds = 12;
+    int frames = 0;
+    int level = 0;
+    bool has_effect = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            Usage(argv[0]);
+        }
+        const char* value = argv[++i];
+        bool ok = true;
+        if (arg == "--effect") {
+            ok = has_effect = ParseEffect(value, effect.type);
+        } else if (arg == "--leds") {
+            leds = atoi(value);
+            ok = leds > 0;
+        } else if (arg == "--low") {
+            ok = ParseColor(value, effect.low);
+        } else if (arg == "--high") {
+            ok = ParseColor(value, effect.high);
+        } else if (arg == "--start") {
+            ok = ParseColor(value, start);
+        } else if (arg == "--period") {
+            int period = atoi(value);
+            ok = period > 0 && period <= 65535;
+            effect.period_ms = period;
+        } else if (arg == "--length") {
+            effect.length = atoi(value);
+        } else if (arg == "--level") {
+            level = atoi(value);
+            ok = level >= 0 && level <= 255;
+        } else if (arg == "--frames") {
+            frames = atoi(value);
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "invalid argument: %s %s\n", arg.c_str(), value);
+            Usage(argv[0]);
+        }
+    }
+    if (!has_effect) {
+        Usage(argv[0]);
+    }
+    if (frames <= 0) {
+        // one full cycle by default, fadeout runs until it finishes
+        frames = effect.type == kLedEffectFadeOut ? 1000000
+            : (effect.period_ms + LedEffectEngine::kFrameMs - 1) / LedEffectEngine::kFrameMs;
+    }
+
+    LedEffectEngine engine;
+    engine.Start(effect, std::vector<StripColor>(leds, start));
+    int refreshes = 0;
+    int printed = 0;
+    for (; printed < frames && !engine.finished(); printed++) {
+        int index = engine.frame_index();
+        engine.SetLevel(level);
+        bool changed = engine.Step();
+        refreshes += changed;
+        printf("%d %d %s", index, index * LedEffectEngine::kFrameMs, changed ? "refresh" : "skip");
+        for (const auto& color : engine.frame()) {
+            printf(" %02x%02x%02x", color.red, color.green, color.blue);
+        }
+        printf("\n");
+    }
+    printf("# %d frames, %d refreshes, %s\n", printed, refreshes, engine.finished() ? "finished" : "running");
+    return 0;
+}
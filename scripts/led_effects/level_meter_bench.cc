@@ -0,0 +1,87 @@
+// Host check for main/audio_processing/audio_level_meter.cc
+//
+// Verifies the level mapping on known signals and measures what the meter adds to the audio path
+// per frame (AFE output frames are 30 ms at 16 kHz, TTS frames 60 ms at 24 kHz):
+//
+//   g++ -std=c++17 -O2 -I ../../main/audio_processing level_meter_bench.cc
+//       ../../main/audio_processing/audio_level_meter.cc -o level_meter_bench
+//   ./level_meter_bench
+//
+// Exits non-zero if a level is off or the cost exceeds --budget percent of the frame duration
+// (default 0.1%). The device runs at a fraction of a desktop core's speed, so keep the host
+// budget well below what the device can afford.
+#include "audio_level_meter.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static std::vector<int16_t> Sine(int samples, int sample_rate, double dbfs) {
+    std::vector<int16_t> data(samples);
+    double amplitude = 32767 * pow(10, dbfs / 20);
+    for (int i = 0; i < samples; i++) {
+        data[i] = (int16_t)lround(amplitude * sin(2 * M_PI * 440 * i / sample_rate));
+    }
+    return data;
+}
+
+static bool CheckLevel(const char* name, const std::vector<int16_t>& data, int expected, int tolerance) {
+    int level = AudioLevelMeter::Measure(data.data(), data.size());
+    bool ok = abs(level - expected) <= tolerance;
+    printf("%-22s level %3d (expected %3d +/- %d) %s\n", name, level, expected, tolerance, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool Bench(const char* name, int samples, int sample_rate, double budget_percent) {
+    auto data = Sine(samples, sample_rate, -20);
+    auto& meter = AudioLevelMeter::GetInstance();
+    const int iterations = 20000;
+    volatile uint8_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        // the reader takes the peak once per LED frame, a few audio frames apart
+        meter.Update(kAudioLevelInput, data.data(), data.size());
+        if ((i & 3) == 0) {
+            sink = meter.TakePeak(kAudioLevelInput);
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)sink;
+
+    double per_frame_ns = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+    double frame_ns = 1e9 * samples / sample_rate;
+    double percent = 100 * per_frame_ns / frame_ns;
+    bool ok = percent <= budget_percent;
+    printf("%-22s %6.0f ns per frame, %.4f%% of the %.0f ms frame %s\n", name, per_frame_ns, percent,
+        frame_ns / 1e6, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    double budget_percent = 0.1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            budget_percent = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--budget PERCENT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // 0..255 spans -60..0 dB of mean square; a full-scale sine sits 3 dB below a full-scale square
+    bool ok = true;
+    ok &= CheckLevel("silence", std::vector<int16_t>(480, 0), 0, 0);
+    ok &= CheckLevel("full-scale square", std::vector<int16_t>(480, -32768), 255, 0);
+    ok &= CheckLevel("sine 0 dBFS", Sine(480, 16000, 0), 242, 2);
+    ok &= CheckLevel("sine -20 dBFS", Sine(480, 16000, -20), 157, 3);
+    ok &= CheckLevel("sine -50 dBFS", Sine(480, 16000, -50), 29, 3);
+    ok &= CheckLevel("sine -70 dBFS", Sine(480, 16000, -70), 0, 0);
+
+    ok &= Bench("afe 30 ms @ 16 kHz", 480, 16000, budget_percent);
+    ok &= Bench("tts 60 ms @ 24 kHz", 1440, 24000, budget_percent);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,741 @@
+// Native P3 encoder/decoder and multithreaded batch converter
+//
+// Shares the container code with the firmware (main/protocols/p3_stream.h) and links libopus:
+//
+//   g++ -std=c++17 -O2 -I ../../../main/protocols p3tool.cc -lopus -lpthread -o p3tool
+//
+//   ./p3tool encode input.wav output.p3 [-l LUFS] [--frame-ms 60] [--bitrate 0] [--rate 16000]
+//   ./p3tool decode input.p3 output.wav [--rate 16000]
+//   ./p3tool batch ../../../main/assets --out /tmp/assets [--jobs N] [encode options]
+//   ./p3tool check
+//
+// encode reads 8/16/24/32-bit PCM or 32-bit float WAV of any rate and channel count. The level
+// is kept as is unless -l is given: then loudness is measured per ITU-R BS.1770 (as pyloudnorm
+// does) in one pass over the input, and the gain is applied while quantizing frames for the
+// encoder, so the audio is not rewritten in between.
+// batch walks a directory for .wav and .p3 files. .wav files are encoded and .p3 files are
+// re-encoded with the given frame duration and bitrate, preserving the relative layout under
+// --out. It reports files/sec and audio seconds per second at the end.
+// check encodes synthetic speech-like signals, decodes them again and compares the PCM with the
+// input (alignment, correlation, level, length). It refuses to run unless the linked library
+// reports itself as libopus. Exits non-zero when a check fails.
+//
+// The firmware plays assets with a 16 kHz decoder sized for 60 ms frames (Application::PlaySound),
+// so assets must use 16 kHz and frames of at most 60 ms.
+#include "p3_stream.h"
+
+#include <opus/opus.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct EncodeOptions {
+    int sample_rate = 16000;
+    int frame_ms = 60;
+    int bitrate = 0;            // 0 = libopus default for the rate
+    bool loudnorm = false;      // enabled by -l
+    double target_lufs = -16.0;
+    bool quiet = false;
+};
+
+struct Audio {
+    int sample_rate = 0;
+    std::vector<float> samples;     // mono, -1..1
+};
+
+// ---------------------------------------------------------------------------------------------
+// WAV
+
+static uint32_t ReadLe(const uint8_t* p, int bytes) {
+    uint32_t value = 0;
+    for (int i = bytes - 1; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+static bool ReadFile(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool WriteFile(const std::string& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return bool(file);
+}
+
+static bool ReadWav(const std::string& path, Audio& audio, std::string& error) {
+    std::vector<uint8_t> data;
+    if (!ReadFile(path, data)) {
+        error = "cannot read file";
+        return false;
+    }
+    if (data.size() < 12 || memcmp(data.data(), "RIFF", 4) != 0 || memcmp(data.data() + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    int format = 0, channels = 0, bits = 0;
+    const uint8_t* pcm = nullptr;
+    size_t pcm_size = 0;
+    for (size_t p = 12; p + 8 <= data.size(); ) {
+        uint32_t chunk_size = ReadLe(&data[p + 4], 4);
+        const uint8_t* body = &data[p + 8];
+        size_t available = std::min<size_t>(chunk_size, data.size() - p - 8);
+        if (memcmp(&data[p], "fmt ", 4) == 0 && available >= 16) {
+            format = ReadLe(body, 2);
+            channels = ReadLe(body + 2, 2);
+            audio.sample_rate = ReadLe(body + 4, 4);
+            bits = ReadLe(body + 14, 2);
+            if (format == 0xFFFE && available >= 26) {
+                format = ReadLe(body + 24, 2);  // WAVE_FORMAT_EXTENSIBLE sub-format
+            }
+        } else if (memcmp(&data[p], "data", 4) == 0) {
+            pcm = body;
+            pcm_size = available;
+        }
+        p += 8 + chunk_size + (chunk_size & 1);
+    }
+    if (pcm == nullptr || channels <= 0 || audio.sample_rate <= 0) {
+        error = "missing fmt or data chunk";
+        return false;
+    }
+    bool is_float = format == 3 && bits == 32;
+    if (!is_float && (format != 1 || (bits != 8 && bits != 16 && bits != 24 && bits != 32))) {
+        error = "unsupported sample format " + std::to_string(format) + "/" + std::to_string(bits) + " bit";
+        return false;
+    }
+
+    int bytes = bits / 8;
+    size_t frames = pcm_size / (bytes * channels);
+    audio.samples.resize(frames);
+    for (size_t i = 0; i < frames; i++) {
+        double sum = 0;
+        for (int c = 0; c < channels; c++) {
+            const uint8_t* s = pcm + (i * channels + c) * bytes;
+            double value;
+            if (is_float) {
+                float f;
+                memcpy(&f, s, 4);
+                value = f;
+            } else if (bits == 8) {
+                value = (s[0] - 128) / 128.0;
+            } else {
+                // sign-extend little-endian integers
+                int32_t v = (int32_t)(ReadLe(s, bytes) << (32 - bits));
+                value = v / 2147483648.0;
+            }
+            sum += value;
+        }
+        audio.samples[i] = (float)(sum / channels);
+    }
+    return true;
+}
+
+static void AppendLe(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back((value >> (8 * i)) & 0xFF);
+    }
+}
+
+static std::vector<uint8_t> MakeWav(const std::vector<int16_t>& pcm, int sample_rate) {
+    std::vector<uint8_t> out;
+    uint32_t data_size = pcm.size() * 2;
+    out.insert(out.end(), {'R', 'I', 'F', 'F'});
+    AppendLe(out, 36 + data_size, 4);
+    out.insert(out.end(), {'W', 'A', 'V', 'E', 'f', 'm', 't', ' '});
+    AppendLe(out, 16, 4);
+    AppendLe(out, 1, 2);                // PCM
+    AppendLe(out, 1, 2);                // mono
+    AppendLe(out, sample_rate, 4);
+    AppendLe(out, sample_rate * 2, 4);
+    AppendLe(out, 2, 2);
+    AppendLe(out, 16, 2);
+    out.insert(out.end(), {'d', 'a', 't', 'a'});
+    AppendLe(out, data_size, 4);
+    for (int16_t s : pcm) {
+        AppendLe(out, (uint16_t)s, 2);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Loudness (ITU-R BS.1770-4, same filter design and gating as pyloudnorm)
+
+struct Biquad {
+    double b0, b1, b2, a1, a2;
+    double z1 = 0, z2 = 0;
+
+    double Process(double x) {
+        double y = b0 * x + z1;
+        z1 = b1 * x - a1 * y + z2;
+        z2 = b2 * x - a2 * y;
+        return y;
+    }
+};
+
+static Biquad HighShelf(double rate, double gain_db, double q, double fc) {
+    double a = pow(10, gain_db / 40), w0 = 2 * M_PI * fc / rate, alpha = sin(w0) / (2 * q), c = cos(w0);
+    double a0 = (a + 1) - (a - 1) * c + 2 * sqrt(a) * alpha;
+    return {
+        a * ((a + 1) + (a - 1) * c + 2 * sqrt(a) * alpha) / a0,
+        -2 * a * ((a - 1) + (a + 1) * c) / a0,
+        a * ((a + 1) + (a - 1) * c - 2 * sqrt(a) * alpha) / a0,
+        2 * ((a - 1) - (a + 1) * c) / a0,
+        ((a + 1) - (a - 1) * c - 2 * sqrt(a) * alpha) / a0,
+    };
+}
+
+static Biquad HighPass(double rate, double q, double fc) {
+    double w0 = 2 * M_PI * fc / rate, alpha = sin(w0) / (2 * q), c = cos(w0);
+    double a0 = 1 + alpha;
+    return { (1 + c) / 2 / a0, -(1 + c) / a0, (1 + c) / 2 / a0, -2 * c / a0, (1 - alpha) / a0 };
+}
+
+// Returns integrated loudness in LUFS, or -inf for silence / audio shorter than one block
+static double IntegratedLoudness(const Audio& audio) {
+    Biquad shelf = HighShelf(audio.sample_rate, 4.0, 1 / sqrt(2.0), 1500.0);
+    Biquad pass = HighPass(audio.sample_rate, 0.5, 38.0);
+
+    // 400 ms blocks with 75% overlap: accumulate energy per 100 ms step, sum 4 steps per block
+    size_t step = audio.sample_rate / 10;
+    std::vector<double> steps;
+    double energy = 0;
+    size_t count = 0;
+    for (float sample : audio.samples) {
+        double y = pass.Process(shelf.Process(sample));
+        energy += y * y;
+        if (++count == step) {
+            steps.push_back(energy);
+            energy = 0;
+            count = 0;
+        }
+    }
+    std::vector<double> blocks;
+    for (size_t i = 0; i + 4 <= steps.size(); i++) {
+        blocks.push_back((steps[i] + steps[i + 1] + steps[i + 2] + steps[i + 3]) / (4.0 * step));
+    }
+
+    auto loudness = [](double z) { return -0.691 + 10 * log10(z); };
+    auto gated_mean = [&](double threshold) {
+        double sum = 0;
+        int n = 0;
+        for (double z : blocks) {
+            if (z > 0 && loudness(z) > threshold) {
+                sum += z;
+                n++;
+            }
+        }
+        return n > 0 ? sum / n : 0.0;
+    };
+    double absolute = gated_mean(-70.0);
+    if (absolute <= 0) {
+        return -INFINITY;
+    }
+    double relative = gated_mean(loudness(absolute) - 10.0);
+    return relative > 0 ? loudness(relative) : -INFINITY;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Resampling (windowed sinc, only used when the input rate differs from the output rate)
+
+static std::vector<float> Resample(const std::vector<float>& in, int from, int to) {
+    if (from == to) {
+        return in;
+    }
+    const int kHalfTaps = 16;
+    double ratio = (double)to / from;
+    double cutoff = std::min(1.0, ratio) * 0.95;
+    size_t out_size = (size_t)((double)in.size() * ratio);
+    std::vector<float> out(out_size);
+    for (size_t i = 0; i < out_size; i++) {
+        double center = i / ratio;
+        long first = (long)floor(center) - kHalfTaps + 1;
+        double sum = 0, weight = 0;
+        for (long j = first; j < first + 2 * kHalfTaps; j++) {
+            double x = (center - j) * cutoff;
+            double sinc = x == 0 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double window = 0.5 + 0.5 * cos(M_PI * (center - j) / kHalfTaps);
+            double w = sinc * window;
+            if (j >= 0 && j < (long)in.size()) {
+                sum += in[j] * w;
+            }
+            weight += w;
+        }
+        out[i] = (float)(weight != 0 ? sum / weight : 0);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Encode / decode
+
+struct Result {
+    bool ok = false;
+    std::string error;
+    double audio_seconds = 0;
+    int clipped = 0;
+};
+
+static Result EncodeAudio(Audio audio, const EncodeOptions& options, std::vector<uint8_t>& p3) {
+    Result result;
+    float gain = 1.0f;
+    if (options.loudnorm) {
+        double lufs = IntegratedLoudness(audio);
+        if (std::isfinite(lufs)) {
+            gain = (float)pow(10, (options.target_lufs - lufs) / 20);
+            if (!options.quiet) {
+                printf("  loudness %.1f LUFS -> %.1f LUFS\n", lufs, options.target_lufs);
+            }
+        }
+    }
+    std::vector<float> samples = Resample(audio.samples, audio.sample_rate, options.sample_rate);
+    result.audio_seconds = (double)samples.size() / options.sample_rate;
+
+    int error = 0;
+    OpusEncoder* encoder = opus_encoder_create(options.sample_rate, 1, OPUS_APPLICATION_AUDIO, &error);
+    if (encoder == nullptr) {
+        result.error = std::string("opus_encoder_create: ") + opus_strerror(error);
+        return result;
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(options.bitrate > 0 ? options.bitrate : OPUS_AUTO));
+
+    int frame_size = options.sample_rate * options.frame_ms / 1000;
+    std::vector<int16_t> frame(frame_size);
+    std::vector<uint8_t> packet(4000);
+    p3.clear();
+    // the last partial frame is padded with silence instead of being dropped
+    for (size_t offset = 0; offset < samples.size(); offset += frame_size) {
+        for (int i = 0; i < frame_size; i++) {
+            float value = offset + i < samples.size() ? samples[offset + i] * gain * 32767.0f : 0.0f;
+            if (value > 32767.0f || value < -32768.0f) {
+                result.clipped++;
+                value = std::max(-32768.0f, std::min(32767.0f, value));
+            }
+            frame[i] = (int16_t)lrintf(value);
+        }
+        int size = opus_encode(encoder, frame.data(), frame_size, packet.data(), packet.size());
+        if (size < 0) {
+            result.error = std::string("opus_encode: ") + opus_strerror(size);
+            opus_encoder_destroy(encoder);
+            return result;
+        }
+        P3AppendPacket(p3, packet.data(), (uint16_t)size);
+    }
+    opus_encoder_destroy(encoder);
+    result.ok = true;
+    return result;
+}
+
+static Result DecodeP3(const std::vector<uint8_t>& p3, int sample_rate, std::vector<int16_t>& pcm) {
+    Result result;
+    int error = 0;
+    OpusDecoder* decoder = opus_decoder_create(sample_rate, 1, &error);
+    if (decoder == nullptr) {
+        result.error = std::string("opus_decoder_create: ") + opus_strerror(error);
+        return result;
+    }
+    // room for the longest Opus frame (120 ms)
+    std::vector<int16_t> frame(sample_rate * 120 / 1000);
+    P3Reader reader(p3.data(), p3.size());
+    const uint8_t* payload;
+    uint16_t payload_size;
+    pcm.clear();
+    while (reader.Next(payload, payload_size)) {
+        int samples = opus_decode(decoder, payload, payload_size, frame.data(), frame.size(), 0);
+        if (samples < 0) {
+            result.error = std::string("opus_decode: ") + opus_strerror(samples);
+            opus_decoder_destroy(decoder);
+            return result;
+        }
+        pcm.insert(pcm.end(), frame.begin(), frame.begin() + samples);
+    }
+    opus_decoder_destroy(decoder);
+    if (reader.error()) {
+        result.error = "truncated P3 stream";
+        return result;
+    }
+    result.audio_seconds = (double)pcm.size() / sample_rate;
+    result.ok = true;
+    return result;
+}
+
+static Result ConvertFile(const fs::path& input, const fs::path& output, const EncodeOptions& options) {
+    Result result;
+    Audio audio;
+    if (input.extension() == ".p3") {
+        // re-encode: decode at 48 kHz so the new encoder sees the full band Opus kept
+        std::vector<uint8_t> p3;
+        if (!ReadFile(input.string(), p3)) {
+            result.error = "cannot read file";
+            return result;
+        }
+        std::vector<int16_t> pcm;
+        result = DecodeP3(p3, 48000, pcm);
+        if (!result.ok) {
+            return result;
+        }
+        audio.sample_rate = 48000;
+        audio.samples.resize(pcm.size());
+        for (size_t i = 0; i < pcm.size(); i++) {
+            audio.samples[i] = pcm[i] / 32768.0f;
+        }
+    } else if (!ReadWav(input.string(), audio, result.error)) {
+        return result;
+    }
+
+    std::vector<uint8_t> p3;
+    result = EncodeAudio(std::move(audio), options, p3);
+    if (result.ok && !WriteFile(output.string(), p3)) {
+        result.ok = false;
+        result.error = "cannot write " + output.string();
+    }
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Command line
+
+[[noreturn]] static void Usage() {
+    fprintf(stderr,
+        "usage: p3tool encode INPUT.wav OUTPUT.p3 [options]\n"
+        "       p3tool decode INPUT.p3 OUTPUT.wav [--rate HZ]\n"
+        "       p3tool batch INPUT_DIR --out OUTPUT_DIR [--jobs N] [options]\n"
+        "       p3tool check\n"
+        "options:\n"
+        "  -l, --lufs LUFS     normalize loudness to LUFS, e.g. -16 (default: keep the level)\n"
+        "  --frame-ms MS       10, 20, 40 or 60 (default 60)\n"
+        "  --bitrate BPS       0 for the libopus default (default 0)\n"
+        "  --rate HZ           8000, 12000, 16000, 24000 or 48000 (default 16000)\n"
+        "  -q, --quiet\n");
+    exit(2);
+}
+
+static bool ParseOption(int argc, char** argv, int& i, EncodeOptions& options) {
+    std::string arg = argv[i];
+    auto value = [&]() -> const char* {
+        if (i + 1 >= argc) {
+            Usage();
+        }
+        return argv[++i];
+    };
+    if (arg == "-l" || arg == "--lufs") {
+        options.target_lufs = atof(value());
+        options.loudnorm = true;
+    } else if (arg == "--frame-ms") {
+        options.frame_ms = atoi(value());
+    } else if (arg == "--bitrate") {
+        options.bitrate = atoi(value());
+    } else if (arg == "--rate") {
+        options.sample_rate = atoi(value());
+    } else if (arg == "-q" || arg == "--quiet") {
+        options.quiet = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void ValidateOptions(const EncodeOptions& options) {
+    int rates[] = {8000, 12000, 16000, 24000, 48000};
+    int durations[] = {10, 20, 40, 60};
+    if (std::find(std::begin(rates), std::end(rates), options.sample_rate) == std::end(rates)) {
+        fprintf(stderr, "unsupported sample rate %d\n", options.sample_rate);
+        exit(2);
+    }
+    if (std::find(std::begin(durations), std::end(durations), options.frame_ms) == std::end(durations)) {
+        fprintf(stderr, "unsupported frame duration %d ms\n", options.frame_ms);
+        exit(2);
+    }
+    if (options.bitrate < 0 || (options.bitrate > 0 && (options.bitrate < 500 || options.bitrate > 512000))) {
+        fprintf(stderr, "bitrate must be 0 or between 500 and 512000\n");
+        exit(2);
+    }
+    if (options.sample_rate != 16000 && !options.quiet) {
+        fprintf(stderr, "note: the firmware plays assets with a 16 kHz decoder\n");
+    }
+}
+
+static int RunBatch(const fs::path& input_dir, const fs::path& output_dir, int jobs, const EncodeOptions& options) {
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator(input_dir)) {
+        auto extension = entry.path().extension();
+        if (entry.is_regular_file() && (extension == ".wav" || extension == ".p3")) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (files.empty()) {
+        fprintf(stderr, "no .wav or .p3 files under %s\n", input_dir.c_str());
+        return 1;
+    }
+
+    EncodeOptions worker_options = options;
+    worker_options.quiet = true;
+    std::atomic<size_t> next{0};
+    std::atomic<int> failed{0};
+    std::mutex output_mutex;
+    double total_seconds = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        for (size_t index; (index = next.fetch_add(1)) < files.size(); ) {
+            const fs::path& input = files[index];
+            fs::path output = output_dir / fs::relative(input, input_dir);
+            output.replace_extension(".p3");
+            std::error_code ec;
+            fs::create_directories(output.parent_path(), ec);
+            Result result = ConvertFile(input, output, worker_options);
+
+            std::lock_guard<std::mutex> lock(output_mutex);
+            if (!result.ok) {
+                failed++;
+                fprintf(stderr, "%s: %s\n", input.c_str(), result.error.c_str());
+                continue;
+            }
+            total_seconds += result.audio_seconds;
+            if (!options.quiet) {
+                printf("%s -> %s (%.2f s%s)\n", input.c_str(), output.c_str(), result.audio_seconds,
+                    result.clipped > 0 ? ", clipped" : "");
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 0; i < jobs; i++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t converted = files.size() - failed;
+    printf("%zu files (%d failed), %.1f s of audio in %.2f s with %d jobs: %.1f files/sec, %.0fx realtime\n",
+        converted, failed.load(), total_seconds, elapsed, jobs, converted / elapsed, total_seconds / elapsed);
+    return failed > 0 ? 1 : 0;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Round trip check
+
+static bool Check(const std::string& name, bool ok) {
+    printf("%-56s %s\n", name.c_str(), ok ? "ok" : "FAIL");
+    return ok;
+}
+
+// two tones under a 4 Hz envelope, roughly the spectrum and rhythm of speech
+static Audio SpeechLike(int sample_rate, double seconds, double amplitude) {
+    Audio audio;
+    audio.sample_rate = sample_rate;
+    audio.samples.resize((size_t)(sample_rate * seconds));
+    for (size_t i = 0; i < audio.samples.size(); i++) {
+        double t = (double)i / sample_rate;
+        double envelope = 0.55 + 0.45 * sin(2 * M_PI * 4 * t);
+        double tone = 0.6 * sin(2 * M_PI * 310 * t) + 0.4 * sin(2 * M_PI * 1230 * t);
+        audio.samples[i] = (float)(amplitude * envelope * tone);
+    }
+    return audio;
+}
+
+static double Rms(const float* samples, size_t count) {
+    double energy = 0;
+    for (size_t i = 0; i < count; i++) {
+        energy += (double)samples[i] * samples[i];
+    }
+    return count > 0 ? sqrt(energy / count) : 0;
+}
+
+struct Comparison {
+    int delay = 0;              // decoded sample i lines up with input sample i - delay
+    double correlation = 0;     // normalized, at that delay
+    double level_db = 0;        // decoded RMS relative to the input
+};
+
+// The decoder output lags the input by the encoder lookahead; search the first 20 ms for the
+// delay with the best correlation and skip the first and last 100 ms, where the codec settles.
+static Comparison Compare(const std::vector<float>& input, const std::vector<int16_t>& decoded, int sample_rate) {
+    Comparison best;
+    best.correlation = -2;
+    size_t margin = sample_rate / 10;
+    if (input.size() < 3 * margin) {
+        return best;
+    }
+    size_t count = input.size() - 2 * margin;
+    for (int delay = 0; delay <= sample_rate / 50; delay++) {
+        if (margin + delay + count > decoded.size()) {
+            break;
+        }
+        double xy = 0, xx = 0, yy = 0;
+        for (size_t i = 0; i < count; i++) {
+            double x = input[margin + i], y = decoded[margin + delay + i] / 32768.0;
+            xy += x * y;
+            xx += x * x;
+            yy += y * y;
+        }
+        double correlation = xx > 0 && yy > 0 ? xy / sqrt(xx * yy) : 0;
+        if (correlation > best.correlation) {
+            best.delay = delay;
+            best.correlation = correlation;
+            best.level_db = 10 * log10(yy / count) - 20 * log10(Rms(&input[margin], count));
+        }
+    }
+    return best;
+}
+
+static bool CheckRoundTrip(int frame_ms, int bitrate, int sample_rate) {
+    EncodeOptions options;
+    options.frame_ms = frame_ms;
+    options.bitrate = bitrate;
+    options.sample_rate = sample_rate;
+    options.quiet = true;
+    // 1.03 s so the last frame is partial and gets padded
+    Audio audio = SpeechLike(sample_rate, 1.03, 0.25);
+
+    std::vector<uint8_t> p3;
+    std::vector<int16_t> decoded;
+    Result encoded = EncodeAudio(audio, options, p3);
+    Result result = encoded.ok ? DecodeP3(p3, sample_rate, decoded) : encoded;
+    char name[96];
+    snprintf(name, sizeof(name), "%d ms frames, %s, %d Hz", frame_ms,
+        bitrate > 0 ? (std::to_string(bitrate / 1000) + " kbps").c_str() : "default bitrate", sample_rate);
+    if (!result.ok) {
+        printf("  %s\n", result.error.c_str());
+        return Check(name, false);
+    }
+
+    int frame_size = sample_rate * frame_ms / 1000;
+    size_t frames = (audio.samples.size() + frame_size - 1) / frame_size;
+    Comparison comparison = Compare(audio.samples, decoded, sample_rate);
+    printf("  %zu packets, %zu bytes, delay %d samples, correlation %.3f, level %+.2f dB\n",
+        frames, p3.size(), comparison.delay, comparison.correlation, comparison.level_db);
+    // Opus does not preserve the waveform exactly; these bounds catch misaligned, truncated,
+    // rescaled or garbled output, not codec quality
+    return Check(name, decoded.size() == frames * frame_size && comparison.correlation > 0.9 &&
+        fabs(comparison.level_db) < 1.5);
+}
+
+// 同一段音频经过 -l 后解码出来的响度应接近目标值
+static bool CheckLoudnorm(double target_lufs) {
+    EncodeOptions options;
+    options.loudnorm = true;
+    options.target_lufs = target_lufs;
+    options.quiet = true;
+    Audio audio = SpeechLike(options.sample_rate, 3.0, 0.05);
+
+    std::vector<uint8_t> p3;
+    Audio decoded;
+    decoded.sample_rate = options.sample_rate;
+    std::vector<int16_t> pcm;
+    Result result = EncodeAudio(audio, options, p3);
+    if (result.ok) {
+        result = DecodeP3(p3, options.sample_rate, pcm);
+    }
+    for (int16_t sample : pcm) {
+        decoded.samples.push_back(sample / 32768.0f);
+    }
+    double lufs = result.ok ? IntegratedLoudness(decoded) : -INFINITY;
+    printf("  input %.1f LUFS, decoded %.1f LUFS\n", IntegratedLoudness(audio), lufs);
+    char name[64];
+    snprintf(name, sizeof(name), "-l %.0f: decoded loudness within 1 LU", target_lufs);
+    return Check(name, std::isfinite(lufs) && fabs(lufs - target_lufs) < 1.0);
+}
+
+static int RunCheck() {
+    const char* version = opus_get_version_string();
+    printf("%s\n", version);
+    if (strncmp(version, "libopus", 7) != 0) {
+        fprintf(stderr, "not linked against libopus, nothing to check\n");
+        return 1;
+    }
+    bool ok = true;
+    for (int frame_ms : {20, 40, 60}) {
+        ok &= CheckRoundTrip(frame_ms, 0, 16000);
+    }
+    ok &= CheckRoundTrip(60, 32000, 16000);
+    ok &= CheckRoundTrip(20, 64000, 48000);
+    ok &= CheckLoudnorm(-16.0);
+    printf("%s\n", ok ? "all checks passed" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc == 2 && strcmp(argv[1], "check") == 0) {
+        return RunCheck();
+    }
+    if (argc < 3) {
+        Usage();
+    }
+    std::string command = argv[1];
+    EncodeOptions options;
+    std::vector<std::string> positional;
+    std::string out_dir;
+    int jobs = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::max(1, atoi(argv[++i]));
+        } else if (!ParseOption(argc, argv, i, options)) {
+            if (arg[0] == '-') {
+                Usage();
+            }
+            positional.push_back(arg);
+        }
+    }
+
+    if (command == "encode" && positional.size() == 2) {
+        ValidateOptions(options);
+        Result result = ConvertFile(positional[0], positional[1], options);
+        if (!result.ok) {
+            fprintf(stderr, "%s: %s\n", positional[0].c_str(), result.error.c_str());
+            return 1;
+        }
+        if (result.clipped > 0) {
+            fprintf(stderr, "warning: %d samples clipped after loudness adjustment\n", result.clipped);
+        }
+        return 0;
+    }
+    if (command == "decode" && positional.size() == 2) {
+        std::vector<uint8_t> p3;
+        if (!ReadFile(positional[0], p3)) {
+            fprintf(stderr, "%s: cannot read file\n", positional[0].c_str());
+            return 1;
+        }
+        std::vector<int16_t> pcm;
+        Result result = DecodeP3(p3, options.sample_rate, pcm);
+        if (!result.ok) {
+            fprintf(stderr, "%s: %s\n", positional[0].c_str(), result.error.c_str());
+            return 1;
+        }
+        return WriteFile(positional[1], MakeWav(pcm, options.sample_rate)) ? 0 : 1;
+    }
+    if (command == "batch" && positional.size() == 1 && !out_dir.empty()) {
+        ValidateOptions(options);
+        std::error_code ec;
+        if (fs::equivalent(positional[0], out_dir, ec)) {
+            fprintf(stderr, "--out must differ from the input directory\n");
+            return 2;
+        }
+        return RunBatch(positional[0], out_dir, jobs, options);
+    }
+    Usage();
+}
@@ -0,0 +1,162 @@
+// Host check and benchmark for the NoAudioCodec sample conversion (main/audio_codecs/sample_convert.h)
+//
+// Compares the unrolled kernels against the original per-sample loops of NoAudioCodec::Write/Read
+// (a std::vector and a pow() per frame, 64-bit multiply and clamp on every sample):
+// - Write: every int16 value at volumes 0-150, plus random frames;
+// - Read: the int32 extremes, values around the clamp limits and random samples.
+// Then prints the throughput of both versions for one 60 ms frame:
+//
+//   g++ -std=c++17 -O2 -I../main/audio_codecs -o sample_convert_bench sample_convert/sample_convert_bench.cc
+//   ./sample_convert_bench
+//
+// (run from scripts/). Exits non-zero when the outputs differ.
+#include "sample_convert.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// 修改前 NoAudioCodec::Write 的转换
+static void OldWrite(const int16_t* data, int samples, int volume, std::vector<int32_t>& out) {
+    std::vector<int32_t> buffer(samples);
+    int32_t volume_factor = pow(double(volume) / 100.0, 2) * 65536;
+    for (int i = 0; i < samples; i++) {
+        int64_t temp = int64_t(data[i]) * volume_factor;
+        if (temp > INT32_MAX) {
+            buffer[i] = INT32_MAX;
+        } else if (temp < INT32_MIN) {
+            buffer[i] = INT32_MIN;
+        } else {
+            buffer[i] = static_cast<int32_t>(temp);
+        }
+    }
+    out.swap(buffer);
+}
+
+// 修改前 NoAudioCodec::Read 的转换
+static void OldRead(const int32_t* data, int samples, int16_t* dest) {
+    std::vector<int32_t> bit32_buffer(data, data + samples);
+    for (int i = 0; i < samples; i++) {
+        int32_t value = bit32_buffer[i] >> 12;
+        dest[i] = (value > INT16_MAX) ? INT16_MAX : (value < -INT16_MAX) ? -INT16_MAX : (int16_t)value;
+    }
+}
+
+static bool CheckWrite(const std::vector<int16_t>& input, int volume) {
+    std::vector<int32_t> expected;
+    OldWrite(input.data(), input.size(), volume, expected);
+    std::vector<int32_t> actual(input.size());
+    ScaleToInt32(input.data(), actual.data(), input.size(), VolumeFactorQ16(volume));
+    for (size_t i = 0; i < input.size(); i++) {
+        if (actual[i] != expected[i]) {
+            printf("write mismatch: volume %d, sample %d: %d != %d\n", volume, input[i], actual[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckRead(const std::vector<int32_t>& input) {
+    std::vector<int16_t> expected(input.size()), actual(input.size());
+    OldRead(input.data(), input.size(), expected.data());
+    NarrowToInt16(input.data(), actual.data(), input.size());
+    for (size_t i = 0; i < input.size(); i++) {
+        if (actual[i] != expected[i]) {
+            printf("read mismatch: sample %d: %d != %d\n", input[i], actual[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename F>
+static double NsPerCall(F f) {
+    const int rounds = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        f();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / rounds;
+}
+
+static void Report(const char* name, int samples, double old_ns, double new_ns) {
+    printf("%-18s %8.0f ns %8.1f Msps | %8.0f ns %8.1f Msps | %5.2fx\n", name,
+           old_ns, samples * 1000.0 / old_ns, new_ns, samples * 1000.0 / new_ns, old_ns / new_ns);
+}
+
+int main() {
+    bool ok = true;
+    std::mt19937 rng(20240611);
+
+    // 全部 16 位取值，奇数长度覆盖展开后的尾部
+    std::vector<int16_t> all_int16;
+    for (int v = INT16_MIN; v <= INT16_MAX; v++) {
+        all_int16.push_back((int16_t)v);
+    }
+    all_int16.push_back(0);
+    for (int volume = 0; volume <= 150 && ok; volume++) {
+        ok = CheckWrite(all_int16, volume);
+    }
+    std::uniform_int_distribution<int> int16_dist(INT16_MIN, INT16_MAX);
+    for (int frame = 0; frame < 200 && ok; frame++) {
+        std::vector<int16_t> input(1 + rng() % 2000);
+        for (auto& sample : input) {
+            sample = int16_dist(rng);
+        }
+        ok = CheckWrite(input, rng() % 151);
+    }
+
+    std::vector<int32_t> edges = {INT32_MIN, INT32_MIN + 1, INT32_MAX, INT32_MAX - 1, 0, 1, -1, 4095, -4096};
+    for (int32_t limit : {INT16_MAX, -INT16_MAX, INT16_MIN}) {
+        for (int32_t delta = -2; delta <= 2; delta++) {
+            int32_t base = (limit + delta) * 4096;
+            edges.insert(edges.end(), {base - 1, base, base + 1, base + 4095});
+        }
+    }
+    if (ok) {
+        ok = CheckRead(edges);
+    }
+    std::uniform_int_distribution<int32_t> int32_dist(INT32_MIN, INT32_MAX);
+    std::uniform_int_distribution<int32_t> near_dist(-INT16_MAX * 4096 * 2, INT16_MAX * 4096 * 2);
+    for (int frame = 0; frame < 1000 && ok; frame++) {
+        std::vector<int32_t> input(1 + rng() % 2000);
+        for (auto& sample : input) {
+            sample = (rng() & 1) ? int32_dist(rng) : near_dist(rng);
+        }
+        ok = CheckRead(input);
+    }
+    printf("bit-exact: %s\n", ok ? "yes" : "NO");
+
+    // 吞吐：24 kHz 输出和 16 kHz 输入各一帧 60 ms
+    const int write_samples = 24000 * 60 / 1000;
+    const int read_samples = 16000 * 60 / 1000;
+    std::vector<int16_t> pcm(write_samples);
+    for (auto& sample : pcm) {
+        sample = int16_dist(rng);
+    }
+    std::vector<int32_t> raw(read_samples);
+    for (auto& sample : raw) {
+        sample = near_dist(rng);
+    }
+    std::vector<int32_t> out32(write_samples), old_out32;
+    std::vector<int16_t> out16(read_samples);
+    volatile int32_t sink = 0;
+
+    printf("%-18s %23s | %23s | %6s\n", "", "old", "new", "speed");
+    for (int volume : {70, 100, 120}) {
+        char name[32];
+        snprintf(name, sizeof(name), "write vol %d", volume);
+        double old_ns = NsPerCall([&]() { OldWrite(pcm.data(), write_samples, volume, old_out32); sink = old_out32[0]; });
+        int32_t factor = VolumeFactorQ16(volume);
+        double new_ns = NsPerCall([&]() { ScaleToInt32(pcm.data(), out32.data(), write_samples, factor); sink = out32[0]; });
+        Report(name, write_samples, old_ns, new_ns);
+    }
+    double old_ns = NsPerCall([&]() { OldRead(raw.data(), read_samples, out16.data()); sink = out16[0]; });
+    double new_ns = NsPerCall([&]() { NarrowToInt16(raw.data(), out16.data(), read_samples); sink = out16[0]; });
+    Report("read", read_samples, old_ns, new_ns);
+    (void)sink;
+    return ok ? 0 : 1;
+}
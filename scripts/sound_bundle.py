@@ -0,0 +1,174 @@
+# build the indexed prompt sound bundle embedded in the firmware (see main/sound_bundle.h)
+#
+# Layout, little-endian:
+#   header   16 bytes: magic "P3BD", u16 version, u16 entry count, u32 data offset, u32 total size
+#   entries  20 bytes each, sorted by name hash:
+#            u32 FNV-1a hash of the name, u32 offset from bundle start, u32 size,
+#            u32 duration in ms, u16 packet count, u16 reserved
+#   data     P3 streams, 4-byte aligned; identical streams are stored once
+#
+# Names are the file names without .p3 ("activation", "0", ...), prefixed with "<lang>/" when
+# more than one language directory goes into the same bundle.
+#
+#   python sound_bundle.py build -o sounds.bin ../main/assets/zh-CN ../main/assets/common
+#   python sound_bundle.py report ../main/assets
+import argparse
+import hashlib
+import os
+import struct
+import sys
+
+MAGIC = b"P3BD"
+VERSION = 1
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<IIIIHH")
+ALIGN = 4
+
+
+def fnv1a(name):
+    h = 0x811C9DC5
+    for b in name.encode("utf-8"):
+        h = ((h ^ b) * 0x01000193) & 0xFFFFFFFF
+    return h
+
+
+def opus_packet_ms(packet):
+    # frame duration from the TOC byte (RFC 6716 section 3.1), times the number of frames
+    if not packet:
+        return 0.0
+    toc = packet[0]
+    config = toc >> 3
+    if config < 12:
+        frame_ms = (10, 20, 40, 60)[config & 3]
+    elif config < 16:
+        frame_ms = (10, 20)[config & 1]
+    else:
+        frame_ms = (2.5, 5, 10, 20)[config & 3]
+    code = toc & 3
+    if code == 0:
+        frames = 1
+    elif code in (1, 2):
+        frames = 2
+    else:
+        frames = packet[1] & 0x3F if len(packet) > 1 else 0
+    return frame_ms * frames
+
+
+def parse_p3(data, path="<p3>"):
+    # returns (packet count, duration in ms), raising on a truncated stream
+    offset = 0
+    packets = 0
+    duration = 0.0
+    while offset < len(data):
+        if offset + 4 > len(data):
+            raise ValueError(f"{path}: truncated header at {offset}")
+        size = struct.unpack_from(">H", data, offset + 2)[0]
+        payload = data[offset + 4:offset + 4 + size]
+        if len(payload) != size:
+            raise ValueError(f"{path}: truncated packet at {offset}")
+        packets += 1
+        duration += opus_packet_ms(payload)
+        offset += 4 + size
+    return packets, int(round(duration))
+
+
+def collect(directories):
+    # [(name, path)] for every .p3 file, names prefixed with the directory when there are several
+    # language directories ("common" is never prefixed, it is shared)
+    languages = [d for d in directories if os.path.basename(os.path.normpath(d)) != "common"]
+    sounds = []
+    for directory in directories:
+        base = os.path.basename(os.path.normpath(directory))
+        prefix = f"{base}/" if len(languages) > 1 and base != "common" else ""
+        for file in sorted(os.listdir(directory)):
+            if file.endswith(".p3"):
+                sounds.append((prefix + os.path.splitext(file)[0], os.path.join(directory, file)))
+    names = [name for name, _ in sounds]
+    duplicates = {name for name in names if names.count(name) > 1}
+    if duplicates:
+        raise ValueError(f"duplicate sound names: {', '.join(sorted(duplicates))}")
+    return sounds
+
+
+def build(sounds):
+    """Returns (bundle bytes, {name: (offset, size, duration_ms, packets)}, stats)."""
+    entries = []
+    blobs = {}      # sha1 -> offset in data section
+    data = bytearray()
+    raw_total = 0
+    for name, path in sounds:
+        with open(path, "rb") as f:
+            content = f.read()
+        raw_total += len(content)
+        packets, duration = parse_p3(content, path)
+        digest = hashlib.sha1(content).digest()
+        if digest not in blobs:
+            blobs[digest] = len(data)
+            data += content
+            data += b"\0" * (-len(data) % ALIGN)
+        entries.append((name, blobs[digest], len(content), duration, packets))
+
+    entries.sort(key=lambda e: fnv1a(e[0]))
+    hashes = [fnv1a(e[0]) for e in entries]
+    if len(set(hashes)) != len(hashes):
+        raise ValueError("sound name hash collision")
+    data_offset = HEADER.size + ENTRY.size * len(entries)
+    data_offset += -data_offset % ALIGN
+    total = data_offset + len(data)
+
+    out = bytearray(HEADER.pack(MAGIC, VERSION, len(entries), data_offset, total))
+    index = {}
+    for name, offset, size, duration, packets in entries:
+        out += ENTRY.pack(fnv1a(name), data_offset + offset, size, duration, min(packets, 0xFFFF), 0)
+        index[name] = (data_offset + offset, size, duration, packets)
+    out += b"\0" * (data_offset - len(out))
+    out += data
+    stats = {
+        "sounds": len(entries),
+        "unique": len(blobs),
+        "raw_bytes": raw_total,
+        "bundle_bytes": total,
+        "index_bytes": data_offset,
+    }
+    return bytes(out), index, stats
+
+
+def format_stats(stats):
+    saved = stats["raw_bytes"] - stats["bundle_bytes"]
+    return (f"{stats['sounds']} sounds ({stats['unique']} unique), {stats['raw_bytes']} bytes as separate files, "
+            f"{stats['bundle_bytes']} bytes bundled ({stats['index_bytes']} bytes index), "
+            f"{saved:+d} bytes saved")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build or report on the prompt sound bundle")
+    sub = parser.add_subparsers(dest="command", required=True)
+    build_parser = sub.add_parser("build", help="bundle one or more directories of .p3 files")
+    build_parser.add_argument("-o", "--output", required=True)
+    build_parser.add_argument("directories", nargs="+")
+    report_parser = sub.add_parser("report", help="footprint per language and with all languages bundled")
+    report_parser.add_argument("assets", help="assets directory with one subdirectory per language and common/")
+    args = parser.parse_args()
+
+    if args.command == "build":
+        bundle, index, stats = build(collect(args.directories))
+        with open(args.output, "wb") as f:
+            f.write(bundle)
+        print(f"{args.output}: {format_stats(stats)}")
+        return
+
+    common = os.path.join(args.assets, "common")
+    languages = sorted(d for d in os.listdir(args.assets)
+                       if os.path.isdir(os.path.join(args.assets, d)) and d != "common")
+    for language in languages:
+        _, _, stats = build(collect([os.path.join(args.assets, language), common]))
+        print(f"{language:8s} {format_stats(stats)}")
+    _, _, stats = build(collect([os.path.join(args.assets, l) for l in languages] + [common]))
+    print(f"{'all':8s} {format_stats(stats)}")
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except ValueError as e:
+        sys.exit(str(e))
@@ -0,0 +1,167 @@
+# local TLS stand-in for measuring session resumption and connection reuse
+#
+# serve: terminates TLS (TLS 1.2 with session tickets, like the device's mbedtls defaults) and
+#        forwards plaintext to an upstream such as ws_standin_server.py, printing the handshake
+#        time and whether the session was resumed for every connection.
+# bench: connects repeatedly the way the device does, one fresh session cache per simulated boot
+#        and one reconnect per conversation, and reports handshake count and time per boot and
+#        per conversation with and without resumption.
+#
+#   python tls_standin.py serve --port 8443 --upstream 127.0.0.1:8000
+#   python tls_standin.py bench --port 8443 --boots 3 --conversations 5
+#
+# Without --cert/--key a self-signed certificate is generated with the openssl command line tool.
+# The device must trust it, e.g. by flashing a bundle that contains it; the bench skips verification.
+import argparse
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+
+def make_self_signed(directory):
+    cert = os.path.join(directory, "standin.crt")
+    key = os.path.join(directory, "standin.key")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1",
+                    "-nodes", "-days", "30", "-subj", "/CN=tls-standin", "-keyout", key, "-out", cert],
+                   check=True, capture_output=True)
+    return cert, key
+
+
+def pipe(source, destination):
+    try:
+        while True:
+            data = source.recv(4096)
+            if not data:
+                break
+            destination.sendall(data)
+    except OSError:
+        pass
+    finally:
+        for s in (source, destination):
+            try:
+                s.shutdown(socket.SHUT_RDWR)
+            except OSError:
+                pass
+
+
+def serve(args):
+    workdir = tempfile.mkdtemp()
+    cert, key = (args.cert, args.key) if args.cert else make_self_signed(workdir)
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.load_cert_chain(cert, key)
+
+    stats = {"handshakes": 0, "resumed": 0, "total_ms": 0.0}
+    lock = threading.Lock()
+
+    def handle(client, address):
+        tls = context.wrap_socket(client, server_side=True, do_handshake_on_connect=False)
+        start = time.monotonic()
+        try:
+            tls.do_handshake()
+        except (ssl.SSLError, OSError) as e:
+            print(f"{address[0]}:{address[1]} handshake failed: {e}")
+            tls.close()
+            return
+        elapsed = (time.monotonic() - start) * 1000
+        resumed = tls.session_reused
+        with lock:
+            stats["handshakes"] += 1
+            stats["resumed"] += int(resumed)
+            stats["total_ms"] += elapsed
+            summary = dict(stats)
+        print(f"[{time.strftime('%H:%M:%S')}] {address[0]}:{address[1]} {'resumed' if resumed else 'full'} "
+              f"handshake {elapsed:6.1f} ms  (total {summary['handshakes']}, resumed {summary['resumed']}, "
+              f"{summary['total_ms']:.0f} ms)")
+
+        if args.upstream:
+            host, port = args.upstream.rsplit(":", 1)
+            upstream = socket.create_connection((host, int(port)))
+            threading.Thread(target=pipe, args=(upstream, tls), daemon=True).start()
+            pipe(tls, upstream)
+        else:
+            pipe(tls, tls)
+        tls.close()
+
+    listener = socket.create_server((args.host, args.port))
+    print(f"listening on {args.host}:{args.port}, upstream {args.upstream or 'echo'}")
+    try:
+        while True:
+            client, address = listener.accept()
+            threading.Thread(target=handle, args=(client, address), daemon=True).start()
+    except KeyboardInterrupt:
+        print(f"\n{stats['handshakes']} handshakes, {stats['resumed']} resumed, {stats['total_ms']:.0f} ms total")
+
+
+def connect(context, host, port, session):
+    sock = socket.create_connection((host, port))
+    tls = context.wrap_socket(sock, server_hostname=host, session=session, do_handshake_on_connect=False)
+    start = time.monotonic()
+    tls.do_handshake()
+    elapsed = (time.monotonic() - start) * 1000
+    result = (elapsed, tls.session_reused, tls.session)
+    tls.close()
+    return result
+
+
+def bench(args):
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    context.check_hostname = False
+    context.verify_mode = ssl.CERT_NONE
+
+    for resume in (False, True):
+        print(f"== {'with' if resume else 'without'} session resumption")
+        persisted = None
+        totals = [0, 0, 0.0]
+        for boot in range(args.boots):
+            # the device keeps its session in RAM only, so a reboot starts with a full handshake
+            session = persisted if resume and args.persist else None
+            boot_stats = [0, 0, 0.0]
+            for conversation in range(args.conversations):
+                elapsed, reused, new_session = connect(context, args.host, args.port, session)
+                if resume:
+                    session = persisted = new_session
+                for stats in (boot_stats, totals):
+                    stats[0] += 1
+                    stats[1] += int(reused)
+                    stats[2] += elapsed
+                print(f"  boot {boot} conversation {conversation}: 1 handshake "
+                      f"({'resumed' if reused else 'full'}) {elapsed:6.1f} ms")
+            print(f"  boot {boot}: {boot_stats[0]} handshakes, {boot_stats[1]} resumed, {boot_stats[2]:.1f} ms")
+        print(f"  total: {totals[0]} handshakes, {totals[1]} resumed, {totals[2]:.1f} ms, "
+              f"{totals[2] / max(totals[0], 1):.1f} ms per conversation")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Local TLS stand-in and handshake benchmark")
+    sub = parser.add_subparsers(dest="command", required=True)
+    serve_parser = sub.add_parser("serve")
+    serve_parser.add_argument("--host", default="0.0.0.0")
+    serve_parser.add_argument("--port", type=int, default=8443)
+    serve_parser.add_argument("--cert")
+    serve_parser.add_argument("--key")
+    serve_parser.add_argument("--upstream", help="host:port to forward plaintext to, echo if omitted")
+    bench_parser = sub.add_parser("bench")
+    bench_parser.add_argument("--host", default="127.0.0.1")
+    bench_parser.add_argument("--port", type=int, default=8443)
+    bench_parser.add_argument("--boots", type=int, default=3)
+    bench_parser.add_argument("--conversations", type=int, default=5)
+    bench_parser.add_argument("--persist", action="store_true",
+                              help="keep the session across simulated boots (what a persistent cache would save)")
+    args = parser.parse_args()
+    if args.command == "serve":
+        if bool(args.cert) != bool(args.key):
+            sys.exit("--cert and --key must be given together")
+        serve(args)
+    else:
+        bench(args)
+
+
+if __name__ == "__main__":
+    main()
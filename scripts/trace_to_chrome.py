@@ -0,0 +1,64 @@
+# convert the device trace dump to Chrome trace JSON (open with chrome://tracing or ui.perfetto.dev)
+#
+# Input is either the serial log (lines "timestamp_us,core,type,task,name" up to "--- trace end ---")
+# or the "trace" messages sent over the protocol, one JSON object per line.
+import argparse
+import json
+import sys
+
+
+def parse_lines(lines):
+    for line in lines:
+        line = line.strip()
+        if not line:
+            continue
+        if line.startswith("{"):
+            message = json.loads(line)
+            if message.get("type") == "trace":
+                yield from parse_lines(message.get("data", "").splitlines())
+            continue
+        parts = line.split(",", 4)
+        if len(parts) != 5 or not parts[0].isdigit():
+            continue
+        yield int(parts[0]), int(parts[1]), parts[2], parts[3], parts[4]
+
+
+def convert(records):
+    # timestamps are the low 32 bits of esp_timer_get_time(), unwrap them per core
+    events = []
+    last_ts = {}
+    offset = {}
+    for ts, core, phase, task, name in records:
+        if core in last_ts and ts < last_ts[core] and last_ts[core] - ts > 0x80000000:
+            offset[core] = offset.get(core, 0) + 0x100000000
+        last_ts[core] = ts
+        event = {
+            "name": name,
+            "ph": phase,
+            "ts": ts + offset.get(core, 0),
+            # one process for the device and one track per task, so a task that migrates between
+            # cores keeps its begin/end pairs on the same track; the core goes into args
+            "pid": 1,
+            "tid": task,
+            "args": {"core": core},
+        }
+        if phase == "i":
+            event["s"] = "t"
+        events.append(event)
+
+    events.sort(key=lambda e: e["ts"])
+    metadata = [{"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "device"}}]
+    return {"traceEvents": metadata + events, "displayTimeUnit": "ms"}
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Convert device trace dump to Chrome trace JSON")
+    parser.add_argument("input", nargs="?", help="trace dump file, read from stdin if omitted")
+    parser.add_argument("-o", "--output", default="trace.json", help="output file")
+    args = parser.parse_args()
+
+    with open(args.input, encoding="utf-8", errors="ignore") if args.input else sys.stdin as f:
+        trace = convert(parse_lines(f))
+    with open(args.output, "w") as f:
+        json.dump(trace, f)
+    print(f"{len(trace['traceEvents'])} events written to {args.output}")
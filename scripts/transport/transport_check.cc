@@ -0,0 +1,115 @@
+// Host check for the WiFi/ML307 failover policy (main/boards/common/transport_manager.cc)
+//
+// Compiles the firmware's TransportManager unchanged and runs scripted link quality sequences
+// against it. With --stdin it acts as the policy engine for transport_sim.py instead: every input
+// line "sample <active> <standby> <active_is_preferred> <now_ms>" prints 1 (migrate) or 0, and
+// "migrated <now_ms>" calls OnMigrated.
+//
+//   g++ -std=c++17 -O2 -I../main/boards/common -o transport_check transport/transport_check.cc ../main/boards/common/transport_manager.cc
+//   ./transport_check
+//   python transport_sim.py --manager ./transport_check
+//
+// (run from scripts/). Exits non-zero when a check fails.
+#include "transport_manager.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+
+static constexpr int64_t kSampleMs = 2000;
+
+struct Link {
+    std::function<int(int64_t)> active;
+    std::function<int(int64_t)> standby;
+};
+
+// 每 2 s 采样一次，返回第一次要求迁移的时间，没有迁移返回 -1
+static int64_t FirstMigration(TransportManager& manager, const Link& link, bool preferred,
+    int64_t from_ms, int64_t to_ms) {
+    for (int64_t now = from_ms; now < to_ms; now += kSampleMs) {
+        if (manager.Sample(link.active(now), link.standby(now), preferred, now) == TransportManager::kDecisionMigrate) {
+            return now;
+        }
+    }
+    return -1;
+}
+
+static bool Check(const char* name, int64_t actual, int64_t expected) {
+    bool ok = actual == expected;
+    printf("%-44s %s (migrate at %lld ms, expected %lld)\n", name, ok ? "ok" : "FAIL",
+        (long long)actual, (long long)expected);
+    return ok;
+}
+
+static bool RunChecks() {
+    bool ok = true;
+    {
+        TransportManager manager;
+        Link link = { [](int64_t) { return 80; }, [](int64_t) { return 60; } };
+        ok &= Check("steady links stay", FirstMigration(manager, link, true, 0, 300000), -1);
+    }
+    {
+        // 断开立即生效，连续三次差才迁移
+        TransportManager manager;
+        Link link = { [](int64_t t) { return t < 10000 ? 80 : 0; }, [](int64_t) { return 70; } };
+        ok &= Check("active link down migrates after 3 samples", FirstMigration(manager, link, true, 0, 60000), 14000);
+    }
+    {
+        // 单次抖动被平滑掉
+        TransportManager manager;
+        Link link = { [](int64_t t) { return t == 10000 ? 10 : 80; }, [](int64_t) { return 70; } };
+        ok &= Check("single dip is smoothed", FirstMigration(manager, link, true, 0, 60000), -1);
+    }
+    {
+        TransportManager manager;
+        Link link = { [](int64_t) { return 0; }, [](int64_t) { return 30; } };
+        ok &= Check("poor standby never takes over", FirstMigration(manager, link, true, 0, 120000), -1);
+    }
+    {
+        // 迁移后 30 s 内不再迁移，即使新链路马上变差
+        TransportManager manager;
+        Link down = { [](int64_t) { return 0; }, [](int64_t) { return 70; } };
+        int64_t first = FirstMigration(manager, down, true, 0, 60000);
+        manager.OnMigrated(first);
+        ok &= Check("dwell time after migration", FirstMigration(manager, down, false, first + kSampleMs, first + 120000),
+            first + TransportManager::kMinDwellMs);
+    }
+    {
+        // 运行在备用链路上，首选链路持续良好 60 s 后迁回
+        TransportManager manager;
+        manager.OnMigrated(0);
+        Link link = { [](int64_t) { return 60; }, [](int64_t) { return 80; } };
+        ok &= Check("return to preferred link", FirstMigration(manager, link, false, kSampleMs, 300000),
+            kSampleMs + TransportManager::kRecoverMs);
+    }
+    return ok;
+}
+
+static int RunStdin() {
+    TransportManager manager;
+    char line[128];
+    while (fgets(line, sizeof(line), stdin) != nullptr) {
+        int active, standby, preferred;
+        long long now;
+        if (sscanf(line, "sample %d %d %d %lld", &active, &standby, &preferred, &now) == 4) {
+            auto decision = manager.Sample(active, standby, preferred != 0, now);
+            printf("%d %d %d\n", decision == TransportManager::kDecisionMigrate ? 1 : 0,
+                manager.active_quality(), manager.standby_quality());
+        } else if (sscanf(line, "migrated %lld", &now) == 1) {
+            manager.OnMigrated(now);
+            printf("ok\n");
+        } else {
+            printf("error\n");
+        }
+        fflush(stdout);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--stdin") == 0) {
+        return RunStdin();
+    }
+    return RunChecks() ? 0 : 1;
+}
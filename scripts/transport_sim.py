@@ -0,0 +1,140 @@
+# host simulation of the WiFi/ML307 failover policy in main/boards/common/transport_manager.cc
+#
+# Two fake links follow a scripted quality timeline (0 = down). The policy is sampled every
+# 2 s like the link monitor task, and a requested migration only runs outside utterances,
+# matching Application::RunPendingMigration. The decisions come from the firmware's own
+# TransportManager, compiled for the host by transport/transport_check.cc and driven over stdin:
+#
+#   g++ -std=c++17 -O2 -I../main/boards/common -o transport_check transport/transport_check.cc ../main/boards/common/transport_manager.cc
+#   python transport_sim.py --manager ./transport_check [scenario.json]
+#
+# Scenario file (JSON):
+#   {"duration": 300, "preferred": "wifi",
+#    "wifi":  [[start_s, end_s, quality], ...],   # default quality outside the ranges is "base"
+#    "ml307": [[start_s, end_s, quality], ...],
+#    "base": {"wifi": 80, "ml307": 60},
+#    "utterances": [[start_s, end_s], ...]}
+import argparse
+import json
+import subprocess
+import sys
+
+SAMPLE_INTERVAL_MS = 2000
+
+DEFAULT_SCENARIO = {
+    "duration": 300,
+    "preferred": "wifi",
+    "base": {"wifi": 80, "ml307": 60},
+    # WiFi collapses mid-conversation, comes back, then the modem drops while on WiFi
+    "wifi": [[40, 60, 30], [60, 110, 0], [200, 210, 10]],
+    "ml307": [[150, 170, 0]],
+    "utterances": [[t, t + 8] for t in range(10, 290, 20)],
+}
+
+
+class TransportManager:
+    """The C++ TransportManager running in a transport_check --stdin process."""
+
+    def __init__(self, binary):
+        self.process = subprocess.Popen([binary, "--stdin"], stdin=subprocess.PIPE, stdout=subprocess.PIPE,
+                                        text=True, bufsize=1)
+        self.active_quality = -1
+        self.standby_quality = -1
+
+    def _call(self, line):
+        self.process.stdin.write(line + "\n")
+        self.process.stdin.flush()
+        reply = self.process.stdout.readline().split()
+        if not reply or reply[0] == "error":
+            raise RuntimeError(f"transport_check rejected '{line}'")
+        return reply
+
+    def sample(self, active_quality, standby_quality, active_is_preferred, now_ms):
+        migrate, self.active_quality, self.standby_quality = map(int, self._call(
+            f"sample {active_quality} {standby_quality} {int(active_is_preferred)} {now_ms}"))
+        return migrate == 1
+
+    def on_migrated(self, now_ms):
+        self._call(f"migrated {now_ms}")
+
+    def close(self):
+        self.process.stdin.close()
+        self.process.wait()
+
+
+def link_quality(scenario, link, t):
+    for start, end, quality in scenario.get(link, []):
+        if start <= t < end:
+            return quality
+    return scenario.get("base", {}).get(link, 70)
+
+
+def in_utterance(scenario, t):
+    return any(start <= t < end for start, end in scenario.get("utterances", []))
+
+
+def simulate(scenario, manager, verbose):
+    other = {"wifi": "ml307", "ml307": "wifi"}
+    preferred = scenario.get("preferred", "wifi")
+    active = preferred
+    pending = None
+    migrations = 0
+    time_on = {"wifi": 0.0, "ml307": 0.0}
+    dead_speech_s = 0.0
+    step = SAMPLE_INTERVAL_MS / 1000
+
+    t = 0.0
+    while t < scenario.get("duration", 300):
+        now_ms = int(t * 1000)
+        speaking = in_utterance(scenario, t)
+        if pending and not speaking:
+            active = pending
+            pending = None
+            manager.on_migrated(now_ms)
+            migrations += 1
+            if verbose:
+                print(f"{t:7.1f}s  migrated to {active}")
+
+        active_q = link_quality(scenario, active, t)
+        standby_q = link_quality(scenario, other[active], t)
+        if manager.sample(active_q, standby_q, active == preferred, now_ms) and pending is None:
+            pending = other[active]
+            if verbose:
+                print(f"{t:7.1f}s  request {active} -> {pending} (active {manager.active_quality}, "
+                      f"standby {manager.standby_quality}{', waiting for utterance end' if speaking else ''})")
+
+        time_on[active] += step
+        if speaking and active_q == 0:
+            dead_speech_s += step
+        t += step
+
+    return {
+        "migrations": migrations,
+        "time_on_wifi_s": time_on["wifi"],
+        "time_on_ml307_s": time_on["ml307"],
+        "speech_on_dead_link_s": dead_speech_s,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Simulate WiFi/ML307 failover with scripted outages")
+    parser.add_argument("scenario", nargs="?", help="scenario JSON file, built-in scenario if omitted")
+    parser.add_argument("-q", "--quiet", action="store_true", help="only print the summary")
+    parser.add_argument("--manager", default="./transport_check", help="transport_check binary built from the firmware sources")
+    args = parser.parse_args()
+
+    scenario = DEFAULT_SCENARIO
+    if args.scenario:
+        with open(args.scenario) as f:
+            scenario = json.load(f)
+    manager = TransportManager(args.manager)
+    try:
+        summary = simulate(scenario, manager, not args.quiet)
+    finally:
+        manager.close()
+    json.dump(summary, sys.stdout, indent=2)
+    print()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,239 @@
+# minimal local stand-in for the websocket chat server, used to measure connection reuse and
+# the wake word upload pipeline
+#
+# Point CONFIG_WEBSOCKET_URL at ws://<host>:<port>/ and watch the log: every connection prints
+# the time to "hello", and every "listen start" prints whether it reused an existing connection.
+# Compare with the "Wake to listening" log / wake_to_listen_us metric on the device.
+#
+# For every wake word the log also shows how long after "hello" the wake word audio was complete
+# ("listen detect"), how much audio arrived ahead of real time after "listen start" (the bridge
+# audio captured while connecting) and the longest stall between audio frames once the stream
+# runs at real time. With --dump each listen session is saved as a .p3 file (wake word audio
+# included) that can be decoded with p3_tools to check the handoff for gaps; record a steady tone
+# or count out loud while waking the device.
+#
+# With --reply the server answers every listen session after --listen-ms of audio (or at
+# "listen stop") by streaming the given .p3 file as TTS at real time, followed by "tts stop". The
+# next "listen start" is then logged with the time since "tts stop" and since the reply should
+# have finished playing; compare with the tts_tail_us / turnaround_us metrics on the device.
+#
+# With --control tlv1 the server accepts the binary control encoding when the device offers it in
+# "hello" (CONFIG_CONTROL_BINARY_ENCODING) and exchanges control messages as TLV frames from then on
+# (see control_codec.py). Every connection logs its control bytes next to what JSON would have cost.
+#
+#   pip install websockets
+#   python ws_standin_server.py --port 8000 --hello-delay 0.3 [--dump sessions/] [--reply answer.p3] [--control tlv1]
+import argparse
+import asyncio
+import json
+import os
+import struct
+import time
+
+import websockets
+
+import control_codec
+from sound_bundle import opus_packet_ms, parse_p3
+
+
+def read_p3_packets(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    parse_p3(data, path)
+    packets = []
+    offset = 0
+    while offset < len(data):
+        size = struct.unpack_from(">H", data, offset + 2)[0]
+        packets.append(data[offset + 4:offset + 4 + size])
+        offset += 4 + size
+    return packets
+
+
+def log(conn_id, start, message):
+    print(f"[{time.strftime('%H:%M:%S')}] conn {conn_id} +{(time.monotonic() - start) * 1000:7.1f} ms  {message}")
+
+
+class AudioStats:
+    """Audio received since the last reset: duration by the Opus TOC, arrival times and stalls."""
+
+    def __init__(self):
+        self.reset(time.monotonic())
+
+    def reset(self, now):
+        self.since = now
+        self.frames = 0
+        self.audio_ms = 0.0
+        self.max_lead_ms = 0.0
+        self.max_stall_ms = 0.0
+        self.last_arrival = None
+
+    def add(self, packet, now):
+        if self.last_arrival is not None:
+            # only count stalls once the stream has caught up with real time
+            wall_ms = (self.last_arrival - self.since) * 1000
+            if self.audio_ms <= wall_ms + 100:
+                self.max_stall_ms = max(self.max_stall_ms, (now - self.last_arrival) * 1000)
+        self.frames += 1
+        self.audio_ms += opus_packet_ms(packet)
+        self.max_lead_ms = max(self.max_lead_ms, self.audio_ms - (now - self.since) * 1000)
+        self.last_arrival = now
+
+
+class ControlChannel:
+    """Sends and decodes control messages in the negotiated encoding and counts their bytes."""
+
+    def __init__(self, websocket):
+        self.websocket = websocket
+        self.binary = False
+        self.bytes = 0
+        self.json_bytes = 0
+
+    def is_control(self, message):
+        return isinstance(message, str) or (self.binary and control_codec.is_control_frame(message))
+
+    def decode(self, message):
+        data = control_codec.decode(message) if isinstance(message, bytes) else json.loads(message)
+        self.bytes += len(message.encode("utf-8") if isinstance(message, str) else message)
+        self.json_bytes += len(control_codec.to_json(data))
+        return data
+
+    async def send(self, data):
+        message = control_codec.encode(data) if self.binary else json.dumps(data, ensure_ascii=False)
+        self.bytes += len(message if self.binary else message.encode("utf-8"))
+        self.json_bytes += len(control_codec.to_json(data))
+        await self.websocket.send(message)
+
+
+async def send_reply(websocket, control, conn_id, start, session_id, packets, reply):
+    """Stream the reply as TTS at real time and remember when it should have finished playing."""
+    await control.send({"session_id": session_id, "type": "tts", "state": "start"})
+    await control.send({"session_id": session_id, "type": "tts", "state": "sentence_start",
+                        "text": "standin reply"})
+    first_send = time.monotonic()
+    audio_ms = 0.0
+    for packet in packets:
+        await websocket.send(packet)
+        audio_ms += opus_packet_ms(packet)
+        # stay one frame ahead of real time, like the real server
+        await asyncio.sleep(max(0.0, first_send + (audio_ms - 60) / 1000 - time.monotonic()))
+    await control.send({"session_id": session_id, "type": "tts", "state": "stop"})
+    reply["stop"] = time.monotonic()
+    reply["played"] = first_send + audio_ms / 1000
+    log(conn_id, start, f"tts stop after {len(packets)} frames, {audio_ms:.0f} ms of audio")
+
+
+async def handle(websocket, args, counter=[0]):
+    counter[0] += 1
+    conn_id = counter[0]
+    start = time.monotonic()
+    session_id = f"standin-{conn_id}"
+    listens = 0
+    audio_frames = 0
+    hello_time = None
+    stats = AudioStats()
+    session = bytearray()
+    reply = {}
+    replying = None
+    control = ControlChannel(websocket)
+    log(conn_id, start, "connected")
+
+    def start_reply():
+        nonlocal replying
+        if args.reply and (replying is None or replying.done()):
+            reply.clear()
+            replying = asyncio.create_task(send_reply(websocket, control, conn_id, start, session_id, args.reply, reply))
+
+    try:
+        async for message in websocket:
+            now = time.monotonic()
+            if not control.is_control(message):
+                audio_frames += 1
+                stats.add(message, now)
+                session += struct.pack(">BBH", 0, 0, len(message)) + message
+                if args.reply and stats.audio_ms >= args.listen_ms and "listening" in reply:
+                    del reply["listening"]
+                    start_reply()
+                continue
+            try:
+                data = control.decode(message)
+            except ValueError as e:
+                log(conn_id, start, f"bad control message: {e}")
+                continue
+            kind = data.get("type")
+            if kind == "hello":
+                await asyncio.sleep(args.hello_delay)
+                hello = {
+                    "type": "hello",
+                    "transport": "websocket",
+                    "session_id": session_id,
+                    "audio_params": {"sample_rate": args.sample_rate, "frame_duration": 60},
+                }
+                offered = data.get("control") or []
+                if args.control and args.control in offered:
+                    hello["control"] = args.control
+                await control.send(hello)
+                # the hello itself is always JSON, the encoding applies from the next message
+                control.binary = "control" in hello
+                hello_time = time.monotonic()
+                stats.reset(hello_time)
+                log(conn_id, start, f"hello exchanged, control encoding {hello.get('control', 'json')}")
+            elif kind == "listen":
+                state = data.get("state")
+                if state == "detect":
+                    upload_ms = (now - hello_time) * 1000 if hello_time is not None else 0
+                    log(conn_id, start, f"wake word '{data.get('text')}': {stats.frames} frames, "
+                        f"{stats.audio_ms:.0f} ms of audio, complete {upload_ms:.0f} ms after hello")
+                if state in ("start", "detect"):
+                    listens += 1
+                    reused = "reused connection" if listens > 1 else "new connection"
+                    log(conn_id, start, f"listen {state} ({reused}, session {data.get('session_id')})")
+                if state == "start" and "stop" in reply:
+                    log(conn_id, start, f"turnaround: listen start {(now - reply['stop']) * 1000:.0f} ms after "
+                        f"tts stop, {(now - reply['played']) * 1000:.0f} ms after the reply finished playing")
+                if state in ("start", "detect"):
+                    reply.clear()
+                    reply["listening"] = True
+                if state == "start":
+                    stats.reset(now)
+                elif state == "stop":
+                    wall_ms = (now - stats.since) * 1000
+                    log(conn_id, start, f"listen stop, {audio_frames} audio frames so far; since listen start "
+                        f"{stats.audio_ms:.0f} ms of audio in {wall_ms:.0f} ms, up to {stats.max_lead_ms:.0f} ms "
+                        f"ahead of real time, longest stall {stats.max_stall_ms:.0f} ms")
+                    if args.dump:
+                        os.makedirs(args.dump, exist_ok=True)
+                        path = os.path.join(args.dump, f"conn{conn_id}_listen{listens}.p3")
+                        with open(path, "wb") as f:
+                            f.write(session)
+                        log(conn_id, start, f"saved {path}")
+                    session = bytearray()
+                    if reply.pop("listening", False):
+                        start_reply()
+    except websockets.ConnectionClosed:
+        pass
+    log(conn_id, start, f"closed after {listens} listen requests, {audio_frames} audio frames, "
+        f"{control.bytes} control bytes ({control.json_bytes} as JSON)")
+
+
+async def main():
+    parser = argparse.ArgumentParser(description="Local websocket stand-in server")
+    parser.add_argument("--host", default="0.0.0.0")
+    parser.add_argument("--port", type=int, default=8000)
+    parser.add_argument("--hello-delay", type=float, default=0.0, help="simulated server hello latency in seconds")
+    parser.add_argument("--sample-rate", type=int, default=24000)
+    parser.add_argument("--dump", help="directory to save the audio of each listen session as .p3")
+    parser.add_argument("--reply", help=".p3 file streamed as the TTS reply to every listen session")
+    parser.add_argument("--listen-ms", type=float, default=3000,
+                        help="audio received before replying when the device does not send listen stop")
+    parser.add_argument("--control", choices=["tlv1"], help="accept this binary control encoding when offered")
+    args = parser.parse_args()
+    if args.reply:
+        args.reply = read_p3_packets(args.reply)
+
+    async with websockets.serve(lambda ws: handle(ws, args), args.host, args.port):
+        print(f"listening on ws://{args.host}:{args.port}/")
+        await asyncio.Future()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())